@@ -41,7 +41,8 @@ void TASK_events(void*)
 	Console& console = getConsole();
 	for(;;)
 	{
-		handleOneEvent(eventQueue,
+		eventQueue.waitForEvents();
+		handleAllEvents(eventQueue,
 			systemReady,
 			doLedHeartbeat,
 
@@ -78,9 +79,10 @@ void TASK_events(void*)
 			[&]{ console.getUnderlyingIoStream()->write("Key_J_Pressed!\n"); },
 			[&]{ console.getUnderlyingIoStream()->write("Key_J_Long_Pressed!\n"); },
 			[&]{ console.getUnderlyingIoStream()->write("Key_J_Released!\n"); },
-			[&]{ console.getUnderlyingIoStream()->write("Key_J_Released_Long!\n"); }
+			[&]{ console.getUnderlyingIoStream()->write("Key_J_Released_Long!\n"); },
+
+			[&]{ console.getUnderlyingIoStream()->write("Key_A_B_Chord!\n"); }
 		);
-		WAIT1_WaitOSms(10);
 	}
 }
 
@@ -89,7 +91,7 @@ void TASK_keyscan(void*)
 	for(;;)
 	{
 		KEY_Scan();
-		WAIT1_WaitOSms(10);
+		WAIT1_WaitOSms(KEYDBNC_SCAN_PERIOD_MS);
 	}
 }
 
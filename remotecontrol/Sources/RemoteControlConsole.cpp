@@ -22,19 +22,21 @@ CommandParser& getCommandParser()
 	static auto parser = makeParser(
 		cmd("help", [&](IOStream& ioStream)
 		{
-			String<10> cmds[10] = {};
-			getCommandParser().getAvailableCommands(cmds, 10);
 			ioStream.write("available commands:\n");
-			for (const auto& cmd : cmds)
+			for (const auto& command : getCommandParser().getCommands())
 			{
-				if (cmd.size() > 0)
+				if (command.name.size() > 0)
 				{
-					ioStream.write(cmd);
-					ioStream.write("\n");
+					writeCommandHelp(ioStream, command);
 				}
 			}
-		}),
-		cmd("showstat", showStat),
+		}, "this list, legacy ones have \"<name> help\""),
+		cmd("showstat", showStat, "system state"),
+		cmd("remstat", REMOTE_CmdStatus, "remote"),
+		cmd("remote", REMOTE_CmdOnOff, "remote control"),
+		cmd("remverbose", REMOTE_CmdVerbose, "verbose remote"),
+		cmd("remaccel", REMOTE_CmdAccel, "steer with the accelerometer"),
+		cmd("remjoy", REMOTE_CmdJoystick, "steer with the joystick"),
 		legacyCmd(RNETA_ParseCommand),
 		legacyCmd(REMOTE_ParseCommand)
 	);
@@ -55,7 +57,9 @@ Console& getConsole()
 			20 /*max cmdline size*/
 			>(
 				CommandExecutorLineSink{&getCommandParser()},
-				SimpleEchoConsole{}
+				SimpleEchoConsole{},
+				NoHistoryController<20>{},
+				CommandNameCompleter{&getCommandParser()}
 			)
 	);
 
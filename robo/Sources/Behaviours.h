@@ -0,0 +1,392 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+/*
+ * The behaviours of MainControl. They only talk to the robot through the includes below, which
+ * the arena simulator (unittests/arena) replaces with stand-ins, so keep them in angle brackets.
+ */
+#include <Assert.h>
+#include <Drive.h>
+#include <MainControl.h>
+#include <Remote.h>
+#include <RoboConsole.h>
+#include <Strategy.h>
+#include <Timer.h>
+#include <random>
+#include <tuple>
+
+constexpr auto MAX_TURNING_SPEED = 25*74;
+constexpr auto MAX_FIGHT_SPEED = 100*74;
+constexpr auto START_FIGHT_SPEED = 100*74;
+
+class StopMotorsBehaviour
+{
+public:
+	bool wantsToTakeControl() const
+	{
+		return MainControl::hasStopMotors();
+	}
+
+	void step(bool suppress)
+	{
+		if (suppress)
+		{
+			DRV_SetSpeed(0,0);
+		}
+		else
+		{
+			DRV_SetSpeed(0,0);
+			MainControl::notifyStartMove(false);
+		}
+	}
+};
+
+
+class ScanEnemyBehaviour
+{
+public:
+	ScanEnemyBehaviour(const ScanVariants& scanVariants, uint32_t seed)
+	: scanVariants(scanVariants)
+	, randomGenerator(seed)
+	{
+	}
+
+	bool wantsToTakeControl() const
+	{
+		return MainControl::hasStartMove();
+	}
+
+	void step(bool suppress)
+	{
+		if (suppress)
+		{
+			DRV_SetSpeed(0,0);
+		}
+		else
+		{
+			auto scanVariant = scanVariants[currentStrategy];
+			DRV_SetSpeed(scanVariant.left, scanVariant.right);
+			if ((TMR_ValueMs() - startStrategyTime) > scanVariant.timeoutMs)
+			{
+				startStrategyTime = TMR_ValueMs();
+				std::uniform_int_distribution<uint8_t> distribution(0, scanVariants.size()-1);
+				currentStrategy = distribution(randomGenerator);
+				*getConsole().getUnderlyingIoStream() << "new variant: " << static_cast<uint32_t>(currentStrategy) << "\n";
+			}
+		}
+	}
+
+private:
+	ScanVariants scanVariants;
+	uint32_t startStrategyTime = 0;
+	std::ranlux24 randomGenerator;
+	uint8_t currentStrategy = 0;
+};
+
+class ConstantSpeedFightBehaviour
+{
+public:
+	explicit ConstantSpeedFightBehaviour(uint16_t enemyDistanceLimitCm)
+	: enemyDistanceLimitCm(enemyDistanceLimitCm)
+	{
+	}
+
+	bool wantsToTakeControl() const
+	{
+		return isFighting || ((MainControl::getEnemyDistance()<enemyDistanceLimitCm) && MainControl::hasStartMove());
+	}
+
+	void step(bool suppress)
+	{
+		if (suppress)
+		{
+			isFighting = false;
+			DRV_SetSpeed(0,0);
+		}
+		else
+		{
+			if (!isFighting || (MainControl::getEnemyDistance()<enemyDistanceLimitCm))
+			{
+				startFightTime = TMR_ValueMs();
+				isFighting = true;
+				DRV_SetSpeed(MAX_FIGHT_SPEED, MAX_FIGHT_SPEED);
+			}
+			else
+			{
+				if ((TMR_ValueMs() - startFightTime) > 500)
+				{
+					isFighting = false;
+				}
+			}
+		}
+	}
+
+private:
+	uint16_t enemyDistanceLimitCm;
+	bool isFighting = false;
+	uint32_t startFightTime = 0;
+};
+
+class StaggeringFightBehaviour
+{
+public:
+	explicit StaggeringFightBehaviour(uint16_t enemyDistanceLimitCm)
+	: enemyDistanceLimitCm(enemyDistanceLimitCm)
+	{
+	}
+
+	bool wantsToTakeControl() const
+	{
+		return ((MainControl::getEnemyDistance()<enemyDistanceLimitCm) && MainControl::hasStartMove());
+	}
+
+	void step(bool suppress)
+	{
+		if (suppress)
+		{
+			state = State::Start;
+			DRV_SetSpeed(0,0);
+		}
+		else
+		{
+			constexpr auto speedPerMSec = (80*76/1000);
+
+			int32_t maxSpeed = MainControl::getSpeed();
+			if (maxSpeed == 0) maxSpeed = MAX_FIGHT_SPEED;
+
+			int32_t speed = START_FIGHT_SPEED + ((TMR_ValueMs() - stateRampTime)) * speedPerMSec;
+			if (speed >= maxSpeed) speed = MAX_FIGHT_SPEED;
+
+			switch (state)
+			{
+			case State::Start:
+				stateRampTime = TMR_ValueMs();
+				state = State::Ramp;
+				break;
+			case State::Ramp:
+				DRV_SetSpeed(speed,speed);
+				state = (speed == maxSpeed) ? State::StartMax : State::Ramp;
+				break;
+			case State::StartMax:
+				stateMaxTime = TMR_ValueMs();
+				state = State::Max;
+			case State::Max:
+				DRV_SetSpeed(maxSpeed,maxSpeed);
+				if (stateMaxTime > 50)
+				{
+					state = State::StartBackMax;
+				}
+				break;
+			case State::StartBackMax:
+				stateMaxTime = TMR_ValueMs();
+				state = State::BackMax;
+				break;
+			case State::BackMax:
+				DRV_SetSpeed(-maxSpeed/10,-maxSpeed/10);
+				if (stateMaxTime > 10)
+				{
+					state = State::StartMax;
+				}
+				break;
+			}
+		}
+	}
+
+private:
+	enum class State
+	{
+		Start,
+		Ramp,
+		StartMax,
+		Max,
+		StartBackMax,
+		BackMax
+	};
+
+	uint16_t enemyDistanceLimitCm;
+	State state = State::Start;
+	uint32_t stateRampTime = 0;
+	uint32_t stateMaxTime = 0;
+};
+
+class StopBehaviour
+{
+	enum class State
+	{
+		Idle,
+		StartReversing,
+		Reversing,
+	};
+
+public:
+	explicit StopBehaviour(uint32_t reversingTimeMs)
+	: reversingTimeMs(reversingTimeMs)
+	{
+	}
+
+	bool wantsToTakeControl() const
+	{
+		return ((state != State::Idle) || (MainControl::hasStartMove() && MainControl::hasEdgeDetected()) || (MainControl::hasEdgeDetected() && REMOTE_GetOnOff()));
+	}
+
+	void step(bool suppress)
+	{
+		if (suppress)
+		{
+			state = State::Idle;
+			DRV_SetSpeed(0,0);
+		}
+		else
+		{
+			state = [&]()->State
+			{
+				switch (state)
+				{
+				case State::Idle: return idle();
+				case State::StartReversing: return startReversing();
+				case State::Reversing: return reversing();
+				}
+				ASSERT(false);
+				return State::Idle;
+			}();
+		}
+	}
+
+	State idle()
+	{
+		return State::StartReversing;
+	}
+
+	State startReversing()
+	{
+		SpeedState nonZeroSpeedState{static_cast<int32_t>(MAX_SPEED), static_cast<int32_t>(MAX_SPEED)};
+		//SpeedState nonZeroSpeedState{0, 0};
+		for (auto lastSpeed : DRV_GetLastSpeeds())
+		{
+			if (lastSpeed.left > 0 && lastSpeed.right > 0)
+			{
+				nonZeroSpeedState = lastSpeed;
+			}
+		}
+
+		DRV_SetSpeed(-0.7*nonZeroSpeedState.left, -0.7*nonZeroSpeedState.right);
+		startReversingTime = TMR_ValueMs();
+		return State::Reversing;
+	}
+
+	State reversing()
+	{
+		if ((TMR_ValueMs() - startReversingTime) < reversingTimeMs)
+		{
+			return State::Reversing;
+		}
+		else
+		{
+			DRV_SetSpeed(0, 0);
+			MainControl::notifyTurnRequested(true);
+			return State::Idle;
+		}
+	}
+
+private:
+	uint32_t reversingTimeMs;
+	State state = State::Idle;
+	uint32_t startReversingTime;
+};
+
+class TurnBehaviour
+{
+	enum class State
+	{
+		Idle,
+		StartTurning,
+		Turning
+	};
+
+public:
+	explicit TurnBehaviour(uint32_t turningTimeMs)
+	: turningTimeMs(turningTimeMs)
+	{
+	}
+
+	bool wantsToTakeControl() const
+	{
+		return ((state != State::Idle) || (MainControl::hasStartMove() && MainControl::hasTurnRequested()));
+	}
+
+	void step(bool suppress)
+	{
+		if (suppress)
+		{
+			state = State::Idle;
+			DRV_SetSpeed(0,0);
+		}
+		else
+		{
+			state = [&]()->State
+			{
+				switch (state)
+				{
+				case State::Idle: return idle();
+				case State::StartTurning: return startTurning();
+				case State::Turning: return turning();
+				}
+				ASSERT(false);
+				return State::Idle;
+			}();
+		}
+	}
+
+	State idle()
+	{
+		return State::StartTurning;
+	}
+
+
+	State startTurning()
+	{
+		startTurningTime = TMR_ValueMs();
+		return State::Turning;
+	}
+
+	State turning()
+	{
+		if ((TMR_ValueMs()-startTurningTime < turningTimeMs))
+		{
+			DRV_SetSpeed(-MAX_TURNING_SPEED,MAX_TURNING_SPEED);
+			return State::Turning;
+		}
+		else
+		{
+			DRV_SetSpeed(0, 0);
+			MainControl::notifyTurnRequested(false);
+			return State::Idle;
+		}
+	}
+
+private:
+	uint32_t turningTimeMs;
+	State state = State::Idle;
+	uint32_t startTurningTime;
+};
+
+using Behaviours = std::tuple<
+	ScanEnemyBehaviour,
+	TurnBehaviour,
+	ConstantSpeedFightBehaviour,
+	StopBehaviour,
+	StopMotorsBehaviour>;
+
+//! the behaviours of the robot, lowest priority first
+inline Behaviours makeBehaviours(const StrategyParameters& strategy = StrategyParameters{})
+{
+	return Behaviours{
+		ScanEnemyBehaviour{strategy.scanVariants, strategy.scanSeed},
+		TurnBehaviour{strategy.turningTimeMs},
+		ConstantSpeedFightBehaviour{strategy.enemyDistanceLimitCm},
+		StopBehaviour{strategy.reversingTimeMs},
+		StopMotorsBehaviour{}};
+}
@@ -3,6 +3,7 @@
 #include <Drive.h>
 #include <Reflectance.h>
 #include <FreeRTOS.h>
+#include <FRTOS1.h>
 #include <LED.h>
 #include <Timer.h>
 #include <WAIT1.h>
@@ -12,391 +13,160 @@
 #endif
 
 #include <BehaviourMachine.h>
+#include "Behaviours.h"
+#include <PeriodicExecutive.h>
+#if PL_HAS_BEHAVIOUR_TRACE
+#include <BehaviourTrace.h>
+#endif
 #include "RoboConsole.h"
 #include <random>
 
-constexpr auto MAX_TURNING_SPEED = 25*74;
-constexpr auto MAX_FIGHT_SPEED = 100*74;
-constexpr auto START_FIGHT_SPEED = 100*74;
-
-constexpr auto EnemyDistanceLimit = 50;
-constexpr auto MAX_SPEED = 100*74;
-
-static bool shouldTurn = false;
+constexpr size_t UrgentSensorPriority = 0;
+constexpr size_t NormalSensorPriority = 1;
 
-MainControl MainControl::globalMainControl;
-
-class StopMotorsBehaviour
+struct ControlClock
 {
-public:
-	bool wantsToTakeControl() const
+	static uint32_t nowUs()
 	{
-		return MainControl::hasStopMotors();
-	}
-
-	void step(bool suppress)
-	{
-		if (suppress)
-		{
-			DRV_SetSpeed(0,0);
-		}
-		else
-		{
-			DRV_SetSpeed(0,0);
-			MainControl::notifyStartMove(false);
-		}
+		return TMR_ValueUs();
 	}
 };
 
+static PeriodicExecutive<ControlClock, DisableInterrupts> controlLoop(MainControl::DefaultPeriodMs * 1000);
 
-class ScanEnemyBehaviour
-{
-public:
-	struct ScanVariant
-	{
-		ScanVariant(uint32_t timeoutMs, double left, double right)
-		: timeoutMs(timeoutMs)
-		, left(left*MAX_SPEED)
-		, right(right*MAX_SPEED)
-		{
-		}
-
-		uint32_t timeoutMs;
-		int32_t left;
-		int32_t right;
-	};
-
-	std::array<ScanVariant, 6> scanVariants = {{
-		ScanVariant{1000, 0.2, 0.3},
-		ScanVariant{1000, 0.3, 0.2},
-		ScanVariant{1000, 0.2, 0.4},
-		ScanVariant{1000, 0.4, 0.2},
-		ScanVariant{500, 0.0, 0.7},
-		ScanVariant{500, 0.7, 0.0},
-	}};
-
-	bool wantsToTakeControl() const
-	{
-		return MainControl::hasStartMove();
-	}
+#if PL_HAS_BEHAVIOUR_TRACE
+constexpr size_t NofBehaviours = std::tuple_size<Behaviours>::value;
+constexpr size_t NofBehaviourTransitions = 32;
 
-	void step(bool suppress)
-	{
-		if (suppress)
-		{
-			DRV_SetSpeed(0,0);
-		}
-		else
-		{
-			auto scanVariant = scanVariants[currentStrategy];
-			DRV_SetSpeed(scanVariant.left, scanVariant.right);
-			if ((TMR_ValueMs() - startStrategyTime) > scanVariant.timeoutMs)
-			{
-				startStrategyTime = TMR_ValueMs();
-				std::uniform_int_distribution<uint8_t> distribution(0, scanVariants.size()-1);
-				currentStrategy = distribution(randomGenerator);
-				*getConsole().getUnderlyingIoStream() << "new variant: " << static_cast<uint32_t>(currentStrategy) << "\n";
-			}
-		}
-	}
-
-private:
-	uint32_t startStrategyTime = 0;
-	std::ranlux24 randomGenerator;
-	uint8_t currentStrategy = 0;
+//! bits of BehaviourInputs::flags, BehaviourInputs::value is the enemy distance
+enum InputFlag : uint8_t
+{
+	EdgeDetectedInput = 0x1,
+	StartMoveInput = 0x2,
+	StopMotorsInput = 0x4
 };
 
-class ConstantSpeedFightBehaviour
+static BehaviourTrace<NofBehaviours, NofBehaviourTransitions, ControlClock, DisableInterrupts> behaviourTrace;
+
+struct MainControlTracer
 {
-public:
-	bool wantsToTakeControl() const
+	void switched(uint8_t from, uint8_t to)
 	{
-		return isFighting || ((MainControl::getEnemyDistance()<EnemyDistanceLimit) && MainControl::hasStartMove());
+		BehaviourInputs inputs;
+		inputs.flags = (MainControl::hasEdgeDetected() ? EdgeDetectedInput : 0)
+			| (MainControl::hasStartMove() ? StartMoveInput : 0)
+			| (MainControl::hasStopMotors() ? StopMotorsInput : 0);
+		inputs.value = MainControl::getEnemyDistance();
+		behaviourTrace.switched(from, to, inputs);
 	}
 
-	void step(bool suppress)
+	void stepped(uint8_t behaviour, bool suppressed)
 	{
-		if (suppress)
-		{
-			isFighting = false;
-			DRV_SetSpeed(0,0);
-		}
-		else
-		{
-			if (!isFighting || (MainControl::getEnemyDistance()<EnemyDistanceLimit))
-			{
-				startFightTime = TMR_ValueMs();
-				isFighting = true;
-				DRV_SetSpeed(MAX_FIGHT_SPEED, MAX_FIGHT_SPEED);
-			}
-			else
-			{
-				if ((TMR_ValueMs() - startFightTime) > 500)
-				{
-					isFighting = false;
-				}
-			}
-		}
+		behaviourTrace.stepped(behaviour, suppressed, DRV_GetNofSpeedCommands());
 	}
-
-private:
-	bool isFighting = false;
-	uint32_t startFightTime = 0;
 };
+#else
+using MainControlTracer = NoBehaviourTracer;
+#endif
 
-class StaggeringFightBehaviour
+//! an input which needs a reaction was seen, the latency until the drive is commanded is traced
+static void traceStimulus(uint32_t timestampUs)
 {
-public:
-	bool wantsToTakeControl() const
-	{
-		return ((MainControl::getEnemyDistance()<EnemyDistanceLimit) && MainControl::hasStartMove());
-	}
-
-	void step(bool suppress)
-	{
-		if (suppress)
-		{
-			state = State::Start;
-			DRV_SetSpeed(0,0);
-		}
-		else
-		{
-			constexpr auto speedPerMSec = (80*76/1000);
+#if PL_HAS_BEHAVIOUR_TRACE
+	behaviourTrace.stimulus(timestampUs);
+#else
+	(void)timestampUs;
+#endif
+}
 
-			int32_t maxSpeed = MainControl::getSpeed();
-			if (maxSpeed == 0) maxSpeed = MAX_FIGHT_SPEED;
+constexpr uint8_t MainControl::DefaultPeriodMs;
+MainControl MainControl::globalMainControl;
 
-			int32_t speed = START_FIGHT_SPEED + ((TMR_ValueMs() - stateRampTime)) * speedPerMSec;
-			if (speed >= maxSpeed) speed = MAX_FIGHT_SPEED;
+void MainControl::task(void*)
+{
+	auto arbitrator = makeTracedArbitrator<MainControlTracer>(makeBehaviours());
 
-			switch (state)
+	WAIT1_WaitOSms(1000);
+	auto lastWakeTime = FRTOS1_xTaskGetTickCount();
+	for (;;)
+	{
+		auto overran = controlLoop.runCycle(
+			[]
 			{
-			case State::Start:
-				stateRampTime = TMR_ValueMs();
-				state = State::Ramp;
-				break;
-			case State::Ramp:
-				DRV_SetSpeed(speed,speed);
-				state = (speed == maxSpeed) ? State::StartMax : State::Ramp;
-				break;
-			case State::StartMax:
-				stateMaxTime = TMR_ValueMs();
-				state = State::Max;
-			case State::Max:
-				DRV_SetSpeed(maxSpeed,maxSpeed);
-				if (stateMaxTime > 50)
+				handleSensorMessages();
+				auto edgeWasDetected = hasEdgeDetected();
+				notifyEdgeDetected(REF_SeesLine());
+				if (hasEdgeDetected() && !edgeWasDetected)
 				{
-					state = State::StartBackMax;
+					traceStimulus(ControlClock::nowUs());
 				}
-				break;
-			case State::StartBackMax:
-				stateMaxTime = TMR_ValueMs();
-				state = State::BackMax;
-				break;
-			case State::BackMax:
-				DRV_SetSpeed(-maxSpeed/10,-maxSpeed/10);
-				if (stateMaxTime > 10)
+			},
+			[&]{ arbitrator.decide(); },
+			[&]
+			{
+				if (hasEdgeDetected())
 				{
-					state = State::StartMax;
+					LED1_On();
 				}
-				break;
-			}
-		}
-	}
-
-private:
-	enum class State
-	{
-		Start,
-		Ramp,
-		StartMax,
-		Max,
-		StartBackMax,
-		BackMax
-	};
-
-	State state = State::Start;
-	uint32_t stateRampTime = 0;
-	uint32_t stateMaxTime = 0;
-};
-
-class StopBehaviour
-{
-	enum class State
-	{
-		Idle,
-		StartReversing,
-		Reversing,
-	};
-
-public:
-	bool wantsToTakeControl() const
-	{
-		return ((state != State::Idle) || (MainControl::hasStartMove() && MainControl::hasEdgeDetected()) || (MainControl::hasEdgeDetected() && REMOTE_GetOnOff()));
-	}
-
-	void step(bool suppress)
-	{
-		if (suppress)
-		{
-			state = State::Idle;
-			DRV_SetSpeed(0,0);
-		}
-		else
-		{
-			state = [&]()->State
-			{
-				switch (state)
+				else
 				{
-				case State::Idle: return idle();
-				case State::StartReversing: return startReversing();
-				case State::Reversing: return reversing();
+					LED1_Off();
 				}
-				ASSERT(false);
-				return State::Idle;
-			}();
-		}
-	}
-
-	State idle()
-	{
-		return State::StartReversing;
-	}
-
-	State startReversing()
-	{
-		SpeedState nonZeroSpeedState{static_cast<int32_t>(MAX_SPEED), static_cast<int32_t>(MAX_SPEED)};
-		//SpeedState nonZeroSpeedState{0, 0};
-		for (auto lastSpeed : DRV_GetLastSpeeds())
-		{
-			if (lastSpeed.left > 0 && lastSpeed.right > 0)
-			{
-				nonZeroSpeedState = lastSpeed;
+				arbitrator.act();
 			}
-		}
-
-		DRV_SetSpeed(-0.7*nonZeroSpeedState.left, -0.7*nonZeroSpeedState.right);
-		startReversingTime = TMR_ValueMs();
-		return State::Reversing;
-	}
-
-	State reversing()
-	{
-		if ((TMR_ValueMs() - startReversingTime) < 300)
-		{
-			return State::Reversing;
-		}
-		else
+		);
+		if (overran)
 		{
-			DRV_SetSpeed(0, 0);
-			shouldTurn = true;
-			return State::Idle;
+			lastWakeTime = FRTOS1_xTaskGetTickCount();
 		}
+		FRTOS1_vTaskDelayUntil(&lastWakeTime, globalMainControl.periodMs.load()/portTICK_RATE_MS);
 	}
+}
 
-private:
-	State state = State::Idle;
-	uint32_t startReversingTime;
-};
-
-class TurnBehaviour
+void MainControl::setPeriodMs(uint8_t periodMs)
 {
-	enum class State
-	{
-		Idle,
-		StartTurning,
-		Turning
-	};
-
-public:
-	bool wantsToTakeControl() const
-	{
-		return ((state != State::Idle) || (MainControl::hasStartMove() && shouldTurn));
-	}
-
-	void step(bool suppress)
-	{
-		if (suppress)
-		{
-			state = State::Idle;
-			DRV_SetSpeed(0,0);
-		}
-		else
-		{
-			state = [&]()->State
-			{
-				switch (state)
-				{
-				case State::Idle: return idle();
-				case State::StartTurning: return startTurning();
-				case State::Turning: return turning();
-				}
-				ASSERT(false);
-				return State::Idle;
-			}();
-		}
-	}
-
-	State idle()
+	if (periodMs == 0)
 	{
-		return State::StartTurning;
+		periodMs = 1;
 	}
+	globalMainControl.periodMs.store(periodMs);
+	controlLoop.setPeriodUs(periodMs * 1000);
+}
 
+void MainControl::printControlStats(IOStream& ioStream)
+{
+	auto stats = controlLoop.getStats();
+	ioStream << "period: " << stats.periodUs << " us, cycles: " << stats.cycles << ", overruns: " << stats.overruns << "\n";
+	ioStream << "exec: last " << stats.lastExecUs << " us, wcet " << stats.wcetUs
+		<< " us (sense " << stats.phaseWcetUs[static_cast<size_t>(ControlPhase::Sense)]
+		<< ", decide " << stats.phaseWcetUs[static_cast<size_t>(ControlPhase::Decide)]
+		<< ", act " << stats.phaseWcetUs[static_cast<size_t>(ControlPhase::Act)] << ")\n";
+	ioStream << "jitter: avg " << stats.averageJitterUs() << " us, max " << stats.maxJitterUs << " us\n";
+}
 
-	State startTurning()
-	{
-		startTurningTime = TMR_ValueMs();
-		return State::Turning;
-	}
+void MainControl::clearControlStats()
+{
+	controlLoop.clearStats();
+}
 
-	State turning()
+#if PL_HAS_BEHAVIOUR_TRACE
+void MainControl::dumpBehaviourTrace(IOStream& ioStream)
+{
+	static std::array<BehaviourTransitionRecord, NofBehaviourTransitions> records; //not on the stack of the console task
+	auto count = behaviourTrace.copyTransitions(records);
+	std::array<LatencyHistogram, NofBehaviours> latencies;
+	for (auto behaviour = size_t{0}; behaviour < NofBehaviours; ++behaviour)
 	{
-		if ((TMR_ValueMs()-startTurningTime < 900))
-		{
-			DRV_SetSpeed(-MAX_TURNING_SPEED,MAX_TURNING_SPEED);
-			return State::Turning;
-		}
-		else
-		{
-			DRV_SetSpeed(0, 0);
-			shouldTurn = false;
-			return State::Idle;
-		}
+		latencies[behaviour] = behaviourTrace.getLatencies(behaviour);
 	}
+	writeBehaviourTrace(ioStream, records.data(), count, latencies);
+}
 
-private:
-	State state = State::Idle;
-	uint32_t startTurningTime;
-};
-
-void MainControl::task(void*)
+void MainControl::clearBehaviourTrace()
 {
-	auto arbitrator = makeArbitrator(std::make_tuple(
-		ScanEnemyBehaviour(),
-		TurnBehaviour(),
-		ConstantSpeedFightBehaviour(),
-		StopBehaviour(),
-		StopMotorsBehaviour())
-	);
-
-	//uint8_t counter = 0;
-	static uint8_t waitAtPowerUp = 0;
-	for (;;)
-	{
-		if(waitAtPowerUp==0) { WAIT1_Waitms(1000); waitAtPowerUp = 1;}
-		notifyEdgeDetected(REF_SeesLine());
-		if (hasEdgeDetected())
-		{
-		    LED1_On();
-		}
-		else
-		{
-		    LED1_Off();
-		}
-
-		arbitrator.step();
-	}
+	behaviourTrace.clear();
 }
+#endif
 
 void MainControl::notifyEdgeDetected(bool detected)
 {
@@ -410,7 +180,7 @@ void MainControl::notifyStartMove(bool start)
 
 void MainControl::notifyStopMotors(bool stop)
 {
-	globalMainControl.stopMotors.store(stop);
+	postSensorMessage(UrgentSensorPriority, SensorMessage::Kind::StopMotors, stop);
 }
 
 void MainControl::notifyEnemyDetected(uint16_t cm)
@@ -420,9 +190,62 @@ void MainControl::notifyEnemyDetected(uint16_t cm)
 		*getConsole().getUnderlyingIoStream() << cm << "\n";
 	}
 
-	globalMainControl.enemyDistance.store(cm);
+	postSensorMessage(NormalSensorPriority, SensorMessage::Kind::EnemyDistance, cm);
+}
+
+void MainControl::postSensorMessage(size_t priority, SensorMessage::Kind kind, uint16_t value)
+{
+	globalMainControl.sensorMessages.try_push(priority, SensorMessage{kind, value, TMR_ValueMs()});
+}
+
+/**
+ * handles the messages one by one in the order they are dequeued. Once a kind of message was
+ * handled in this cycle, the next one of that kind waits for the next cycle, so the behaviours
+ * decide on every sample and e.g. a short stop is not folded away by the message after it.
+ */
+void MainControl::handleSensorMessages()
+{
+	bool handledKinds[NofSensorKinds] = {};
+	auto& deferred = globalMainControl.deferredSensorMessage;
+	if (deferred)
+	{
+		handleSensorMessage(*deferred, handledKinds);
+		deferred.reset();
+	}
+	for (auto message = globalMainControl.sensorMessages.try_pop(); message; message = globalMainControl.sensorMessages.try_pop())
+	{
+		if (!handleSensorMessage(*message, handledKinds))
+		{
+			deferred = message;
+			return;
+		}
+	}
 }
 
+bool MainControl::handleSensorMessage(const SensorMessage& message, bool (&handledKinds)[NofSensorKinds])
+{
+	auto kind = static_cast<size_t>(message.kind);
+	if (handledKinds[kind])
+	{
+		return false;
+	}
+	handledKinds[kind] = true;
+
+	switch (message.kind)
+	{
+	case SensorMessage::Kind::StopMotors:
+		globalMainControl.stopMotors.store(message.value != 0);
+		break;
+	case SensorMessage::Kind::EnemyDistance:
+		if (message.value < EnemyDistanceLimit && globalMainControl.enemyDistance.load() >= EnemyDistanceLimit)
+		{
+			traceStimulus(message.timestampMs * 1000);
+		}
+		globalMainControl.enemyDistance.store(message.value);
+		break;
+	}
+	return true;
+}
 
 void MainControl::setSpeed(int8_t wantedSpeed)
 {
@@ -449,6 +272,16 @@ bool MainControl::hasStartMove()
 	return globalMainControl.startMove.load();
 }
 
+void MainControl::notifyTurnRequested(bool requested)
+{
+	globalMainControl.turnRequested.store(requested);
+}
+
+bool MainControl::hasTurnRequested()
+{
+	return globalMainControl.turnRequested.load();
+}
+
 bool MainControl::hasStopMotors()
 {
 	return globalMainControl.stopMotors.load();
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <Platform.h>
 #include <CircularBuffer.h>
+#include <CriticalSection.h>
 #include <Mutex.h>
+#include <PriorityMessageQueue.h>
+#include <Optional.h>
 #include <atomic>
 
+//fwd decls
+class IOStream;
+
 struct Config
 {
 	enum FleeDirection {
@@ -13,6 +20,19 @@ struct Config
 	FleeDirection fleeDir;
 };
 
+struct SensorMessage
+{
+	enum class Kind : uint8_t
+	{
+		StopMotors,
+		EnemyDistance
+	};
+
+	Kind kind;
+	uint16_t value;
+	uint32_t timestampMs;
+};
+
 class MainControl
 {
 public:
@@ -24,12 +44,27 @@ public:
 	};
 
 public:
+	static constexpr uint8_t DefaultPeriodMs = 5;
+
+	/**
+	 * control loop: runs a sense-decide-act cycle of the behaviours every period
+	 */
 	static void task(void*);
 
+	static void setPeriodMs(uint8_t periodMs);
+	static void printControlStats(IOStream& ioStream);
+	static void clearControlStats();
+#if PL_HAS_BEHAVIOUR_TRACE
+	static void dumpBehaviourTrace(IOStream& ioStream);
+	static void clearBehaviourTrace();
+#endif
+
 	static void notifyEdgeDetected(bool detected);
 	static void notifyStartMove(bool start);
 	static void notifyEnemyDetected(uint16_t cm);
 	static void notifyStopMotors(bool stop);
+	//! the StopBehaviour backed off the edge, the TurnBehaviour turns away from it
+	static void notifyTurnRequested(bool requested);
 
 	static void setSpeed(int8_t wantedSpeed);
 
@@ -37,15 +72,29 @@ public:
 	static int16_t getSpeed();
 	static bool hasStartMove();
 	static bool hasStopMotors();
+	static bool hasTurnRequested();
 	static uint16_t getEnemyDistance();
 
 	static void setConfig(Config config);
 	static Config getConfig();
 
 private:
+	static constexpr size_t NofSensorPriorities = 2;
+	static constexpr size_t SensorLaneCapacity = 8;
+	static constexpr size_t NofSensorKinds = 2;
+
+	static void postSensorMessage(size_t priority, SensorMessage::Kind kind, uint16_t value);
+	static void handleSensorMessages();
+	//! \return false if the kind of the message was already handled in this cycle
+	static bool handleSensorMessage(const SensorMessage& message, bool (&handledKinds)[NofSensorKinds]);
+
+	PriorityMessageQueue<SensorMessage, NofSensorPriorities, SensorLaneCapacity, DisableInterrupts> sensorMessages;
+	optional<SensorMessage> deferredSensorMessage;	//!< dequeued, but waiting for the next cycle
+
 	std::atomic_bool edgeDetected;
 	std::atomic_bool startMove;
 	std::atomic_bool stopMotors;
+	std::atomic_bool turnRequested;
 	std::atomic_uint_fast16_t enemyDistance;
 	State state;
 
@@ -53,6 +102,7 @@ private:
 	Config config;
 
 	std::atomic<int8_t> speed;
+	std::atomic<uint8_t> periodMs{DefaultPeriodMs};
 
 	static MainControl globalMainControl;
 };
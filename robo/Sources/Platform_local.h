@@ -18,6 +18,12 @@
 #define PL_L_HAS_EVENT		(1)
 /*!< Set to 1 to enable EVENT support, 0 otherwise */
 
+#define PL_L_HAS_EVENT_TRACE	(1)
+/*!< Set to 1 to enable the event trace, 0 otherwise */
+
+#define PL_L_HAS_BEHAVIOUR_TRACE	(1)
+/*!< Set to 1 to enable the behaviour switch trace, 0 otherwise */
+
 #define PL_L_HAS_TIMER		(1)
 /*! Set to 1 to enable TIMER support, 0 otherwise */
 
@@ -39,6 +45,9 @@
 #define PL_L_HAS_TRIGGER        (1)
   /*!< Set to 1 for trigger enabled, 0 otherwise */
 
+#define PL_L_HAS_TRIGGER_STATS  (1)
+  /*!< Set to 1 for trigger callback execution times, 0 otherwise */
+
 #define PL_L_HAS_SHELL          (1)
   /*!< Set to 1 for shell enabled, 0 otherwise */
 
@@ -38,9 +38,7 @@ extern "C" {
 #include "Music.h"
 #endif
 
-extern "C" {
 #include "Reflectance.h"
-}
 
 CLS1_StdIOType io;
 #if PL_HAS_MUSIC_SHIELD
@@ -55,7 +53,8 @@ void TASK_events(void*)
 	Console& console = getConsole();
 	for(;;)
 	{
-		handleOneEvent(eventQueue,
+		eventQueue.waitForEvents();
+		handleAllEvents(eventQueue,
 			systemReady,
 			doLedHeartbeat,
 			[&]{ console.getUnderlyingIoStream()->write("Key_A_Pressed!\n");
@@ -89,9 +88,8 @@ void TASK_events(void*)
 			[&]{ console.getUnderlyingIoStream()->write("Key_A_Long_Pressed!\n"); eventQueue.setEvent(Event::RefStartStopCalibration); },
 			[&]{ console.getUnderlyingIoStream()->write("Key_A_Released!\n"); },
 			[&]{ console.getUnderlyingIoStream()->write("Key_A_Released_Long!\n"); },
-			[]{eventQueue.setEvent(Event::RefStartStopCalibration);}
+			REF_StartStopCalibration
 		);
-		WAIT1_WaitOSms(10);
 	}
 }
 
@@ -100,7 +98,7 @@ void TASK_keyscan(void*)
 	for(;;)
 	{
 		KEY_Scan();
-		WAIT1_WaitOSms(10);
+		WAIT1_WaitOSms(KEYDBNC_SCAN_PERIOD_MS);
 	}
 }
 
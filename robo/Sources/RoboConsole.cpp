@@ -12,13 +12,17 @@
 #include <AutoArgsCommand.h>
 #include <LegacyArgsCommand.h>
 #include <LineEndingNormalizerIOStream.h>
+#include <BinaryProtocol.h>
 
 #include "Event.h"
+#include "EventTrace.h"
 #include "Buzzer.h"
+#include "Trigger.h"
 #include "QuadCalib.h"
 #include "Tacho.h"
 #include "Drive.h"
 #include "Pid.h"
+#include "Timer.h"
 #include "Ultrasonic.h"
 #include "Accel.h"
 #include "RNet_App.h"
@@ -30,33 +34,103 @@
 
 #include <BT1.h>
 
+namespace
+{
+	//! TachoSpeeds requested by StreamTacho, sent by TASK_console
+	struct TachoStream
+	{
+		BinaryChannel* pChannel = nullptr;
+		uint16_t periodMs = 0;
+		uint32_t lastSentMs = 0;
+	} tachoStream;
+
+	class RoboBinaryHandler
+	{
+	public:
+		void received(BinaryChannel& channel, const binmsg::Ping& ping)
+		{
+			channel.send(binmsg::Pong{ping.sequence});
+		}
+
+		void received(BinaryChannel& channel, const binmsg::SetSpeedPid& pid)
+		{
+			PID_SetSpeedConfig(pid.isLeft != 0, pid.pFactor100, pid.iFactor100, pid.dFactor100, pid.iAntiWindup);
+			channel.send(binmsg::Ack{static_cast<uint8_t>(MessageId::SetSpeedPid), 1});
+		}
+
+		void received(BinaryChannel& channel, const binmsg::StreamTacho& request)
+		{
+			tachoStream.pChannel = &channel;
+			tachoStream.periodMs = request.periodMs;
+			tachoStream.lastSentMs = TMR_ValueMs();
+			channel.send(binmsg::Ack{static_cast<uint8_t>(MessageId::StreamTacho), 1});
+		}
+
+		//! the messages of the robot itself
+		template <typename Message>
+		void received(BinaryChannel& /*channel*/, const Message& /*message*/)
+		{
+		}
+	};
+
+	void sendTachoIfDue()
+	{
+		if (tachoStream.pChannel == nullptr || tachoStream.periodMs == 0 || !tachoStream.pChannel->isBinaryMode())
+		{
+			return;
+		}
+		auto nowMs = TMR_ValueMs();
+		if (nowMs - tachoStream.lastSentMs < tachoStream.periodMs)
+		{
+			return;
+		}
+		tachoStream.lastSentMs = nowMs;
+		tachoStream.pChannel->send(binmsg::TachoSpeeds{nowMs, TACHO_GetSpeed(true), TACHO_GetSpeed(false)});
+	}
+}
+
 CommandParser& getCommandParser()
 {
 	static auto parser = makeParser(
 		cmd("help", [&](IOStream& ioStream)
 		{
-			std::array<String<10>, 20>cmds{};
-			getCommandParser().getAvailableCommands(cmds.data(), cmds.size());
 			ioStream.write("available commands:\n");
-			for (const auto& cmd : cmds)
+			for (const auto& command : getCommandParser().getCommands())
 			{
-				if (cmd.size() > 0)
+				if (command.name.size() > 0)
 				{
-					ioStream.write(cmd);
-					ioStream.write("\n");
+					writeCommandHelp(ioStream, command);
 				}
 			}
-		}),
-		cmd("showstat", showStat),
-		cmd("refstat", REF_PrintStatus),
-		cmd("startcalib",[&](){eventQueue.setEvent(Event::RefStartStopCalibration);}),
-		cmd("stopcalib",[&](){eventQueue.setEvent(Event::RefStartStopCalibration);}),
-		cmd("motstat", MOT_CmdStatus),
-		cmd("motdir", MOT_CmdDir),
-		cmd("motduty", MOT_CmdDuty),
-		cmd("startstop", []{ MainControl::notifyStartMove(!MainControl::hasStartMove()); }),
-		cmd("setSpeed", MainControl::setSpeed),
+		}, "this list, legacy ones have \"<name> help\""),
+		cmd("showstat", showStat, "system state"),
+		cmd("refstat", REF_PrintStatus, "reflectance sensors"),
+		cmd("startcalib",[&](){eventQueue.setEvent(Event::RefStartStopCalibration);}, "start reflectance calibration"),
+		cmd("stopcalib",[&](){eventQueue.setEvent(Event::RefStartStopCalibration);}, "stop reflectance calibration"),
+		cmd("motstat", MOT_CmdStatus, "motors"),
+		cmd("motdir", MOT_CmdDir, "L|R forward|backward"),
+		cmd("motduty", MOT_CmdDuty, "L|R 0-100"),
+		cmd("drvstat", DRV_CmdStatus, "drive"),
+		cmd("drvctrl", DRV_CmdSpeedControl, "speed control"),
+		cmd("drvspeed", DRV_CmdSpeed, "speed of a motor"),
+		cmd("pidstat", PID_CmdStatus, "speed PIDs"),
+		cmd("pidspeed", PID_CmdSpeedGain, "gain of a speed PID"),
+		cmd("pidwindup", PID_CmdSpeedWindup, "anti-windup of a speed PID"),
+		cmd("startstop", []{ MainControl::notifyStartMove(!MainControl::hasStartMove()); }, "start or stop the strategy"),
+		cmd("setSpeed", MainControl::setSpeed, "speed of the strategy"),
+		cmd("ctrlstat", MainControl::printControlStats, "control cycle timing"),
+		cmd("ctrlclear", MainControl::clearControlStats, "reset the control cycle timing"),
+		cmd("ctrlperiod", MainControl::setPeriodMs, "control period in ms"),
+#if PL_HAS_EVENT_TRACE
+		cmd("trcdump", EVTR_Dump, "dump the event trace"),
+		cmd("trcclear", EVTR_Clear, "clear the event trace"),
+#endif
+#if PL_HAS_BEHAVIOUR_TRACE
+		cmd("bhdump", MainControl::dumpBehaviourTrace, "dump the behaviour trace"),
+		cmd("bhclear", MainControl::clearBehaviourTrace, "clear the behaviour trace"),
+#endif
 		legacyCmd(BUZ_ParseCommand),
+		legacyCmd(TRG_ParseCommand),
 		legacyCmd(QUADCALIB_ParseCommand),
 		legacyCmd(DRV_ParseCommand),
 		legacyCmd(PID_ParseCommand),
@@ -79,11 +153,15 @@ Console& getConsole()
 {
 	static auto console = makeConsole(
 		LineEndingNormalizerIOStream<
-			CdcStaticIOStream<
-				//Serial2_RecvChar,
-				Serial1_RecvChar,
-				//Serial2_SendChar
-				Serial1_SendChar
+			//the binary frames pass below the text console, see BinaryProtocol.h
+			BinaryFramingIOStream<
+				CdcStaticIOStream<
+					//Serial2_RecvChar,
+					Serial1_RecvChar,
+					//Serial2_SendChar
+					Serial1_SendChar
+				>,
+				RoboBinaryHandler
 			>
 		>{},
 		makeLineInputStrategy<
@@ -94,7 +172,8 @@ Console& getConsole()
 				HistoryController<
 					String<20>, //line size
 					5 //history length
-				>{}
+				>{},
+				CommandNameCompleter{&getCommandParser()}
 			)
 	);
 
@@ -108,6 +187,7 @@ void TASK_console(void*)
 	for(;;)
 	{
 		console.pollInput();
+		sendTachoIfDue();
 		WAIT1_WaitOSms(1);
 	}
 }
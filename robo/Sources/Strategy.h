@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+/*
+ * The tunable parameters of the behaviours in Behaviours.h. The robot runs with the defaults,
+ * the tournament of the arena simulator (unittests/arena) plays variations of them.
+ */
+#include <array>
+#include <cstdint>
+#include <random>
+
+constexpr auto MAX_SPEED = 100*74;
+
+constexpr auto EnemyDistanceLimit = 50;
+
+/**
+ * one way of searching the enemy: wheel speeds given as fraction of MAX_SPEED, for timeoutMs
+ */
+struct ScanVariant
+{
+	ScanVariant(uint32_t timeoutMs, double left, double right)
+	: timeoutMs(timeoutMs)
+	, left(left*MAX_SPEED)
+	, right(right*MAX_SPEED)
+	{
+	}
+
+	uint32_t timeoutMs;
+	int32_t left;
+	int32_t right;
+};
+
+using ScanVariants = std::array<ScanVariant, 6>;
+
+struct StrategyParameters
+{
+	//! ScanEnemyBehaviour picks one of these at random whenever the current one timed out
+	ScanVariants scanVariants = {{
+		ScanVariant{1000, 0.2, 0.3},
+		ScanVariant{1000, 0.3, 0.2},
+		ScanVariant{1000, 0.2, 0.4},
+		ScanVariant{1000, 0.4, 0.2},
+		ScanVariant{500, 0.0, 0.7},
+		ScanVariant{500, 0.7, 0.0},
+	}};
+	uint32_t scanSeed = std::ranlux24_base::default_seed; //!< the default of std::ranlux24
+
+	uint16_t enemyDistanceLimitCm = EnemyDistanceLimit;	//!< ConstantSpeedFightBehaviour attacks below
+	uint32_t reversingTimeMs = 300;	//!< StopBehaviour backs off the edge that long
+	uint32_t turningTimeMs = 900;	//!< TurnBehaviour turns that long after backing off
+};
@@ -13,9 +13,13 @@ class AutoArgsCommand
 public:
 	using traits = function_traits<Fn>;
 
-	AutoArgsCommand(String<10> cmd, Fn fn)
+	//! handles only command lines starting with its name, see ConcreteCommandParser
+	static constexpr bool MatchesOnlyItsName = true;
+
+	AutoArgsCommand(String<10> cmd, Fn fn, const char* pHelp)
 		: cmd(cmd)
 		, fn(fn)
+		, pHelp(pHelp)
 	{
 	}
 
@@ -29,7 +33,9 @@ public:
 
 			if (!result)
 			{
-				ioStream << "error. syntax: " << getSyntax() << "\n";
+				ioStream << "error. syntax: " << cmd;
+				writeParamsSyntax(ioStream);
+				ioStream << "\n";
 			}
 			return true;
 		}
@@ -44,12 +50,12 @@ public:
 		return cmd;
 	}
 
-private:
-	String<80> getSyntax() const
+	CommandInfo getInfo() const
 	{
-		return getSyntaxImpl(FirstParameterIsIOStream<Fn>());
+		return CommandInfo{cmd, pHelp, &AutoArgsCommand::writeParamsSyntax};
 	}
 
+private:
 	bool matches(const String<MaxCommandLength>& cmdToExecute)
 	{
 		if (cmd.size() > cmdToExecute.size())
@@ -70,56 +76,55 @@ private:
 	//! called in case when the stored function does not want do do I/O
 	bool executeImpl(IOStream& /*ioStream*/, const String<MaxCommandLength>& cmdToExecute, std::false_type)
 	{
-		auto parameters = detail::Parameters<traits::AmountOfArguments>::parseParameters(&cmdToExecute);
+		auto parameters = detail::Parameters<traits::AmountOfArguments>::parseParameters(cmdToExecute);
 
 		if (!parameters)
 			return false; //error during parsing
 
-		return Executor<Fn, traits::AmountOfArguments>::executeImpl(fn, cmdToExecute, *parameters);
+		return Executor<Fn, traits::AmountOfArguments>::executeImpl(fn, *parameters);
 	}
 
 	//! called in case when the stored function *does* want do do I/O
 	bool executeImpl(IOStream& ioStream, const String<MaxCommandLength>& cmdToExecute, std::true_type)
 	{
 		using Adapter = typename traits::template GetIoStreamRemovedAdapter<Fn>::type;
-		auto parameters = detail::Parameters<traits::AmountOfArguments - 1>::parseParameters(&cmdToExecute);
+		auto parameters = detail::Parameters<traits::AmountOfArguments - 1>::parseParameters(cmdToExecute);
 
 		if (!parameters)
 			return false; //error during parsing
 
-		return Executor<Adapter, traits::AmountOfArguments - 1>::executeImpl(Adapter{ioStream, fn}, cmdToExecute, *parameters);
+		return Executor<Adapter, traits::AmountOfArguments - 1>::executeImpl(Adapter{ioStream, fn}, *parameters);
 	}
 
-	//! called in case when the stored function does not want do do I/O
-	String<80> getSyntaxImpl(std::false_type) const
+	static void writeParamsSyntax(IOStream& ioStream)
 	{
-		String<80> syntax;
-		syntax.append(cmd);
-		Executor<Fn, traits::AmountOfArguments>::appendParams(syntax);
+		writeParamsSyntax(ioStream, FirstParameterIsIOStream<Fn>());
+	}
 
-		return syntax;
+	//! called in case when the stored function does not want do do I/O
+	static void writeParamsSyntax(IOStream& ioStream, std::false_type)
+	{
+		Executor<Fn, traits::AmountOfArguments>::writeParams(ioStream);
 	}
 
 	//! called in case when the stored function *does* want do do I/O
-	String<80> getSyntaxImpl(std::true_type) const
+	static void writeParamsSyntax(IOStream& ioStream, std::true_type)
 	{
 		using Adapter = typename traits::template GetIoStreamRemovedAdapter<Fn>::type;
-		String<80> syntax;
-		syntax.append(cmd);
-		Executor<Adapter, traits::AmountOfArguments - 1>::appendParams(syntax);
-
-		return syntax;
+		Executor<Adapter, traits::AmountOfArguments - 1>::writeParams(ioStream);
 	}
 
 private:
 	String<10> cmd;
 	Fn fn;
+	const char* pHelp;
 };
 
 }
 
+//! \param pHelp shown by help, has to be a string literal (or live as long as the parser)
 template <typename Fn>
-detail::AutoArgsCommand<Fn> cmd(const String<10>& cmd, Fn fn)
+detail::AutoArgsCommand<Fn> cmd(const String<10>& cmd, Fn fn, const char* pHelp = nullptr)
 {
-	return detail::AutoArgsCommand<Fn>(cmd, fn);
+	return detail::AutoArgsCommand<Fn>(cmd, fn, pHelp);
 }
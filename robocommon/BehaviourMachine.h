@@ -1,8 +1,11 @@
 #ifndef BEHAVIOURMACHINE_H
 #define BEHAVIOURMACHINE_H
 
-#include <utility>
+#include <cstdint>
+#include <limits>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include <Optional.h>
 
@@ -13,84 +16,126 @@ public:
 	void step(bool suppress);
 };
 
+namespace detail
+{
+	//sentinel: nobody wants to take control
+	template <typename Tuple>
+	uint8_t findHighestClaimant(const Tuple& /*behaviours*/, std::integral_constant<std::size_t, 0>)
+	{
+		return std::numeric_limits<uint8_t>::max();
+	}
+
+	//! asks from the highest priority down and stops at the first one which wants to take control
+	template <typename Tuple, std::size_t Count>
+	uint8_t findHighestClaimant(const Tuple& behaviours, std::integral_constant<std::size_t, Count>)
+	{
+		return std::get<Count - 1>(behaviours).wantsToTakeControl()
+			? Count - 1
+			: findHighestClaimant(behaviours, std::integral_constant<std::size_t, Count - 1>{});
+	}
+}
+
+/**
+ * Tracer of an Arbitrator without tracing, see BehaviourTrace.h
+ */
+struct NoBehaviourTracer
+{
+	//! called by act() before from is suppressed, to is uint8_t max if none wants to take control
+	void switched(uint8_t /*from*/, uint8_t /*to*/)
+	{
+	}
+
+	//! called after every step of a behaviour
+	void stepped(uint8_t /*behaviour*/, bool /*suppressed*/)
+	{
+	}
+};
+
 /**
  * index of behaviour == priority of behaviour
  * higher the index => higher priority
+ *
+ * Tracer is told about every switch of the behaviour and every step, see NoBehaviourTracer.
  */
-template <typename... Behaviours>
-class Arbitrator
+template <typename Tracer, typename... Behaviours>
+class TracedArbitrator
 {
+	static_assert(sizeof...(Behaviours) < std::numeric_limits<uint8_t>::max(), "too many behaviours");
+
 public:
-	explicit Arbitrator(std::tuple<Behaviours...> behaviours)
+	explicit TracedArbitrator(std::tuple<Behaviours...> behaviours, Tracer tracer = {})
 		: behaviours(std::move(behaviours))
+		, tracer(tracer)
 	{
 	}
 
-	//sentinel
-	template<std::size_t I = 0, typename Fn, typename... Tp>
-	static typename std::enable_if<(I == sizeof...(Tp)), void>::type findBehaviourThatWantsToTakeContro(Fn /*fn*/, std::tuple<Tp...>& /*t*/) {}
-
-	template<std::size_t I = 0, typename Fn, typename... Tp>
-	static typename std::enable_if<(I < sizeof...(Tp)), void>::type findBehaviourThatWantsToTakeContro(Fn fn, std::tuple<Tp...>& t)
+	void step()
 	{
-		auto&& behaviour = std::get<I>(t);
-
-		if (behaviour.wantsToTakeControl())
-		{
-			fn(I);
-		}
-
-		findBehaviourThatWantsToTakeContro<I + 1, Fn, Tp...>(fn, t);
+		decide();
+		act();
 	}
 
+	/**
+	 * chooses the behaviour for the next act(), only asks wantsToTakeControl()
+	 * \return index of the chosen behaviour, uint8_t max if none wants to take control
+	 */
+	uint8_t decide()
+	{
+		nextBehaviour = detail::findHighestClaimant(behaviours, std::integral_constant<std::size_t, sizeof...(Behaviours)>{});
+		return nextBehaviour;
+	}
 
-	//sentinel
-	template<std::size_t I = 0, typename... Tp>
-	static typename std::enable_if<(I == sizeof...(Tp)), void>::type stepBehaviour(uint8_t /*index*/, bool /*suppress*/, std::tuple<Tp...>& /*t*/) {}
-
-	template<std::size_t I = 0, typename... Tp>
-	static typename std::enable_if<(I < sizeof...(Tp)), void>::type stepBehaviour(uint8_t index, bool suppress, std::tuple<Tp...>& t)
+	//! suppresses the previous behaviour if decide() chose another one and steps the chosen one
+	void act()
 	{
-		if (index == I)
+		if (currentBehaviour != nextBehaviour)
 		{
-			auto&& behaviour = std::get<I>(t);
-
-			behaviour.step(suppress);
-			return;
+			tracer.switched(currentBehaviour, nextBehaviour);
+			stepBehaviour(currentBehaviour, true);
+			currentBehaviour = nextBehaviour;
 		}
-
-		stepBehaviour<I + 1, Tp...>(index, suppress, t);
+		stepBehaviour(currentBehaviour, false);
 	}
 
-	void step()
+private:
+	//sentinel: index is uint8_t max, nobody is in control
+	template <std::size_t I = 0>
+	typename std::enable_if<(I == sizeof...(Behaviours))>::type stepBehaviour(uint8_t /*index*/, bool /*suppress*/)
 	{
-		uint8_t newIndex = std::numeric_limits<uint8_t>::max();
-		findBehaviourThatWantsToTakeContro([&](uint8_t index)
-		{
-			newIndex = index;
-		}, behaviours);
+	}
 
-		if (currentBehaviour == newIndex)
-		{
-			stepBehaviour(currentBehaviour, false, behaviours);
-		}
-		else if (currentBehaviour != newIndex)
+	//! direct calls which the compiler can inline, faster than a table of function pointers
+	template <std::size_t I = 0>
+	typename std::enable_if<(I < sizeof...(Behaviours))>::type stepBehaviour(uint8_t index, bool suppress)
+	{
+		if (index == I)
 		{
-			stepBehaviour(currentBehaviour, true, behaviours);
-			currentBehaviour = newIndex;
-			stepBehaviour(currentBehaviour, false, behaviours);
+			std::get<I>(behaviours).step(suppress);
+			tracer.stepped(index, suppress);
+			return;
 		}
+		stepBehaviour<I + 1>(index, suppress);
 	}
 
-private:
 	uint8_t currentBehaviour = 0;
+	uint8_t nextBehaviour = 0;
 	std::tuple<Behaviours...> behaviours;
+	Tracer tracer;
 };
 
+template <typename... Behaviours>
+using Arbitrator = TracedArbitrator<NoBehaviourTracer, Behaviours...>;
+
 template <typename... Behaviours>
 Arbitrator<Behaviours...> makeArbitrator(std::tuple<Behaviours...>&& behaviours)
 {
 	return Arbitrator<Behaviours...>(std::forward<std::tuple<Behaviours...>>(behaviours));
 }
 
+template <typename Tracer, typename... Behaviours>
+TracedArbitrator<Tracer, Behaviours...> makeTracedArbitrator(std::tuple<Behaviours...>&& behaviours, Tracer tracer = {})
+{
+	return TracedArbitrator<Tracer, Behaviours...>(std::forward<std::tuple<Behaviours...>>(behaviours), tracer);
+}
+
 #endif // BEHAVIOURMACHINE_H
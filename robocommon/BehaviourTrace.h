@@ -0,0 +1,164 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+#include <cstdint>
+
+#include "EventTraceBuffer.h"
+#include "IOStream.h"
+#include "LatencyHistogram.h"
+
+/**
+ * Snapshot of the inputs the behaviours decide on, the meaning of the bits and the value is up
+ * to the application (MainControl: see its InputFlag).
+ */
+struct BehaviourInputs
+{
+	uint8_t flags = 0;
+	uint16_t value = 0;
+};
+
+/**
+ * One switch of the Arbitrator. Encoded it takes EncodedSize bytes, little endian:
+ * timestamp (4 bytes), from, to, input flags, reserved, input value (2 bytes).
+ * from and to are uint8_t max for no behaviour.
+ */
+struct BehaviourTransitionRecord
+{
+	static constexpr size_t EncodedSize = 10;
+
+	uint32_t timestampUs;
+	uint8_t from;
+	uint8_t to;
+	BehaviourInputs inputs;
+
+	void encode(uint8_t* pData) const
+	{
+		pData[0] = static_cast<uint8_t>(timestampUs);
+		pData[1] = static_cast<uint8_t>(timestampUs >> 8);
+		pData[2] = static_cast<uint8_t>(timestampUs >> 16);
+		pData[3] = static_cast<uint8_t>(timestampUs >> 24);
+		pData[4] = from;
+		pData[5] = to;
+		pData[6] = inputs.flags;
+		pData[7] = 0;
+		pData[8] = static_cast<uint8_t>(inputs.value);
+		pData[9] = static_cast<uint8_t>(inputs.value >> 8);
+	}
+
+	static BehaviourTransitionRecord decode(const uint8_t* pData)
+	{
+		BehaviourTransitionRecord record;
+		record.timestampUs = static_cast<uint32_t>(pData[0])
+			| static_cast<uint32_t>(pData[1]) << 8
+			| static_cast<uint32_t>(pData[2]) << 16
+			| static_cast<uint32_t>(pData[3]) << 24;
+		record.from = pData[4];
+		record.to = pData[5];
+		record.inputs.flags = pData[6];
+		record.inputs.value = static_cast<uint16_t>(pData[8] | pData[9] << 8);
+		return record;
+	}
+};
+
+/**
+ * Keeps the last TraceCapacity switches of an Arbitrator and a sensor-to-actuation LatencyHistogram
+ * per behaviour. Clock::nowUs() gives the time, GlobalLockGuard protects the histograms.
+ *
+ * The application reports a stimulus when an input which needs a reaction was seen. The first
+ * time the actuators are commanded by a (not suppressed) step afterwards, the latency since the
+ * stimulus is added to the histogram of the behaviour which stepped. The actuators are counted
+ * by the application, stepped() gets the count after the step: a step which changed it commanded
+ * them.
+ */
+template <size_t NofBehaviours, size_t TraceCapacity, typename Clock, typename GlobalLockGuard>
+class BehaviourTrace
+{
+public:
+	//! a stimulus is kept until the actuators are commanded, later ones don't replace it
+	void stimulus(uint32_t timestampUs)
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		if (!isStimulusPending)
+		{
+			isStimulusPending = true;
+			stimulusUs = timestampUs;
+		}
+	}
+
+	void switched(uint8_t from, uint8_t to, const BehaviourInputs& inputs)
+	{
+		transitions.record(BehaviourTransitionRecord{Clock::nowUs(), from, to, inputs});
+	}
+
+	void stepped(uint8_t behaviour, bool suppressed, uint32_t nofActuations)
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		auto actuated = nofActuations != lastNofActuations;
+		lastNofActuations = nofActuations;
+		if (actuated && !suppressed && isStimulusPending && behaviour < NofBehaviours)
+		{
+			isStimulusPending = false;
+			latencies[behaviour].add(Clock::nowUs() - stimulusUs);
+		}
+	}
+
+	template <size_t N>
+	size_t copyTransitions(std::array<BehaviourTransitionRecord, N>& copy) const
+	{
+		return transitions.copy_to(copy);
+	}
+
+	LatencyHistogram getLatencies(uint8_t behaviour) const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		return latencies[behaviour];
+	}
+
+	void clear()
+	{
+		transitions.clear();
+		GlobalLockGuard lock;
+		(void)lock;
+		latencies = {};
+		isStimulusPending = false;
+	}
+
+private:
+	EventTraceBuffer<TraceCapacity, BehaviourTransitionRecord> transitions;
+	std::array<LatencyHistogram, NofBehaviours> latencies;
+	uint32_t stimulusUs = 0;
+	uint32_t lastNofActuations = 0;
+	bool isStimulusPending = false;
+};
+
+/**
+ * Writes the transitions like writeTrace() with the name "bhtrace", followed by a line
+ * "bhlatency <behaviour> <count> <max us> <bucket 0> ... <bucket n>" per behaviour which has latencies.
+ */
+template <size_t NofBehaviours>
+void writeBehaviourTrace(IOStream& out, const BehaviourTransitionRecord* pRecords, size_t count,
+	const std::array<LatencyHistogram, NofBehaviours>& latencies)
+{
+	writeTrace(out, "bhtrace", pRecords, count);
+	for (auto behaviour = size_t{0}; behaviour < NofBehaviours; ++behaviour)
+	{
+		const auto& histogram = latencies[behaviour];
+		if (histogram.count == 0)
+		{
+			continue;
+		}
+		out << "bhlatency " << static_cast<uint32_t>(behaviour) << " " << histogram.count << " " << histogram.maxUs;
+		for (auto bucket : histogram.buckets)
+		{
+			out << " " << bucket;
+		}
+		out.writeChar('\n');
+	}
+}
@@ -0,0 +1,32 @@
+/**
+ * The schema of the binary protocol, see BinaryProtocol.h, which generates the message structs,
+ * their ids and their (de)serialization from it. No include guard: it is included once per
+ * generated part, with BINARY_MESSAGE(Name, Id, Fields) and BINARY_FIELD(Type, name) defined.
+ *
+ * The fields are sent in their order, little endian. Ids only get added, never reused, the host
+ * tools depend on them.
+ */
+
+//host to robot
+BINARY_MESSAGE(Ping, 0x01,
+	BINARY_FIELD(uint32_t, sequence))
+BINARY_MESSAGE(LeaveBinaryMode, 0x02, )	//!< back to the text console
+BINARY_MESSAGE(SetSpeedPid, 0x10,
+	BINARY_FIELD(uint8_t, isLeft)
+	BINARY_FIELD(int32_t, pFactor100)
+	BINARY_FIELD(int32_t, iFactor100)
+	BINARY_FIELD(int32_t, dFactor100)
+	BINARY_FIELD(int32_t, iAntiWindup))
+BINARY_MESSAGE(StreamTacho, 0x11,	//!< sends TachoSpeeds every periodMs, 0 stops
+	BINARY_FIELD(uint16_t, periodMs))
+
+//robot to host
+BINARY_MESSAGE(Pong, 0x81,
+	BINARY_FIELD(uint32_t, sequence))
+BINARY_MESSAGE(Ack, 0x82,	//!< answers the messages which set something
+	BINARY_FIELD(uint8_t, messageId)
+	BINARY_FIELD(uint8_t, isOk))
+BINARY_MESSAGE(TachoSpeeds, 0x90,
+	BINARY_FIELD(uint32_t, timeMs)
+	BINARY_FIELD(int32_t, leftSpeed)
+	BINARY_FIELD(int32_t, rightSpeed))
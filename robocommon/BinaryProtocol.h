@@ -0,0 +1,381 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include "Cobs.h"
+#include "Crc16.h"
+#include "IOStream.h"
+#include "Optional.h"
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Binary protocol on the IOStream of the console, for what is too fast for text, e.g. streaming
+ * the tacho or setting gains at 100 Hz. A frame is
+ *
+ *   0x00, COBS(id, payload, CRC-16 of id and payload little endian), 0x00
+ *
+ * The text of the console never has a zero byte, so the leading one switches
+ * BinaryFramingIOStream to binary mode. The messages are generated from the schema in
+ * BinaryMessages.h.
+ */
+
+enum class MessageId : uint8_t
+{
+#define BINARY_FIELD(Type, name)
+#define BINARY_MESSAGE(Name, Id, Fields) Name = Id,
+#include "BinaryMessages.h"
+#undef BINARY_MESSAGE
+#undef BINARY_FIELD
+};
+
+constexpr size_t MaxPayloadSize = 32;
+constexpr size_t MaxFrameSize = 1 + MaxPayloadSize + 2;	//!< id, payload, CRC
+constexpr size_t MaxEncodedFrameSize = cobsMaxEncodedSize(MaxFrameSize);
+
+//! writes the fields of a message little endian
+class PayloadWriter
+{
+public:
+	explicit PayloadWriter(uint8_t* pData)
+		: pData(pData)
+	{
+	}
+
+	template <typename T>
+	void write(T value)
+	{
+		using Unsigned = typename std::make_unsigned<T>::type;
+		auto bits = static_cast<Unsigned>(value);
+		for (auto i = size_t{0}; i < sizeof(T); ++i)
+		{
+			pData[size++] = static_cast<uint8_t>(bits >> (8 * i));
+		}
+	}
+
+	size_t getSize() const
+	{
+		return size;
+	}
+
+private:
+	uint8_t* pData;
+	size_t size = 0;
+};
+
+//! reads what PayloadWriter wrote, the size of the payload has to be checked before
+class PayloadReader
+{
+public:
+	explicit PayloadReader(const uint8_t* pData)
+		: pData(pData)
+	{
+	}
+
+	template <typename T>
+	void read(T& value)
+	{
+		using Unsigned = typename std::make_unsigned<T>::type;
+		Unsigned bits = 0;
+		for (auto i = size_t{0}; i < sizeof(T); ++i)
+		{
+			bits = static_cast<Unsigned>(bits | (static_cast<Unsigned>(pData[pos++]) << (8 * i)));
+		}
+		value = static_cast<T>(bits);
+	}
+
+private:
+	const uint8_t* pData;
+	size_t pos = 0;
+};
+
+namespace binmsg
+{
+#define BINARY_FIELD(Type, name) Type name;
+#define BINARY_MESSAGE(Name, Id, Fields) \
+	struct Name \
+	{ \
+		static constexpr MessageId id() \
+		{ \
+			return MessageId::Name; \
+		} \
+		Fields \
+	};
+#include "BinaryMessages.h"
+#undef BINARY_MESSAGE
+#undef BINARY_FIELD
+
+#define BINARY_FIELD(Type, name) + sizeof(Type)
+#define BINARY_MESSAGE(Name, Id, Fields) \
+	constexpr size_t payloadSize(const Name* /*dummy*/) \
+	{ \
+		return 0 Fields; \
+	} \
+	static_assert(payloadSize(static_cast<const Name*>(nullptr)) <= MaxPayloadSize, #Name " is too large");
+#include "BinaryMessages.h"
+#undef BINARY_MESSAGE
+#undef BINARY_FIELD
+
+#define BINARY_FIELD(Type, name) writer.write(message.name);
+#define BINARY_MESSAGE(Name, Id, Fields) \
+	inline void writePayload(PayloadWriter& writer, const Name& message) \
+	{ \
+		(void)writer; \
+		(void)message; \
+		Fields \
+	}
+#include "BinaryMessages.h"
+#undef BINARY_MESSAGE
+#undef BINARY_FIELD
+
+#define BINARY_FIELD(Type, name) reader.read(message.name);
+#define BINARY_MESSAGE(Name, Id, Fields) \
+	inline void readPayload(PayloadReader& reader, Name& message) \
+	{ \
+		(void)reader; \
+		(void)message; \
+		Fields \
+	}
+#include "BinaryMessages.h"
+#undef BINARY_MESSAGE
+#undef BINARY_FIELD
+}
+
+template <typename Message>
+constexpr size_t payloadSizeOf()
+{
+	return binmsg::payloadSize(static_cast<const Message*>(nullptr));
+}
+
+//! a decoded frame, the payload is in the receive buffer
+struct BinaryFrame
+{
+	MessageId id;
+	const uint8_t* pPayload;
+	size_t payloadSize;
+};
+
+//! encodes message into pDst without the delimiters, pDst needs MaxEncodedFrameSize bytes
+template <typename Message>
+size_t encodeFrame(const Message& message, uint8_t* pDst)
+{
+	std::array<uint8_t, MaxFrameSize> frame;
+	frame[0] = static_cast<uint8_t>(Message::id());
+	PayloadWriter writer{&frame[1]};
+	writePayload(writer, message);
+	auto size = 1 + writer.getSize();
+	auto crc = crc16Ccitt(frame.data(), size);
+	frame[size++] = static_cast<uint8_t>(crc);
+	frame[size++] = static_cast<uint8_t>(crc >> 8);
+	return cobsEncode(frame.data(), size, pDst);
+}
+
+/**
+ * decodes a frame without its delimiters in place
+ * \return none if it is no valid COBS encoding or has a wrong CRC
+ */
+inline optional<BinaryFrame> decodeFrame(uint8_t* pData, size_t size)
+{
+	auto decodedSize = cobsDecode(pData, size, pData);
+	if (!decodedSize || *decodedSize < 3)
+	{
+		return {};
+	}
+	auto crcPos = *decodedSize - 2;
+	auto crc = crc16Ccitt(pData, crcPos);
+	if (pData[crcPos] != static_cast<uint8_t>(crc) || pData[crcPos + 1] != static_cast<uint8_t>(crc >> 8))
+	{
+		return {};
+	}
+	return BinaryFrame{static_cast<MessageId>(pData[0]), pData + 1, crcPos - 1};
+}
+
+//! \return false if the frame has another message or a payload of the wrong size
+template <typename Message>
+bool decodeMessage(const BinaryFrame& frame, Message& message)
+{
+	if (frame.id != Message::id() || frame.payloadSize != payloadSizeOf<Message>())
+	{
+		return false;
+	}
+	PayloadReader reader{frame.pPayload};
+	readPayload(reader, message);
+	return true;
+}
+
+/**
+ * calls handler.received(channel, message) with the message of the frame
+ * \return false if the frame has an unknown id or a payload of the wrong size
+ */
+template <typename Handler, typename Channel>
+bool dispatchFrame(const BinaryFrame& frame, Handler& handler, Channel& channel)
+{
+	switch (frame.id)
+	{
+#define BINARY_FIELD(Type, name)
+#define BINARY_MESSAGE(Name, Id, Fields) \
+	case MessageId::Name: \
+		{ \
+			binmsg::Name message{}; \
+			if (!decodeMessage(frame, message)) \
+			{ \
+				return false; \
+			} \
+			handler.received(channel, message); \
+			return true; \
+		}
+#include "BinaryMessages.h"
+#undef BINARY_MESSAGE
+#undef BINARY_FIELD
+	}
+	return false;
+}
+
+//! where the robot sends its messages to
+class BinaryChannel
+{
+public:
+	template <typename Message>
+	void send(const Message& message)
+	{
+		std::array<uint8_t, MaxEncodedFrameSize> encoded;
+		auto size = encodeFrame(message, encoded.data());
+		sendEncodedFrame(encoded.data(), size);
+	}
+
+	virtual bool isBinaryMode() const = 0;
+
+protected:
+	virtual void sendEncodedFrame(const uint8_t* pData, size_t size) = 0;
+};
+
+/**
+ * Passes the text of the console through and takes the binary frames out of the stream. A zero
+ * byte switches to binary mode, in which the frames go to handler.received(channel, message)
+ * and the text written to the stream is dropped. LeaveBinaryMode, a broken frame or one which
+ * is too long switch back to text, the latter as soon as it doesn't fit without waiting for its
+ * delimiter. It has to be below LineEndingNormalizerIOStream, which would
+ * change the bytes of the frames.
+ */
+template <typename TIOStream, typename Handler>
+class BinaryFramingIOStream final : public IOStream, public BinaryChannel
+{
+public:
+	BinaryFramingIOStream(TIOStream stream = TIOStream{}, Handler handler = Handler{})
+		: underlyingStream(std::move(stream))
+		, handler(std::move(handler))
+	{
+	}
+
+	//! \return the next character of the text, the frames before it are handled
+	optional<char> readChar() final override
+	{
+		for (;;)
+		{
+			auto c = underlyingStream.readChar();
+			if (!c)
+			{
+				return {};
+			}
+
+			if (!isInBinaryMode)
+			{
+				if (*c != '\0')
+				{
+					return c;
+				}
+				isInBinaryMode = true;
+				frameSize = 0;
+			}
+			else
+			{
+				receiveBinary(static_cast<uint8_t>(*c));
+			}
+		}
+	}
+
+	void writeChar(char c) final override
+	{
+		if (!isInBinaryMode)
+		{
+			underlyingStream.writeChar(c);
+		}
+	}
+
+	bool isBinaryMode() const override
+	{
+		return isInBinaryMode;
+	}
+
+	//! frames with a wrong CRC, encoding, size or id
+	uint32_t getNofBadFrames() const
+	{
+		return nofBadFrames;
+	}
+
+	Handler& getHandler()
+	{
+		return handler;
+	}
+
+protected:
+	void sendEncodedFrame(const uint8_t* pData, size_t size) override
+	{
+		underlyingStream.writeChar('\0');
+		for (auto i = size_t{0}; i < size; ++i)
+		{
+			underlyingStream.writeChar(static_cast<char>(pData[i]));
+		}
+		underlyingStream.writeChar('\0');
+	}
+
+private:
+	void receiveBinary(uint8_t byte)
+	{
+		if (byte != 0)
+		{
+			if (frameSize < frame.size())
+			{
+				frame[frameSize++] = byte;
+			}
+			else
+			{ //no frame, a stray zero byte in the text probably
+				++nofBadFrames;
+				isInBinaryMode = false;
+			}
+			return;
+		}
+
+		if (frameSize == 0)
+		{ //the delimiter in front of a frame
+			return;
+		}
+
+		auto decoded = decodeFrame(frame.data(), frameSize);
+		frameSize = 0;
+		if (!decoded)
+		{ //probably no binary at all
+			++nofBadFrames;
+			isInBinaryMode = false;
+		}
+		else if ((*decoded).id == MessageId::LeaveBinaryMode)
+		{
+			isInBinaryMode = false;
+		}
+		else if (!dispatchFrame(*decoded, handler, static_cast<BinaryChannel&>(*this)))
+		{
+			++nofBadFrames;
+		}
+	}
+
+	TIOStream underlyingStream;
+	Handler handler;
+	std::array<uint8_t, MaxEncodedFrameSize> frame;
+	size_t frameSize = 0;
+	bool isInBinaryMode = false;
+	uint32_t nofBadFrames = 0;
+};
@@ -4,8 +4,11 @@
 #error sorry, this header is c++ only
 #endif
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <limits>
+#include <utility>
 
 #include "Optional.h"
 #include "CommonTraits.h"
@@ -16,6 +19,72 @@ enum class CircularBufferFullStrategy
 	OverwriteOldest,
 };
 
+namespace detail
+{
+	constexpr bool isPowerOfTwo(size_t value)
+	{
+		return (value != 0) && ((value & (value - 1)) == 0);
+	}
+
+	//! number of bits to store value
+	constexpr size_t bitsFor(size_t value)
+	{
+		return (value == 0) ? 0 : 1 + bitsFor(value >> 1);
+	}
+
+	/**
+	 * Index arithmetic modulo Modulus without division (Cortex-M0+ has no hardware divider):
+	 * masks if Modulus is a power of two, a compare and subtract otherwise.
+	 * pos + count must be smaller than 2*Modulus for add(), count not bigger than pos + Modulus for subtract().
+	 */
+	template <size_t Modulus, bool IsPowerOfTwo = isPowerOfTwo(Modulus)>
+	struct WrapAround
+	{
+		static size_t add(size_t pos, size_t count)
+		{
+			auto newPos = pos + count;
+			return (newPos >= Modulus) ? newPos - Modulus : newPos;
+		}
+
+		static size_t subtract(size_t pos, size_t count)
+		{
+			return (pos >= count) ? pos - count : pos + Modulus - count;
+		}
+	};
+
+	template <size_t Modulus>
+	struct WrapAround<Modulus, true>
+	{
+		static size_t add(size_t pos, size_t count)
+		{
+			return (pos + count) & (Modulus - 1);
+		}
+
+		static size_t subtract(size_t pos, size_t count)
+		{
+			return (pos - count) & (Modulus - 1);
+		}
+	};
+}
+
+/**
+ * Up to two contiguous regions of a circular buffer. The second region is only used when
+ * the elements wrap around the end of the underlying array.
+ */
+template <typename T>
+struct CircularBufferSpans
+{
+	T* first;
+	size_t firstSize;
+	T* second;
+	size_t secondSize;
+
+	size_t size() const
+	{
+		return firstSize + secondSize;
+	}
+};
+
 class NoLockingStrategy
 {
 public:
@@ -25,6 +94,132 @@ public:
 	}
 };
 
+/**
+ * Locking strategy for a buffer with one writer and lock free readers (seqlock).
+ *
+ * Everything but CircularBuffer::copy_to_without_lock() is considered to be writing and has to
+ * be called from the writer side only (or be serialized by WriterLockingStrategy). Readers never
+ * block the writer, they retry their copy if the writer modified the buffer in the meantime.
+ * This only makes sense for plain data elements, which may be copied while being written.
+ */
+template <typename WriterLockingStrategy = NoLockingStrategy>
+class SeqLockingStrategy
+{
+public:
+	class WriteGuard
+	{
+	public:
+		explicit WriteGuard(SeqLockingStrategy* pStrategy)
+			: pStrategy(pStrategy)
+			, writerLock(pStrategy->writerLockingStrategy.lock())
+		{
+			//odd sequence: write in progress
+			pStrategy->sequence.store(pStrategy->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		WriteGuard(WriteGuard&& other)
+			: pStrategy(other.pStrategy)
+			, writerLock(std::move(other.writerLock))
+		{
+			other.pStrategy = nullptr;
+		}
+
+		~WriteGuard()
+		{
+			if (pStrategy != nullptr)
+			{
+				pStrategy->sequence.store(pStrategy->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			}
+		}
+
+		WriteGuard(const WriteGuard&) = delete;
+		WriteGuard& operator=(const WriteGuard&) = delete;
+
+	private:
+		SeqLockingStrategy* pStrategy;
+		decltype(std::declval<WriterLockingStrategy>().lock()) writerLock;
+	};
+
+	SeqLockingStrategy(WriterLockingStrategy writerLockingStrategy = {})
+		: writerLockingStrategy(std::move(writerLockingStrategy))
+	{
+	}
+
+	SeqLockingStrategy(const SeqLockingStrategy& other)
+		: writerLockingStrategy(other.writerLockingStrategy)
+	{
+	}
+
+	WriteGuard lock()
+	{
+		return WriteGuard{this};
+	}
+
+	//! waits until no write is in progress and returns the sequence to pass to endRead()
+	uint32_t beginRead() const
+	{
+		for (;;)
+		{
+			auto currSequence = sequence.load(std::memory_order_acquire);
+			if ((currSequence & 1) == 0)
+			{
+				return currSequence;
+			}
+		}
+	}
+
+	//! true if nothing has been written since beginRead()
+	bool endRead(uint32_t startSequence) const
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return sequence.load(std::memory_order_relaxed) == startSequence;
+	}
+
+private:
+	WriterLockingStrategy writerLockingStrategy;
+	std::atomic<uint32_t> sequence{0};
+};
+
+template <typename T, size_t MaxSize, CircularBufferFullStrategy FullStrategy, typename LockingStrategy>
+class CircularBuffer;
+
+/**
+ * Copy of the elements of a circular buffer at one point in time, oldest first.
+ */
+template <typename T, size_t MaxSize>
+class CircularBufferSnapshot
+{
+public:
+	const T* begin() const
+	{
+		return elements.data();
+	}
+
+	const T* end() const
+	{
+		return elements.data() + count;
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	const T& operator[](size_t index) const
+	{
+		ASSERT(index < count);
+		return elements[index];
+	}
+
+private:
+	template <typename, size_t, CircularBufferFullStrategy, typename>
+	friend class CircularBuffer;
+
+	std::array<T, MaxSize> elements;
+	size_t count = 0;
+};
+
 template <
 		typename T,
 		size_t MaxSize,
@@ -39,6 +234,10 @@ public:
 	using size_type = typename FindSmallestIntegerFor<MaxSize>::type;
 	using element_type = T;
 
+private:
+	using Wrap = detail::WrapAround<MaxSize>;
+
+public:
 	explicit CircularBuffer(LockingStrategy lockingStrategy = {})
 		: lockingStrategy(lockingStrategy)
 	{
@@ -88,6 +287,30 @@ public:
 		return impl_pop_front();
 	}
 
+	//! copy of the oldest element, without removing it
+	optional<T> front() const
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+		if (currSize == 0)
+		{
+			return { };
+		}
+		return data[popPos];
+	}
+
+	//! copy of the newest element, without removing it
+	optional<T> back() const
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+		if (currSize == 0)
+		{
+			return { };
+		}
+		return data[Wrap::add(popPos, currSize - 1)];
+	}
+
 	size_type size() const
 	{
 		auto lock = lockingStrategy.lock();
@@ -95,6 +318,141 @@ public:
 		return currSize;
 	}
 
+	/**
+	 * copies the newest min(N, size()) elements, oldest first, with a single lock
+	 * \return the amount of elements copied
+	 */
+	template <size_t N>
+	size_t copy_to(std::array<T, N>& elements) const
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+		return impl_copy_newest(elements.data(), N);
+	}
+
+	//! all elements, copied with a single lock
+	CircularBufferSnapshot<T, MaxSize> snapshot() const
+	{
+		CircularBufferSnapshot<T, MaxSize> snapshot;
+		snapshot.count = copy_to(snapshot.elements);
+		return snapshot;
+	}
+
+	/**
+	 * same as copy_to(), but without taking the lock. Only available with SeqLockingStrategy,
+	 * the copy is repeated until it was not disturbed by the writer.
+	 */
+	template <size_t N>
+	size_t copy_to_without_lock(std::array<T, N>& elements) const
+	{
+		for (;;)
+		{
+			auto sequence = lockingStrategy.beginRead();
+			auto count = impl_copy_newest(elements.data(), N);
+			if (lockingStrategy.endRead(sequence))
+			{
+				return count;
+			}
+		}
+	}
+
+	/**
+	 * pushes up to count elements with a single lock
+	 * \return the amount of elements pushed (less than count if elements are discarded)
+	 */
+	size_t push_n(const T* pElements, size_t count)
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+
+		auto toPush = count;
+		if (FullStrategy == CircularBufferFullStrategy::DiscardPushedElement)
+		{
+			toPush = std::min(count, MaxSize - currSize);
+		}
+		if (FullStrategy == CircularBufferFullStrategy::OverwriteOldest)
+		{
+			if (toPush > MaxSize)
+			{
+				//only the newest elements survive anyway
+				pElements += (toPush - MaxSize);
+				toPush = MaxSize;
+			}
+			auto toOverwrite = std::max(currSize + toPush, MaxSize) - MaxSize;
+			impl_consume(toOverwrite);
+		}
+
+		auto spans = impl_writable();
+		auto inFirst = std::min(toPush, spans.firstSize);
+		std::copy(pElements, pElements + inFirst, spans.first);
+		std::copy(pElements + inFirst, pElements + toPush, spans.second);
+		impl_commit(toPush);
+
+		return (FullStrategy == CircularBufferFullStrategy::OverwriteOldest) ? count : toPush;
+	}
+
+	/**
+	 * pops up to maxCount of the oldest elements with a single lock
+	 * \return the amount of elements popped
+	 */
+	size_t pop_n(T* pElements, size_t maxCount)
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+
+		auto spans = impl_readable();
+		auto toPop = std::min(maxCount, spans.size());
+		auto inFirst = std::min(toPop, spans.firstSize);
+		std::move(spans.first, spans.first + inFirst, pElements);
+		std::move(spans.second, spans.second + (toPop - inFirst), pElements + inFirst);
+		impl_consume(toPop);
+
+		return toPop;
+	}
+
+	/**
+	 * The regions holding the elements, oldest first. Use consume() to release them afterwards.
+	 *
+	 * The regions are accessed without lock, so only one consumer may use them, and pushing must not
+	 * overwrite them in the meantime (DiscardPushedElement, or a buffer that does not run full).
+	 */
+	CircularBufferSpans<const T> readable() const
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+		auto spans = const_cast<CircularBuffer*>(this)->impl_readable();
+		return {spans.first, spans.firstSize, spans.second, spans.secondSize};
+	}
+
+	//! removes count of the oldest elements
+	void consume(size_t count)
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+		ASSERT(count <= currSize);
+		impl_consume(count);
+	}
+
+	/**
+	 * The free regions, in push order. Fill them and make them visible with commit().
+	 * Only one producer may use them.
+	 */
+	CircularBufferSpans<T> writable()
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+		return impl_writable();
+	}
+
+	//! appends count elements that have been written into writable()
+	void commit(size_t count)
+	{
+		auto lock = lockingStrategy.lock();
+		(void)lock;
+		ASSERT(count <= MaxSize - currSize);
+		impl_commit(count);
+	}
+
 	template <typename TRet>
 	class Iterator : public std::iterator<std::forward_iterator_tag, TRet>
 	{
@@ -109,8 +467,8 @@ public:
 		{
 			auto lock = pBuffer->lockingStrategy.lock();
 			(void)lock;
-			ASSERT(currIndex < pBuffer->size());
-			return pBuffer->data[(pBuffer->popPos + currIndex) % MaxSize];
+			ASSERT(currIndex < pBuffer->currSize);
+			return pBuffer->data[Wrap::add(pBuffer->popPos, currIndex)];
 		}
 
 		Iterator& operator++()
@@ -160,23 +518,59 @@ private:
 		return element;
 	}
 
+	size_t impl_copy_newest(T* pElements, size_t maxCount) const
+	{
+		size_t size = currSize;
+		size_t pos = popPos;
+		auto count = std::min(maxCount, size);
+		pos = Wrap::add(pos, size - count); //skip the oldest ones
+		for (auto i = size_t{0}; i < count; ++i)
+		{
+			pElements[i] = data[pos];
+			pos = Wrap::add(pos, 1);
+		}
+		return count;
+	}
+
+	CircularBufferSpans<T> impl_readable()
+	{
+		auto inFirst = std::min<size_t>(currSize, MaxSize - popPos);
+		return {data.data() + popPos, inFirst, data.data(), currSize - inFirst};
+	}
+
+	CircularBufferSpans<T> impl_writable()
+	{
+		auto freeSpace = MaxSize - currSize;
+		auto inFirst = std::min<size_t>(freeSpace, MaxSize - pushPos);
+		return {data.data() + pushPos, inFirst, data.data(), freeSpace - inFirst};
+	}
+
+	void impl_consume(size_t count)
+	{
+		addAndWrapAround(popPos, count);
+		currSize -= count;
+	}
+
+	void impl_commit(size_t count)
+	{
+		addAndWrapAround(pushPos, count);
+		currSize += count;
+	}
+
 	void incrementAndWrapAround(size_type& pos)
 	{
-		pos += 1;
-		pos %= MaxSize;
+		pos = static_cast<size_type>(Wrap::add(pos, 1));
+	}
+
+	//! count must not be bigger than MaxSize
+	void addAndWrapAround(size_type& pos, size_t count)
+	{
+		pos = static_cast<size_type>(Wrap::add(pos, count));
 	}
 
 	void decrementAndWrapAround(size_type& pos)
 	{
-		if (pos > 0)
-		{
-			pos -= 1;
-			pos %= MaxSize;
-		}
-		else
-		{
-			pos = MaxSize - 1;
-		}
+		pos = static_cast<size_type>(Wrap::subtract(pos, 1));
 	}
 
 private:
@@ -185,5 +579,250 @@ private:
 	size_type currSize = 0;
 	size_type pushPos = 0;
 	size_type popPos = 0;
-	std::array<T, MaxSize> data{};
+	std::array<T, MaxSize> data;
+};
+
+/**
+ * Selects the lock free single producer/single consumer implementation of CircularBuffer.
+ *
+ * push_back() must only ever be called from one context (e.g. an ISR) and pop_front() only from one
+ * other context (e.g. a task). Producer and consumer never block each other: there is no shared size
+ * counter, each side only writes its own index.
+ */
+class SingleProducerSingleConsumer
+{
+};
+
+/**
+ * lock free single producer/single consumer circular buffer
+ *
+ * head is only written by the producer, tail only by the consumer (except for OverwriteOldest, where the
+ * producer advances tail with a compare and swap; the consumer then validates its read the same way).
+ * The positions of both indices run from 0 to 2*MaxSize-1, so a full and an empty buffer can be told
+ * apart without wasting a slot. With OverwriteOldest the bits above the position count the laps: the
+ * tail the consumer read before copying an element only comes back after 2^32 pushes, not after
+ * 2*MaxSize, so its compare and swap can't succeed on an overwritten element (ABA).
+ *
+ * With DiscardPushedElement only atomic loads and stores are used, which are lock free on every Cortex-M.
+ * OverwriteOldest needs compare and swap (not available natively on Cortex-M0+), and T must be safe to
+ * copy while the producer is overwriting it (plain data), as torn reads are detected and retried.
+ */
+template <
+		typename T,
+		size_t MaxSize,
+		CircularBufferFullStrategy FullStrategy
+		 >
+class CircularBuffer<T, MaxSize, FullStrategy, SingleProducerSingleConsumer>
+{
+public:
+	static_assert(MaxSize >= 1, "circular buffer must be at least one element big");
+
+	using size_type = typename FindSmallestIntegerFor<MaxSize>::type;
+	using element_type = T;
+
+	CircularBuffer() = default;
+
+	CircularBuffer(const CircularBuffer&) = delete;
+	CircularBuffer& operator=(const CircularBuffer&) = delete;
+
+	//! producer side
+	void push_back(T element)
+	{
+		auto currHead = head.load(std::memory_order_relaxed);
+		auto currTail = tail.load(std::memory_order_acquire);
+		while (distance(currTail, currHead) >= MaxSize)
+		{
+			if (FullStrategy == CircularBufferFullStrategy::DiscardPushedElement)
+			{
+				return; //discard
+			}
+			if (FullStrategy == CircularBufferFullStrategy::OverwriteOldest)
+			{
+				//take out oldest and discard it. if this fails, the consumer was faster and there is space now
+				if (tail.compare_exchange_weak(currTail, advance(currTail), std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					break;
+				}
+			}
+		}
+
+		data[slot(currHead)] = std::move(element);
+		head.store(advance(currHead), std::memory_order_release);
+	}
+
+	//! consumer side
+	optional<T> pop_front()
+	{
+		auto currTail = tail.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			auto currHead = head.load(std::memory_order_acquire);
+			if (currHead == currTail)
+			{
+				return { };
+			}
+
+			if (FullStrategy == CircularBufferFullStrategy::DiscardPushedElement)
+			{
+				auto element = std::move(data[slot(currTail)]);
+				tail.store(advance(currTail), std::memory_order_release);
+				return element;
+			}
+			else
+			{
+				auto element = data[slot(currTail)];
+				//the producer may have overwritten the element while we were copying it
+				if (tail.compare_exchange_strong(currTail, advance(currTail), std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					return element;
+				}
+			}
+		}
+	}
+
+	//! may be called from both sides, the result is a snapshot that may be outdated immediately
+	size_type size() const
+	{
+		auto currTail = tail.load(std::memory_order_acquire);
+		auto currHead = head.load(std::memory_order_acquire);
+		return static_cast<size_type>(std::min(distance(currTail, currHead), MaxSize));
+	}
+
+	//! producer side, see CircularBuffer::push_n()
+	size_t push_n(const T* pElements, size_t count)
+	{
+		if (FullStrategy == CircularBufferFullStrategy::OverwriteOldest)
+		{
+			for (auto i = size_t{0}; i < count; ++i)
+			{
+				push_back(pElements[i]);
+			}
+			return count;
+		}
+
+		auto spans = writable();
+		auto toPush = std::min(count, spans.size());
+		auto inFirst = std::min(toPush, spans.firstSize);
+		std::copy(pElements, pElements + inFirst, spans.first);
+		std::copy(pElements + inFirst, pElements + toPush, spans.second);
+		commit(toPush);
+		return toPush;
+	}
+
+	//! consumer side, see CircularBuffer::pop_n()
+	size_t pop_n(T* pElements, size_t maxCount)
+	{
+		return impl_pop_n(pElements, maxCount, std::integral_constant<bool, FullStrategy == CircularBufferFullStrategy::DiscardPushedElement>());
+	}
+
+	//! consumer side, the elements stay valid until they are consume()d
+	CircularBufferSpans<const T> readable() const
+	{
+		static_assert(FullStrategy == CircularBufferFullStrategy::DiscardPushedElement, "the producer could overwrite the returned regions");
+		auto currTail = tail.load(std::memory_order_relaxed);
+		auto currHead = head.load(std::memory_order_acquire);
+		auto used = distance(currTail, currHead);
+		auto start = slot(currTail);
+		auto inFirst = std::min(used, MaxSize - start);
+		return {data.data() + start, inFirst, data.data(), used - inFirst};
+	}
+
+	//! consumer side
+	void consume(size_t count)
+	{
+		static_assert(FullStrategy == CircularBufferFullStrategy::DiscardPushedElement, "the producer could overwrite the returned regions");
+		auto currTail = tail.load(std::memory_order_relaxed);
+		ASSERT(count <= distance(currTail, head.load(std::memory_order_acquire)));
+		tail.store(advance(currTail, count), std::memory_order_release);
+	}
+
+	//! producer side, the regions may be filled and then published with commit()
+	CircularBufferSpans<T> writable()
+	{
+		auto currHead = head.load(std::memory_order_relaxed);
+		auto currTail = tail.load(std::memory_order_acquire);
+		auto freeSpace = MaxSize - std::min(distance(currTail, currHead), MaxSize);
+		auto start = slot(currHead);
+		auto inFirst = std::min(freeSpace, MaxSize - start);
+		return {data.data() + start, inFirst, data.data(), freeSpace - inFirst};
+	}
+
+	//! producer side
+	void commit(size_t count)
+	{
+		auto currHead = head.load(std::memory_order_relaxed);
+		ASSERT(count <= MaxSize - distance(tail.load(std::memory_order_acquire), currHead));
+		head.store(advance(currHead, count), std::memory_order_release);
+	}
+
+private:
+	static constexpr bool HasLaps = (FullStrategy == CircularBufferFullStrategy::OverwriteOldest);
+	using index_type = typename std::conditional<HasLaps, uint32_t, typename FindSmallestIntegerFor<2 * MaxSize>::type>::type;
+
+	//! the index of one lap, the positions are below it
+	static constexpr index_type lap()
+	{
+		return static_cast<index_type>(HasLaps ? (uint32_t{1} << detail::bitsFor(2 * MaxSize - 1)) : 0);
+	}
+	static_assert(!HasLaps || detail::bitsFor(2 * MaxSize - 1) <= 24, "at least 8 bits are needed to count the laps");
+
+	static index_type position(index_type index)
+	{
+		return HasLaps ? static_cast<index_type>(index & (lap() - 1)) : index;
+	}
+
+	//! elements can not be overwritten by the producer, so they can be taken out directly
+	size_t impl_pop_n(T* pElements, size_t maxCount, std::true_type)
+	{
+		auto spans = readable();
+		auto toPop = std::min(maxCount, spans.size());
+		auto inFirst = std::min(toPop, spans.firstSize);
+		std::copy(spans.first, spans.first + inFirst, pElements);
+		std::copy(spans.second, spans.second + (toPop - inFirst), pElements + inFirst);
+		consume(toPop);
+		return toPop;
+	}
+
+	size_t impl_pop_n(T* pElements, size_t maxCount, std::false_type)
+	{
+		auto popped = size_t{0};
+		for (; popped < maxCount; ++popped)
+		{
+			auto element = pop_front();
+			if (!element)
+			{
+				break;
+			}
+			pElements[popped] = std::move(*element);
+		}
+		return popped;
+	}
+
+	//! count must not be bigger than MaxSize
+	static index_type advance(index_type index, size_t count = 1)
+	{
+		auto pos = position(index);
+		auto newPos = static_cast<index_type>(detail::WrapAround<2 * MaxSize>::add(pos, count));
+		if (!HasLaps)
+		{
+			return newPos;
+		}
+		auto laps = static_cast<index_type>(index - pos);
+		return static_cast<index_type>(((newPos < pos) ? laps + lap() : laps) | newPos);
+	}
+
+	static size_t distance(index_type from, index_type to)
+	{
+		return detail::WrapAround<2 * MaxSize>::subtract(position(to), position(from));
+	}
+
+	static size_t slot(index_type index)
+	{
+		return detail::WrapAround<MaxSize>::add(position(index), 0);
+	}
+
+private:
+	std::atomic<index_type> head{0};
+	std::atomic<index_type> tail{0};
+	std::array<T, MaxSize> data;
 };
@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include "Optional.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Consistent Overhead Byte Stuffing: the encoded data has no zero bytes, so a zero delimits
+ * the frames. It costs one byte per started 254 bytes.
+ */
+
+//! the most bytes cobsEncode() writes for size bytes, without the delimiter
+constexpr size_t cobsMaxEncodedSize(size_t size)
+{
+	return size + size / 254 + 1;
+}
+
+//! \return the encoded size, pDst needs cobsMaxEncodedSize(size) bytes
+inline size_t cobsEncode(const uint8_t* pSrc, size_t size, uint8_t* pDst)
+{
+	auto codeIndex = size_t{0};
+	auto dstIndex = size_t{1};
+	uint8_t code = 1;
+	for (auto i = size_t{0}; i < size; ++i)
+	{
+		if (pSrc[i] == 0)
+		{
+			pDst[codeIndex] = code;
+			codeIndex = dstIndex++;
+			code = 1;
+		}
+		else
+		{
+			pDst[dstIndex++] = pSrc[i];
+			++code;
+			if (code == 0xff && i + 1 < size)
+			{
+				pDst[codeIndex] = code;
+				codeIndex = dstIndex++;
+				code = 1;
+			}
+		}
+	}
+	pDst[codeIndex] = code;
+	return dstIndex;
+}
+
+/**
+ * decodes a frame without its delimiter, pDst may be pSrc
+ * \return the decoded size, none if the frame is no valid encoding
+ */
+inline optional<size_t> cobsDecode(const uint8_t* pSrc, size_t size, uint8_t* pDst)
+{
+	auto srcIndex = size_t{0};
+	auto dstIndex = size_t{0};
+	while (srcIndex < size)
+	{
+		auto code = pSrc[srcIndex++];
+		if (code == 0)
+		{
+			return {};
+		}
+		for (auto i = 1; i < code; ++i)
+		{
+			if (srcIndex >= size || pSrc[srcIndex] == 0)
+			{
+				return {};
+			}
+			pDst[dstIndex++] = pSrc[srcIndex++];
+		}
+		if (code != 0xff && srcIndex < size)
+		{
+			pDst[dstIndex++] = 0;
+		}
+	}
+	return dstIndex;
+}
@@ -4,10 +4,16 @@
 #error sorry, this header is c++ only
 #endif
 
+#include "CommonTraits.h"
+#include "EnumNames.h"
 #include "FixedSizeString.h"
+#include "FixedPoint.h"
 #include "NumberConversion.h"
 #include "IOStream.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <tuple>
 
 template <typename Fn, typename IOStream, typename... Params>
@@ -74,6 +80,50 @@ template <typename Fn>
 struct FirstParameterIsIOStream : public FirstParameterIsIOStreamImpl<Fn, function_traits<Fn>::AmountOfArguments>
 { };
 
+//! an entry of the command table of a parser, see CommandParser::getCommands()
+struct CommandInfo
+{
+	String<10> name;
+	const char* pHelp;	//!< nullptr if the command has no help text
+	void (*writeParamsSyntax)(IOStream& ioStream);	//!< writes " num str..." after the name, nullptr if unknown
+};
+
+//! the command table of a parser, without a copy of it
+class CommandInfos
+{
+public:
+	CommandInfos(const CommandInfo* pBegin, const CommandInfo* pEnd)
+		: pBegin(pBegin)
+		, pEnd(pEnd)
+	{
+	}
+
+	const CommandInfo* begin() const
+	{
+		return pBegin;
+	}
+
+	const CommandInfo* end() const
+	{
+		return pEnd;
+	}
+
+	size_t size() const
+	{
+		return pEnd - pBegin;
+	}
+
+	const CommandInfo& operator[](size_t index) const
+	{
+		ASSERT(index < size());
+		return pBegin[index];
+	}
+
+private:
+	const CommandInfo* pBegin;
+	const CommandInfo* pEnd;
+};
+
 namespace detail
 {
 	constexpr size_t MaxCommandLength = 80;
@@ -89,10 +139,11 @@ namespace detail
 	class Parameters
 	{
 	public:
-		static optional<Parameters> parseParameters(const String<MaxCommandLength>* pCmdToExecute)
+		//! the parameters are slices of cmdToExecute, it has to outlive them
+		static optional<Parameters> parseParameters(const StringSlice& cmdToExecute)
 		{
-			Parameters parameters{pCmdToExecute};
-			auto success = tryInitFromCmd(*pCmdToExecute, parameters.parameters);
+			Parameters parameters;
+			auto success = tryInitFromCmd(cmdToExecute, parameters.parameters);
 			if (success)
 			{
 				return parameters;
@@ -104,20 +155,17 @@ namespace detail
 		}
 
 		template <size_t Index>
-		String<MaxCommandLength> getParam() const
+		StringSlice getParam() const
 		{
-			return String<MaxCommandLength>{parameters[Index].first, parameters[Index].second};
+			return parameters[Index];
 		}
 
 	private:
-		using ArrayOfParameters = std::array<std::pair<String<MaxCommandLength>::const_iterator, String<MaxCommandLength>::const_iterator>, ExpectedAmountOfArguments>;
+		using ArrayOfParameters = std::array<StringSlice, ExpectedAmountOfArguments>;
 
-		explicit Parameters(const String<MaxCommandLength>* pCmdToExecute)
-			: pCmdToExecute(pCmdToExecute)
-		{
-		}
+		Parameters() = default;
 
-		static bool tryInitFromCmd(const String<MaxCommandLength>& cmdToExecute, ArrayOfParameters& parameters)
+		static bool tryInitFromCmd(const StringSlice& cmdToExecute, ArrayOfParameters& parameters)
 		{
 			enum State
 			{
@@ -215,7 +263,6 @@ namespace detail
 		}
 
 	private:
-		const String<MaxCommandLength>* pCmdToExecute;
 		ArrayOfParameters parameters;
 	};
 
@@ -226,30 +273,28 @@ namespace detail
 		static constexpr size_t Index = (traits::AmountOfArguments - ArgNo);
 		using ProcessedParamType = typename std::decay<typename std::tuple_element<Index, typename traits::arguments>::type>::type;
 
+		//! the parsed parameters are passed down by reference, they live in the frames of the callers
 		template <typename... Args>
-		static bool executeImpl(const Fn& fn, const String<MaxCommandLength>& cmdToExecute, const detail::Parameters<traits::AmountOfArguments>& parameters, Args... args)
+		static bool executeImpl(const Fn& fn, const detail::Parameters<traits::AmountOfArguments>& parameters, Args&... args)
 		{
-			auto param = parameters.template getParam<Index>();
-
 			ProcessedParamType parsedParam;
-			bool parseOk = parseParam(param, parsedParam);
+			bool parseOk = parseParam(parameters.template getParam<Index>(), parsedParam);
 			if (!parseOk)
 			{
 				return false;
 			}
-			return Executor<Fn, ArgNo-1>::executeImpl(fn, cmdToExecute, parameters, args..., std::move(parsedParam));
+			return Executor<Fn, ArgNo-1>::executeImpl(fn, parameters, args..., parsedParam);
 		}
 
-		template <size_t MaxSize>
-		static void appendParams(String<MaxSize>& value)
+		static void writeParams(IOStream& ioStream)
 		{
-			value.append(" ");
-			appendParamTypeName(value, static_cast<ProcessedParamType*>(nullptr));
-			return Executor<Fn, ArgNo-1>::appendParams(value);
+			ioStream.write(" ");
+			writeParamTypeName(ioStream, static_cast<ProcessedParamType*>(nullptr));
+			Executor<Fn, ArgNo-1>::writeParams(ioStream);
 		}
 
-		template <typename ParamStringType, typename T>
-		static auto parseParam(const ParamStringType& param, T& value) -> typename std::enable_if<std::is_integral<T>::value, bool>::type
+		template <typename T>
+		static auto parseParam(const StringSlice& param, T& value) -> typename std::enable_if<std::is_integral<T>::value, bool>::type
 		{
 			auto result = stringToNumber<T>(param);
 			if (!result)
@@ -260,15 +305,55 @@ namespace detail
 			return true;
 		}
 
-		template <typename ParamStringType, size_t MaxSize>
-		static bool parseParam(const ParamStringType& param, String<MaxSize>& value)
+		template <size_t MaxSize>
+		static bool parseParam(const StringSlice& param, String<MaxSize>& value)
 		{
 			if (param.size() > MaxSize)
 			{
 				return false;
 			}
 
-			value = String<MaxSize>{param.begin(), std::min(MaxSize, param.size())};
+			value.erase();
+			for (auto c : param)
+			{
+				value.append(c);
+			}
+			return true;
+		}
+
+		template <typename T>
+		static auto parseParam(const StringSlice& param, T& value) -> typename std::enable_if<std::is_enum<T>::value, bool>::type
+		{
+			auto result = stringToEnum<T>(param);
+			if (!result)
+			{
+				return false;
+			}
+			value = *result;
+			return true;
+		}
+
+		template <typename T, unsigned Decimals>
+		static bool parseParam(const StringSlice& param, Decimal<T, Decimals>& value)
+		{
+			auto result = stringToDecimal<T, Decimals>(param);
+			if (!result)
+			{
+				return false;
+			}
+			value = *result;
+			return true;
+		}
+
+		template <typename T, unsigned FractionalBits>
+		static bool parseParam(const StringSlice& param, Fixed<T, FractionalBits>& value)
+		{
+			auto result = stringToFixed<T, FractionalBits>(param);
+			if (!result)
+			{
+				return false;
+			}
+			value = *result;
 			return true;
 		}
 
@@ -279,16 +364,48 @@ namespace detail
 		}
 
 
-		template <typename T, size_t MaxSize>
-		static auto appendParamTypeName(String<MaxSize>& value, T* /*dummy*/) -> typename std::enable_if<std::is_integral<T>::value, void>::type
+		template <typename T>
+		static auto writeParamTypeName(IOStream& ioStream, T* /*dummy*/) -> typename std::enable_if<std::is_integral<T>::value, void>::type
 		{
-			value.append("num");
+			ioStream.write("num");
 		}
 
-		template <size_t MaxSizeValue, size_t MaxSizeDummy>
-		static void appendParamTypeName(String<MaxSizeValue>& value, String<MaxSizeDummy>* /*dummy*/)
+		template <size_t MaxSizeDummy>
+		static void writeParamTypeName(IOStream& ioStream, String<MaxSizeDummy>* /*dummy*/)
 		{
-			value.append("str");
+			ioStream.write("str");
+		}
+
+		//! the names, "on|off"
+		template <typename T>
+		static auto writeParamTypeName(IOStream& ioStream, T* /*dummy*/) -> typename std::enable_if<std::is_enum<T>::value, void>::type
+		{
+			auto separator = "";
+			for (const auto& entry : EnumNames<T>::names())
+			{
+				ioStream.write(separator);
+				ioStream.write(entry.pName);
+				separator = "|";
+			}
+		}
+
+		//! a digit per decimal, "num.nn"
+		template <typename T, unsigned Decimals>
+		static void writeParamTypeName(IOStream& ioStream, Decimal<T, Decimals>* /*dummy*/)
+		{
+			ioStream.write(Decimals > 0 ? "num." : "num");
+			for (auto i = 0u; i < Decimals; ++i)
+			{
+				ioStream.write('n');
+			}
+		}
+
+		//! the Q format, "q15.16"
+		template <typename T, unsigned FractionalBits>
+		static void writeParamTypeName(IOStream& ioStream, Fixed<T, FractionalBits>* /*dummy*/)
+		{
+			constexpr auto IntegralBits = sizeof(T) * CHAR_BIT - FractionalBits - (std::is_signed<T>::value ? 1 : 0);
+			ioStream << "q" << static_cast<uint16_t>(IntegralBits) << "." << static_cast<uint16_t>(FractionalBits);
 		}
 	};
 
@@ -298,49 +415,124 @@ namespace detail
 		using traits = function_traits<Fn>;
 
 		template <typename... Args>
-		static bool executeImpl(const Fn& fn, const String<MaxCommandLength>& /*cmdToExecute*/, const detail::Parameters<traits::AmountOfArguments>& /*parameters*/, Args... args)
+		static bool executeImpl(const Fn& fn, const detail::Parameters<traits::AmountOfArguments>& /*parameters*/, Args&... args)
 		{
 			fn(args...);
 			return true;
 		}
 
-		template <size_t MaxSize>
-		static void appendParams(String<MaxSize>& /*value*/)
+		static void writeParams(IOStream& /*ioStream*/)
 		{
 		}
 	};
 
-	template <size_t Count>
-	struct HandleCommandRecursive
+	//! length of the first word of a command line, which names the command
+	inline size_t commandWordLength(const char* pCommand, size_t size)
+	{
+		return std::find(pCommand, pCommand + size, ' ') - pCommand;
+	}
+
+	//! FNV-1a
+	inline uint32_t hashCommandWord(const char* pWord, size_t length)
 	{
-		template <typename... Commands>
-		static void doHandleCommand(IOStream& ioStream, const String<MaxCommandLength>& cmdToExecute, const std::tuple<Commands...>& commands)
+		uint32_t hash = 2166136261u;
+		for (auto i = size_t{0}; i < length; ++i)
 		{
-			auto command = std::get<std::tuple_size<std::tuple<Commands...>>::value - Count>(commands);
+			hash ^= static_cast<uint8_t>(pWord[i]);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
 
-			auto result = command.executeIfMatching(ioStream, cmdToExecute);
-			if (!result)
+	//! smallest power of two with at least twice as many slots as commands
+	constexpr size_t commandTableSize(size_t nofCommands, size_t size = 1)
+	{
+		return (size >= 2 * nofCommands) ? size : commandTableSize(nofCommands, 2 * size);
+	}
+
+	constexpr uint8_t EmptyCommandSlot = 0xff;
+
+	/**
+	 * Finds the commands by the first word of a command line in O(length of the word): a hash
+	 * table with linear probing over the first words of the command names. Commands which
+	 * share a first word lie along the same probe sequence in the order they were added.
+	 */
+	template <size_t NofCommands>
+	class CommandIndex
+	{
+	public:
+		using Table = std::array<CommandInfo, NofCommands>;
+
+		explicit CommandIndex(const Table& table)
+			: table(table)
+		{
+			static_assert(NofCommands < EmptyCommandSlot, "too many commands for the index");
+			slots.fill(EmptyCommandSlot);
+			for (auto index = size_t{0}; index < NofCommands; ++index)
 			{
-				HandleCommandRecursive<Count - 1>::doHandleCommand(ioStream, cmdToExecute, commands);
+				const auto& name = table[index].name;
+				auto slot = firstSlot(name.begin(), commandWordLength(name.begin(), name.size()));
+				while (slots[slot] != EmptyCommandSlot)
+				{
+					slot = (slot + 1) % TableSize;
+				}
+				slots[slot] = static_cast<uint8_t>(index);
 			}
 		}
-	};
 
-	template <>
-	struct HandleCommandRecursive<0>
-	{
-		//terminating case
-		template <typename... Commands>
-		static void doHandleCommand(IOStream& ioStream, const String<MaxCommandLength>& cmdToExecute, const std::tuple<Commands...>& /*commands*/)
+		const Table& getTable() const
 		{
-			ioStream << cmdToExecute << " not found";
+			return table;
 		}
+
+		/**
+		 * calls fn(index) for the commands named like the first word of the command line in the
+		 * order they were added, until it returns true
+		 * \return true if fn returned true
+		 */
+		template <typename Fn>
+		bool forEachCandidate(const char* pCommand, size_t size, Fn fn) const
+		{
+			auto length = commandWordLength(pCommand, size);
+			for (auto slot = firstSlot(pCommand, length); slots[slot] != EmptyCommandSlot; slot = (slot + 1) % TableSize)
+			{
+				if (isNamed(slots[slot], pCommand, length) && fn(slots[slot]))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//! true if forEachCandidate() calls fn(index) for the command line
+		bool isCandidate(size_t index, const char* pCommand, size_t size) const
+		{
+			return isNamed(index, pCommand, commandWordLength(pCommand, size));
+		}
+
+	private:
+		static constexpr size_t TableSize = commandTableSize(NofCommands);
+
+		static size_t firstSlot(const char* pWord, size_t length)
+		{
+			return hashCommandWord(pWord, length) % TableSize;
+		}
+
+		bool isNamed(size_t index, const char* pWord, size_t length) const
+		{
+			const auto& name = table[index].name;
+			return commandWordLength(name.begin(), name.size()) == length
+				&& std::equal(pWord, pWord + length, name.begin());
+		}
+
+		Table table;
+		std::array<uint8_t, TableSize> slots;
 	};
 
-	template <typename... Commands>
-	void handleCommandRecursive(IOStream& ioStream, const String<MaxCommandLength>& cmdToExecute, const std::tuple<Commands...>& commands)
+	template <size_t Index, typename Tuple>
+	bool executeCommandAt(Tuple& commands, IOStream& ioStream, const String<MaxCommandLength>& cmdToExecute)
 	{
-		HandleCommandRecursive<std::tuple_size<std::tuple<Commands...>>::value>::doHandleCommand(ioStream, cmdToExecute, commands);
+		return std::get<Index>(commands).executeIfMatching(ioStream, cmdToExecute);
 	}
 }
 
@@ -348,79 +540,140 @@ class CommandParser
 {
 public:
 	virtual void executeCommand(IOStream& ioStream, const String<detail::MaxCommandLength>& command) = 0;
-	virtual void getAvailableCommands(String<10> list[], size_t maxElements) = 0;
-};
-
-namespace detail
-{
 
-template <typename... Commands>
-using AvailableCommands = std::array<String<10>, std::tuple_size<std::tuple<Commands...>>::value>;
+	//! the table of the commands in their order, it is built once and lives as long as the parser
+	virtual CommandInfos getCommands() const = 0;
 
-template <size_t no>
-struct AddCommandImpl
-{
-	template <typename... Commands>
-	static void addCommand(std::tuple<Commands...> commands, AvailableCommands<Commands...>& cmds)
+	/**
+	 * the characters which all command names starting with prefix have in common after it, e.g.
+	 * "stat" for "mot" with the commands "motstat" and "motstop"
+	 * \return a slice of the command table, empty if no name starts with prefix
+	 */
+	StringSlice completeCommand(const StringSlice& prefix) const
 	{
-		constexpr auto Index = std::tuple_size<std::tuple<Commands...>>::value - no;
-		cmds[Index] = std::get<Index>(commands).getCmd();
-		AddCommandImpl<no - 1>::addCommand(commands, cmds);
+		const String<10>* pFirstName = nullptr;
+		auto commonSize = size_t{0};
+		for (const auto& command : getCommands())
+		{
+			const auto& name = command.name;
+			if (name.size() < prefix.size() || !std::equal(prefix.begin(), prefix.end(), name.begin()))
+			{
+				continue;
+			}
+			if (pFirstName == nullptr)
+			{
+				pFirstName = &name;
+				commonSize = name.size();
+			}
+			else
+			{
+				commonSize = std::min(commonSize, name.size());
+				commonSize = std::mismatch(name.begin(), name.begin() + commonSize, pFirstName->begin()).first - name.begin();
+			}
+		}
+		if (pFirstName == nullptr)
+		{
+			return {};
+		}
+		return StringSlice{pFirstName->begin() + prefix.size(), pFirstName->begin() + commonSize};
 	}
 };
 
-template <>
-struct AddCommandImpl<0>
+//! writes "name syntax<tab>help" and a new line
+inline void writeCommandHelp(IOStream& ioStream, const CommandInfo& command)
 {
-	template <typename... Commands>
-	static void addCommand(std::tuple<Commands...> /*commands*/, AvailableCommands<Commands...>& /*cmds*/)
+	ioStream.write(command.name);
+	if (command.writeParamsSyntax != nullptr)
 	{
+		command.writeParamsSyntax(ioStream);
 	}
-};
-
+	if (command.pHelp != nullptr)
+	{
+		ioStream.write("\t");
+		ioStream.write(command.pHelp);
+	}
+	ioStream.write("\n");
 }
 
+/**
+ * Dispatches a command line to the command named like its first word through a CommandIndex.
+ * Commands whose MatchesOnlyItsName is false (the legacy ones, which also handle e.g. "status")
+ * get the lines no command is named like, in their order.
+ */
 template <typename... Commands>
 class ConcreteCommandParser : public CommandParser
 {
 public:
 	explicit ConcreteCommandParser(std::tuple<Commands...> commands)
 		: commands(std::move(commands))
+		, index(collectInfos(this->commands, MakeIndexSequence<sizeof...(Commands)>{}))
 	{
 	}
 
 	void executeCommand(IOStream& ioStream, const String<detail::MaxCommandLength>& command) override
 	{
-		detail::handleCommandRecursive(ioStream, command, commands);
+		auto found = index.forEachCandidate(command.begin(), command.size(), [&](size_t commandIndex)
+		{
+			return execute(commandIndex, ioStream, command);
+		});
+		if (found)
+		{
+			return;
+		}
+
+		for (auto commandIndex = size_t{0}; commandIndex < sizeof...(Commands); ++commandIndex)
+		{
+			if (!matchesOnlyItsName(commandIndex) && !index.isCandidate(commandIndex, command.begin(), command.size())
+				&& execute(commandIndex, ioStream, command))
+			{
+				return;
+			}
+		}
+		ioStream << command << " not found";
 	}
 
-	detail::AvailableCommands<Commands...> getAvailableCommands()
+	CommandInfos getCommands() const override
 	{
-		detail::AvailableCommands<Commands...> availableCommands;
+		const auto& table = index.getTable();
+		return CommandInfos{table.data(), table.data() + table.size()};
+	}
 
-		detail::AddCommandImpl<std::tuple_size<std::tuple<Commands...>>::value>::addCommand(commands, availableCommands);
+private:
+	using CommandTable = typename detail::CommandIndex<sizeof...(Commands)>::Table;
 
-		return availableCommands;
+	template <std::size_t... Indices>
+	static CommandTable collectInfos(const std::tuple<Commands...>& commands, IndexSequence<Indices...>)
+	{
+		return CommandTable{{ std::get<Indices>(commands).getInfo()... }};
 	}
 
-	void getAvailableCommands(String<10> cmds[], size_t maxElements) override
+	static bool matchesOnlyItsName(size_t commandIndex)
 	{
-		auto availableCommands = getAvailableCommands();
-		ASSERT(availableCommands.size() <= maxElements);
-		for (auto i = size_t{0}; i < availableCommands.size(); ++i)
-		{
-			cmds[i] = availableCommands[i];
-		}
+		static constexpr bool onlyNames[] = { Commands::MatchesOnlyItsName... };
+		return onlyNames[commandIndex];
+	}
+
+	bool execute(size_t commandIndex, IOStream& ioStream, const String<detail::MaxCommandLength>& command)
+	{
+		return execute(commandIndex, ioStream, command, MakeIndexSequence<sizeof...(Commands)>{});
+	}
+
+	template <std::size_t... Indices>
+	bool execute(size_t commandIndex, IOStream& ioStream, const String<detail::MaxCommandLength>& command, IndexSequence<Indices...>)
+	{
+		using ExecuteFn = bool (*)(std::tuple<Commands...>&, IOStream&, const String<detail::MaxCommandLength>&);
+		static constexpr ExecuteFn executes[] = { &detail::executeCommandAt<Indices, std::tuple<Commands...>>... };
+		return executes[commandIndex](commands, ioStream, command);
 	}
 
-private:
 	std::tuple<Commands...> commands;
+	detail::CommandIndex<sizeof...(Commands)> index;
 };
 
 template <typename... Commands>
 ConcreteCommandParser<Commands...> makeParser(Commands... commands)
 {
-	return ConcreteCommandParser<Commands...>(std::make_tuple(commands...));
+	return ConcreteCommandParser<Commands...>(std::make_tuple(std::move(commands)...));
 }
 
 class CommandExecutorLineSink
@@ -440,3 +693,26 @@ public:
 private:
 	CommandParser* pCommandParser;
 };
+
+//! completes the name of a command, see LineInputStrategy
+class CommandNameCompleter
+{
+public:
+	explicit CommandNameCompleter(const CommandParser* pCommandParser)
+		: pCommandParser(pCommandParser)
+	{
+	}
+
+	template <size_t MaxLineLength>
+	StringSlice complete(const String<MaxLineLength>& line) const
+	{
+		if (std::find(line.begin(), line.end(), ' ') != line.end())
+		{ //only the name
+			return {};
+		}
+		return pCommandParser->completeCommand(line);
+	}
+
+private:
+	const CommandParser* pCommandParser;
+};
@@ -4,6 +4,8 @@
 #error sorry, this header is c++ only
 #endif
 
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 
 namespace detail
@@ -36,3 +38,29 @@ static_assert(std::is_same<typename FindSmallestIntegerFor<255>::type, uint8_t>:
 static_assert(std::is_same<typename FindSmallestIntegerFor<256>::type, uint16_t>::value, "something is wrong in detail::findSmallestIntegerFor");
 static_assert(std::is_same<typename FindSmallestIntegerFor<65535>::type, uint16_t>::value, "something is wrong in detail::findSmallestIntegerFor");
 static_assert(std::is_same<typename FindSmallestIntegerFor<65536>::type, uint32_t>::value, "something is wrong in detail::findSmallestIntegerFor");
+
+/**
+ * Compile time list of indices, e.g. to expand a tuple into an array (like C++14 std::index_sequence)
+ */
+template <size_t... Indices>
+struct IndexSequence
+{
+};
+
+namespace detail
+{
+	template <size_t Count, size_t... Indices>
+	struct MakeIndexSequence : MakeIndexSequence<Count - 1, Count - 1, Indices...>
+	{
+	};
+
+	template <size_t... Indices>
+	struct MakeIndexSequence<0, Indices...>
+	{
+		using type = IndexSequence<Indices...>;
+	};
+}
+
+//! IndexSequence<0, 1, ..., Count - 1>
+template <size_t Count>
+using MakeIndexSequence = typename detail::MakeIndexSequence<Count>::type;
@@ -0,0 +1,23 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+//! CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xffff), a nibble at a time
+inline uint16_t crc16Ccitt(const uint8_t* pData, size_t size, uint16_t crc = 0xffff)
+{
+	static const uint16_t nibbleTable[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+		0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+	};
+	for (auto i = size_t{0}; i < size; ++i)
+	{
+		crc = static_cast<uint16_t>((crc << 4) ^ nibbleTable[(crc >> 12) ^ (pData[i] >> 4)]);
+		crc = static_cast<uint16_t>((crc << 4) ^ nibbleTable[(crc >> 12) ^ (pData[i] & 0x0f)]);
+	}
+	return crc;
+}
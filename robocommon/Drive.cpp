@@ -22,6 +22,7 @@ extern "C"{
 
 static volatile bool DRV_SpeedOn = FALSE;
 static int32_t DRV_SpeedLeft, DRV_SpeedRight;
+static volatile uint32_t DRV_NofSpeedCommands = 0;
 static CircularBuffer<SpeedState, HistorySize, CircularBufferFullStrategy::OverwriteOldest> lastSpeeds;
 
 void DRV_EnableDisable(bool enable) {
@@ -32,11 +33,16 @@ void DRV_SetSpeed(int32_t left, int32_t right) {
   lastSpeeds.push_back(SpeedState{left, right});
   DRV_SpeedLeft = left;
   DRV_SpeedRight = right;
+  DRV_NofSpeedCommands++;
+}
+
+uint32_t DRV_GetNofSpeedCommands(void) {
+  return DRV_NofSpeedCommands;
 }
 
 std::array<SpeedState, HistorySize> DRV_GetLastSpeeds() {
-	std::array<SpeedState, HistorySize> states;
-	std::copy(lastSpeeds.begin(), lastSpeeds.end(), states.begin());
+	std::array<SpeedState, HistorySize> states{};
+	lastSpeeds.copy_to(states);
 	return states;
 }
 
@@ -85,63 +91,40 @@ static portTASK_FUNCTION(DriveTask, pvParameters) {
 }
 
 #if PL_HAS_SHELL
-static void DRV_PrintStatus(const CLS1_StdIOType *io) {
-  uint8_t buf[32];
-  
-  CLS1_SendStatusStr((unsigned char*)"drive", (unsigned char*)"\r\n", io->stdOut);
-  CLS1_SendStatusStr((unsigned char*)"  speed", DRV_SpeedOn?(unsigned char*)"on\r\n":(unsigned char*)"off\r\n", io->stdOut);
-  buf[0]='\0';
-  UTIL1_strcatNum32s(buf, sizeof(buf), DRV_SpeedLeft);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"\r\n");
-  CLS1_SendStatusStr((unsigned char*)"  speed L ", buf, io->stdOut);
-  buf[0]='\0';
-  UTIL1_strcatNum32s(buf, sizeof(buf), DRV_SpeedRight);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"\r\n");
-  CLS1_SendStatusStr((unsigned char*)"  speed R ", buf, io->stdOut);
+void DRV_CmdStatus(IOStream& ioStream) {
+  ioStream << "drive\n";
+  ioStream << " speed " << (DRV_SpeedOn ? "on" : "off") << "\n";
+  ioStream << " speed L " << DRV_SpeedLeft << "\n";
+  ioStream << " speed R " << DRV_SpeedRight << "\n";
 }
 
 static void DRV_PrintHelp(const CLS1_StdIOType *io) {
-  CLS1_SendHelpStr((unsigned char*)"drive", (unsigned char*)"Group of drive commands\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  help|status", (unsigned char*)"Shows help or status\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  speed (on|off)", (unsigned char*)"Turns speed pid on or ff\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  speed (L|R) <value>", (unsigned char*)"Sets speed value\r\n", io->stdOut);
+  CLS1_SendHelpStr((unsigned char*)"drive", (unsigned char*)"Group of drive commands, set with drvctrl and drvspeed\r\n", io->stdOut);
+  CLS1_SendHelpStr((unsigned char*)"  help|status", (unsigned char*)"Shows drive help or status\r\n", io->stdOut);
 }
 
 uint8_t DRV_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io) {
-  uint8_t res = ERR_OK;
-  const uint8_t *p;
-  int32_t val32;
-
   if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_HELP)==0 || UTIL1_strcmp((char*)cmd, (char*)"drive help")==0) {
     DRV_PrintHelp(io);
     *handled = TRUE;
   } else if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_STATUS)==0 || UTIL1_strcmp((char*)cmd, (char*)"drive status")==0) {
-    DRV_PrintStatus(io);
-    *handled = TRUE;
-  } else if (UTIL1_strncmp((char*)cmd, (char*)"drive speed L", sizeof("drive speed L")-1)==0) {
-    p = cmd+sizeof("drive speed L");
-    if (UTIL1_ScanDecimal32sNumber(&p, &val32)==ERR_OK) {
-      DRV_SpeedLeft = val32;
-      *handled = TRUE;
-    } else {
-      res = ERR_FAILED;
-    }
-  } else if (UTIL1_strncmp((char*)cmd, (char*)"drive speed R", sizeof("drive speed R")-1)==0) {
-    p = cmd+sizeof("drive speed R");
-    if (UTIL1_ScanDecimal32sNumber(&p, &val32)==ERR_OK) {
-      DRV_SpeedRight = val32;
-      *handled = TRUE;
-    } else {
-      res = ERR_FAILED;
-    }
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"drive speed on")==0) {
-    DRV_EnableDisable(TRUE);
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"drive speed off")==0) {
-    DRV_EnableDisable(FALSE);
+    LegacyIOStream ioStream(io->stdOut);
+    DRV_CmdStatus(ioStream);
     *handled = TRUE;
   }
-  return res;
+  return ERR_OK;
+}
+
+void DRV_CmdSpeedControl(OnOff onOff) {
+  DRV_EnableDisable(onOff == OnOff::On);
+}
+
+void DRV_CmdSpeed(Side side, int32_t speed) {
+  if (side == Side::Left) {
+    DRV_SpeedLeft = speed;
+  } else {
+    DRV_SpeedRight = speed;
+  }
 }
 #endif /* PL_HAS_SHELL */
 
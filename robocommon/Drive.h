@@ -13,15 +13,26 @@
 #if PL_HAS_DRIVE
 
 #if PL_HAS_SHELL
-//#include "CLS1.h"
 #include "LegacyArgsCommand.h"
+#include <IOStream.h>
+#include <EnumNames.h>
+
 /*!
- * \brief Shell command line parser.
+ * \brief Shell command line parser, only for help and status, the commands are typed ones.
  * \param[in] cmd Pointer to command string
  * \param[out] handled If command is handled by the parser
  * \param[in] io Std I/O handler of shell
  */
 uint8_t DRV_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io);
+
+/*! \brief Writes whether the speed control is on and the speeds */
+void DRV_CmdStatus(IOStream& ioStream);
+
+/*! \brief Turns the speed control on or off */
+void DRV_CmdSpeedControl(OnOff onOff);
+
+/*! \brief Sets the speed of a motor, e.g. "drvspeed L 1000" */
+void DRV_CmdSpeed(Side side, int32_t speed);
 #endif
 
 /*!
@@ -37,6 +48,11 @@ void DRV_EnableDisable(bool enable);
  */
 void DRV_SetSpeed(int32_t left, int32_t right);
 
+/*!
+ * \brief Number of DRV_SetSpeed() calls since startup, a change tells that a speed was commanded.
+ */
+uint32_t DRV_GetNofSpeedCommands(void);
+
 constexpr auto HistorySize = 4;
 struct SpeedState
 {
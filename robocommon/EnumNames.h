@@ -0,0 +1,92 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include "FixedSizeString.h"
+#include "Optional.h"
+
+#include <array>
+#include <cstdint>
+
+template <typename E>
+struct EnumName
+{
+	const char* pName;
+	E value;
+};
+
+/**
+ * The names of the values of an enum, e.g. for command parameters. Specialize it with a
+ * constexpr names() returning a std::array of EnumName<E>:
+ *
+ *	template <>
+ *	struct EnumNames<OnOff>
+ *	{
+ *		static constexpr std::array<EnumName<OnOff>, 2> names()
+ *		{
+ *			return {{{"on", OnOff::On}, {"off", OnOff::Off}}};
+ *		}
+ *	};
+ */
+template <typename E>
+struct EnumNames;
+
+template <typename E>
+optional<E> stringToEnum(const StringSlice& str)
+{
+	for (const auto& entry : EnumNames<E>::names())
+	{
+		if (str == entry.pName)
+		{
+			return entry.value;
+		}
+	}
+	return {};
+}
+
+//! \return the first name of the value, "" if it has none
+template <typename E>
+const char* enumToString(E value)
+{
+	for (const auto& entry : EnumNames<E>::names())
+	{
+		if (entry.value == value)
+		{
+			return entry.pName;
+		}
+	}
+	return "";
+}
+
+enum class OnOff : uint8_t
+{
+	Off,
+	On
+};
+
+template <>
+struct EnumNames<OnOff>
+{
+	static constexpr std::array<EnumName<OnOff>, 2> names()
+	{
+		return {{{"on", OnOff::On}, {"off", OnOff::Off}}};
+	}
+};
+
+//! a motor or sensor of a side, "L" or "R" on the console
+enum class Side : uint8_t
+{
+	Left,
+	Right
+};
+
+template <>
+struct EnumNames<Side>
+{
+	static constexpr std::array<EnumName<Side>, 2> names()
+	{
+		return {{{"L", Side::Left}, {"R", Side::Right}}};
+	}
+};
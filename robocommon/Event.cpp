@@ -2,5 +2,5 @@
 #include "Event.h"
 #include "Platform.h"
 
-EventQueue<Event, DisableInterrupts> eventQueue;
+MainEventQueue eventQueue;
 
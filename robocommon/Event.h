@@ -7,11 +7,14 @@
 #include "Platform.h"
 #include "EventQueue.h"
 #include "CriticalSection.h"
+#include "TaskNotifier.h"
+#include "EventTrace.h"
 
 enum class Event : uint8_t
 {
 	SystemStartup,		/*!< System startup Event */
 	LedHeartbeat,		/*!< LED heartbeat */
+	/*!< the 4 events of a key must stay together and in this order, see makeKeyEventTable() */
 #if PL_NOF_KEYS >= 1
 	Sw1Pressed,
 	Sw1LongPressed,
@@ -54,6 +57,9 @@ enum class Event : uint8_t
 	Sw7Released,
 	Sw7ReleasedLong,
 #endif
+#if PL_NOF_KEYS >= 2
+	Sw1Sw2Chord,		/*!< keys 1 and 2 pressed together */
+#endif
 #if PL_HAS_LINE_SENSOR
 	RefStartStopCalibration,
 #endif
@@ -61,5 +67,9 @@ enum class Event : uint8_t
 	AmountOfEvents		/*!< must be the last */
 };
 
-using MainEventQueue = EventQueue<Event, DisableInterrupts>;
+#if PL_HAS_EVENT_TRACE
+using MainEventQueue = EventQueue<Event, DisableInterrupts, TaskNotifier, GlobalEventTracer>;
+#else
+using MainEventQueue = EventQueue<Event, DisableInterrupts, TaskNotifier>;
+#endif
 extern MainEventQueue eventQueue;
@@ -0,0 +1,206 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+#include "CommonTraits.h"
+#include "EventHandler.h"
+#include "EventQueue.h"
+
+namespace detail
+{
+	template <typename Queue>
+	bool isPending(const typename Queue::Traits::EventQueueArray& pending, size_t eventNo)
+	{
+		return (pending[eventNo / Queue::Traits::ArrayElementTypeBits] >> (eventNo % Queue::Traits::ArrayElementTypeBits)) & 0x1;
+	}
+
+	template <typename Queue, typename... HandlerFns>
+	void handleEventNo(Queue& queue, size_t eventNo, const std::tuple<HandlerFns...>& handlers)
+	{
+		auto event = static_cast<typename Queue::EnumType>(eventNo);
+		if (queue.getAndResetEvent(event))
+		{
+			queue.traceHandled(event);
+			dispatchEvent(eventNo, handlers, ::MakeIndexSequence<sizeof...(HandlerFns)>{});
+		}
+	}
+}
+
+/**
+ * Handles the pending event with the highest priority. Priorities has one value per event,
+ * in the order of the event enum, the higher value wins. Equal priorities are handled
+ * lowest event number first.
+ */
+template <uint8_t... Priorities>
+class StrictPriority
+{
+public:
+	template <typename Queue, typename... HandlerFns>
+	void dispatch(Queue& queue, const std::tuple<HandlerFns...>& handlers)
+	{
+		static_assert(sizeof...(Priorities) == Queue::AmountOfEvents, "every event needs a priority");
+		static constexpr uint8_t priorities[] = { Priorities... };
+
+		auto pending = queue.peekAll();
+		auto found = false;
+		auto bestEventNo = size_t{0};
+		for (auto eventNo = size_t{0}; eventNo < Queue::AmountOfEvents; ++eventNo)
+		{
+			if (detail::isPending<Queue>(pending, eventNo) && (!found || priorities[eventNo] > priorities[bestEventNo]))
+			{
+				found = true;
+				bestEventNo = eventNo;
+			}
+		}
+		if (found)
+		{
+			detail::handleEventNo(queue, bestEventNo, handlers);
+		}
+	}
+};
+
+/**
+ * Handles one pending event per call, starting after the event handled last, so every pending
+ * event is handled after at most AmountOfEvents calls.
+ */
+class RoundRobin
+{
+public:
+	template <typename Queue, typename... HandlerFns>
+	void dispatch(Queue& queue, const std::tuple<HandlerFns...>& handlers)
+	{
+		auto pending = queue.peekAll();
+		for (auto i = size_t{0}; i < Queue::AmountOfEvents; ++i)
+		{
+			auto eventNo = (nextEventNo + i) % Queue::AmountOfEvents;
+			if (detail::isPending<Queue>(pending, eventNo))
+			{
+				nextEventNo = (eventNo + 1) % Queue::AmountOfEvents;
+				detail::handleEventNo(queue, eventNo, handlers);
+				return;
+			}
+		}
+	}
+
+private:
+	size_t nextEventNo = 0;
+};
+
+/**
+ * Handles all events pending at the time of the call, see handleAllEvents().
+ */
+class DrainAll
+{
+public:
+	template <typename Queue, typename... HandlerFns>
+	void dispatch(Queue& queue, const std::tuple<HandlerFns...>& handlers)
+	{
+		handleAllEvents(queue, handlers);
+	}
+};
+
+/**
+ * Dispatches the events of the queue to the handlers (one per event, in the order of the event
+ * enum) in the order given by DispatchPolicy (StrictPriority, RoundRobin or DrainAll).
+ */
+template <typename Queue, typename DispatchPolicy>
+class EventDispatcher
+{
+public:
+	explicit EventDispatcher(Queue& queue, DispatchPolicy policy = {})
+		: queue(queue)
+		, policy(policy)
+	{
+	}
+
+	template <typename... HandlerFns>
+	void dispatch(std::tuple<HandlerFns...> handlers)
+	{
+		static_assert(sizeof...(HandlerFns) == Queue::AmountOfEvents, "the amount of handlers must match the amount of events");
+		policy.dispatch(queue, handlers);
+	}
+
+	template <typename... HandlerFns>
+	void dispatch(HandlerFns... handlers)
+	{
+		dispatch(std::make_tuple(handlers...));
+	}
+
+private:
+	Queue& queue;
+	DispatchPolicy policy;
+};
+
+template <typename DispatchPolicy, typename Queue>
+EventDispatcher<Queue, DispatchPolicy> makeEventDispatcher(Queue& queue, DispatchPolicy policy = {})
+{
+	return EventDispatcher<Queue, DispatchPolicy>{queue, policy};
+}
+
+/**
+ * How long events stayed pending, from the first setEvent() until their handler ran.
+ */
+struct PendingTimeStats
+{
+	uint32_t count = 0;
+	uint32_t maxUs = 0;
+	uint64_t totalUs = 0;
+
+	uint32_t averageUs() const
+	{
+		return count == 0 ? 0 : static_cast<uint32_t>(totalUs / count);
+	}
+};
+
+/**
+ * EventQueue tracer which keeps PendingTimeStats per event. Clock::nowUs() gives the time,
+ * every call is forwarded to NextTracer as well.
+ */
+template <size_t NofEvents, typename Clock, typename NextTracer = NoTracer>
+class PendingTimeTracer
+{
+public:
+	void eventSet(uint8_t eventNo)
+	{
+		if (!isPending[eventNo])
+		{
+			isPending[eventNo] = true;
+			setTimeUs[eventNo] = Clock::nowUs();
+		}
+		nextTracer.eventSet(eventNo);
+	}
+
+	void eventHandled(uint8_t eventNo)
+	{
+		if (isPending[eventNo])
+		{
+			isPending[eventNo] = false;
+			uint32_t pendingUs = Clock::nowUs() - setTimeUs[eventNo];
+			auto& eventStats = stats[eventNo];
+			++eventStats.count;
+			eventStats.totalUs += pendingUs;
+			if (pendingUs > eventStats.maxUs)
+			{
+				eventStats.maxUs = pendingUs;
+			}
+		}
+		nextTracer.eventHandled(eventNo);
+	}
+
+	const PendingTimeStats& getStats(uint8_t eventNo) const
+	{
+		return stats[eventNo];
+	}
+
+private:
+	std::array<bool, NofEvents> isPending{};
+	std::array<uint32_t, NofEvents> setTimeUs{};
+	std::array<PendingTimeStats, NofEvents> stats;
+	NextTracer nextTracer;
+};
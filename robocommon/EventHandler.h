@@ -4,7 +4,9 @@
 #error sorry, this header is c++ only
 #endif
 
+#include <cstdint>
 #include <tuple>
+#include "CommonTraits.h"
 
 namespace detail
 {
@@ -18,6 +20,7 @@ namespace detail
 			auto eventHasBeenSet = queue.getAndResetEvent(static_cast<typename Queue::EnumType>(EventNo));
 			if (eventHasBeenSet)
 			{
+				queue.traceHandled(static_cast<typename Queue::EnumType>(EventNo));
 				std::get<EventNo>(handlers)();
 			}
 			else
@@ -44,6 +47,104 @@ namespace detail
 	}
 }
 
+namespace detail
+{
+	inline size_t countTrailingZeros(uint32_t bits)
+	{
+		return __builtin_ctz(bits);
+	}
+
+	template <size_t EventNo, typename Handlers>
+	void callHandler(const Handlers& handlers)
+	{
+		std::get<EventNo>(handlers)();
+	}
+
+	template <typename Handlers, size_t... EventNos>
+	void dispatchEvent(size_t eventNo, const Handlers& handlers, IndexSequence<EventNos...>)
+	{
+		using HandlerThunk = void (*)(const Handlers&);
+		static constexpr HandlerThunk jumpTable[] = { &callHandler<EventNos, Handlers>... };
+		jumpTable[eventNo](handlers);
+	}
+}
+
+namespace detail
+{
+	template <size_t EventNo, typename Queue, typename Handlers>
+	void takeAndCallPayloadHandler(Queue& queue, const Handlers& handlers)
+	{
+		auto payload = queue.template take<static_cast<typename Queue::EnumType>(EventNo)>();
+		if (payload)
+		{
+			std::get<EventNo>(handlers)(*payload);
+		}
+	}
+
+	template <typename Queue, typename Handlers, size_t... EventNos>
+	void dispatchPayloadEvent(size_t eventNo, Queue& queue, const Handlers& handlers, IndexSequence<EventNos...>)
+	{
+		using HandlerThunk = void (*)(Queue&, const Handlers&);
+		static constexpr HandlerThunk jumpTable[] = { &takeAndCallPayloadHandler<EventNos, Queue, Handlers>... };
+		jumpTable[eventNo](queue, handlers);
+	}
+}
+
+/**
+ * Payload aware variant of handleOneEvent() for a PayloadEventQueue: takes one payload of the
+ * lowest pending event number and calls its handler with it.
+ * \return true if an event has been handled
+ */
+template <typename Queue, typename... HandlerFns>
+bool handleOnePayloadEvent(Queue& queue, std::tuple<HandlerFns...> handlers)
+{
+	static_assert(std::tuple_size<std::tuple<HandlerFns...>>::value == Queue::AmountOfEvents, "the amount of handlers must match the amount of events");
+	auto pendingEvents = queue.pendingEvents();
+	if (pendingEvents == 0)
+	{
+		return false;
+	}
+	detail::dispatchPayloadEvent(detail::countTrailingZeros(pendingEvents), queue, handlers, MakeIndexSequence<sizeof...(HandlerFns)>{});
+	return true;
+}
+
+template <typename Queue, typename... HandlerFns>
+bool handleOnePayloadEvent(Queue& queue, HandlerFns... handlers)
+{
+	return handleOnePayloadEvent(queue, std::make_tuple(handlers...));
+}
+
+/**
+ * Takes all pending events out of the queue with a single lock and calls their handlers,
+ * lowest event number (highest priority) first. Events set by the handlers are left for
+ * the next call.
+ */
+template <typename Queue, typename... HandlerFns>
+void handleAllEvents(Queue& queue, std::tuple<HandlerFns...> handlers)
+{
+	static_assert(std::tuple_size<std::tuple<HandlerFns...>>::value == Queue::AmountOfEvents, "the amount of handlers must match the amount of events");
+	constexpr auto BitsPerEntry = Queue::Traits::ArrayElementTypeBits;
+
+	auto pendingEvents = queue.takeAll();
+	for (auto entry = size_t{0}; entry < pendingEvents.size(); ++entry)
+	{
+		auto bits = pendingEvents[entry];
+		while (bits != 0)
+		{
+			auto eventNo = entry * BitsPerEntry + detail::countTrailingZeros(bits);
+			bits &= bits - 1; //clear lowest set bit
+			queue.traceHandled(static_cast<typename Queue::EnumType>(eventNo));
+			detail::dispatchEvent(eventNo, handlers, MakeIndexSequence<sizeof...(HandlerFns)>{});
+		}
+	}
+}
+
+template <typename Queue, typename... HandlerFns>
+void handleAllEvents(Queue& queue, HandlerFns... handlers)
+{
+	handleAllEvents(queue, std::make_tuple(handlers...));
+}
+
 template <typename Queue, typename... HandlerFns>
 void handleOneEvent(Queue& queue, std::tuple<HandlerFns...> handlers)
 {
@@ -5,7 +5,9 @@
 #endif
 
 #include <array>
+#include <cstdint>
 #include <type_traits>
+#include <utility>
 #include "CharBit.h"
 
 namespace detail
@@ -33,7 +35,37 @@ namespace detail
 	};
 }
 
-template <typename EventEnumType, typename GlobalLockGuard>
+/**
+ * Notifier for an EventQueue nobody waits on
+ */
+struct NoNotifier
+{
+	void notify()
+	{
+	}
+};
+
+/**
+ * Tracer for an EventQueue without tracing
+ */
+struct NoTracer
+{
+	void eventSet(uint8_t)
+	{
+	}
+
+	void eventHandled(uint8_t)
+	{
+	}
+};
+
+/**
+ * Notifier is informed after each setEvent() (possibly from an interrupt) and lets the consumer
+ * block in waitForEvents() until an event is pending, see TaskNotifier.
+ * Tracer records when events are set and handled (called with the lock held), see EventTrace.h
+ * and PendingTimeTracer.
+ */
+template <typename EventEnumType, typename GlobalLockGuard, typename Notifier = NoNotifier, typename Tracer = NoTracer>
 class EventQueue
 {
 public:
@@ -42,11 +74,46 @@ public:
 	static constexpr typename Traits::EventUnderlyingType AmountOfEvents = static_cast<typename Traits::EventUnderlyingType>(EventEnumType::AmountOfEvents);
 
 	void setEvent(EventEnumType event)
+	{
+		{
+			GlobalLockGuard lock;
+			(void)lock;
+			auto eventNo = static_cast<typename Traits::EventUnderlyingType>(event);
+			data[eventNo / Traits::ArrayElementTypeBits] |= Traits::getBitmaskFor(event);
+			tracer.eventSet(static_cast<uint8_t>(event));
+		}
+		notifier.notify();
+	}
+
+	//! called by the event handlers right before the handler of the event runs
+	void traceHandled(EventEnumType event)
+	{
+		traceHandled(event, std::is_same<Tracer, NoTracer>{});
+	}
+
+	const Tracer& getTracer() const
+	{
+		return tracer;
+	}
+
+	bool hasEvents() const
 	{
 		GlobalLockGuard lock;
 		(void)lock;
-		auto eventNo = static_cast<typename Traits::EventUnderlyingType>(event);
-		data[eventNo / Traits::ArrayElementTypeBits] |= Traits::getBitmaskFor(event);
+		for (auto entry : data)
+		{
+			if (entry != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//! blocks until at least one event is set, only one consumer may wait
+	void waitForEvents()
+	{
+		notifier.waitUntil([this]{ return hasEvents(); });
 	}
 
 	bool getAndResetEvent(EventEnumType event)
@@ -60,6 +127,40 @@ public:
 		return isSet;
 	}
 
+	//! returns all set events without resetting them
+	typename Traits::EventQueueArray peekAll() const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		return data;
+	}
+
+	/**
+	 * returns all set events and resets them, in a single lock
+	 */
+	typename Traits::EventQueueArray takeAll()
+	{
+		typename Traits::EventQueueArray events{};
+		GlobalLockGuard lock;
+		(void)lock;
+		std::swap(events, data);
+		return events;
+	}
+
 private:
+	//! without a tracer there is nothing to lock for, handleAllEvents() keeps its single lock
+	void traceHandled(EventEnumType /*event*/, std::true_type)
+	{
+	}
+
+	void traceHandled(EventEnumType event, std::false_type)
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		tracer.eventHandled(static_cast<uint8_t>(event));
+	}
+
 	typename Traits::EventQueueArray data{};
+	Notifier notifier;
+	Tracer tracer;
 };
@@ -0,0 +1,49 @@
+/*!
+ * \file EventTrace.cpp
+ * \brief Event trace implementation
+ *
+ * Keeps the last EVTR_NOF_RECORDS set/handled events in a lock free ring buffer.
+ */
+
+#include "Platform.h"
+#if PL_HAS_EVENT_TRACE
+#include "EventTrace.h"
+#include "Timer.h"
+
+#define EVTR_NOF_RECORDS	(128)
+/*!< number of records kept, must be a power of two */
+
+static EventTraceBuffer<EVTR_NOF_RECORDS> EVTR_Buffer;
+
+/*!
+ * \brief 0 in a task, the exception number in an interrupt.
+ */
+static uint8_t EVTR_Source(void) {
+  uint32_t ipsr;
+
+  __asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+  return (uint8_t)ipsr;
+}
+
+void EVTR_Record(uint8_t eventNo, EventTraceKind kind) {
+  EventTraceRecord record;
+
+  record.timestampUs = TMR_ValueUs();
+  record.eventNo = eventNo;
+  record.kind = kind;
+  record.source = EVTR_Source();
+  EVTR_Buffer.record(record);
+}
+
+void EVTR_Dump(IOStream& ioStream) {
+  static std::array<EventTraceRecord, EVTR_NOF_RECORDS> records; /* not on the stack of the console task */
+  auto count = EVTR_Buffer.copy_to(records);
+
+  writeEventTrace(ioStream, records.data(), count);
+}
+
+void EVTR_Clear(void) {
+  EVTR_Buffer.clear();
+}
+
+#endif /* PL_HAS_EVENT_TRACE */
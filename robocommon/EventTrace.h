@@ -0,0 +1,48 @@
+/*!
+ * \file EventTrace.h
+ * \brief Event trace interface
+ *
+ * Records when the events of the main event queue are set and handled, with a microsecond
+ * timestamp, so the latencies can be analyzed after a match (see unittests/src/EventTraceDecoder.h).
+ */
+
+#ifndef EVENTTRACE_H_
+#define EVENTTRACE_H_
+
+#include "Platform.h"
+#if PL_HAS_EVENT_TRACE
+#include "EventTraceBuffer.h"
+
+/*!
+ * \brief Records an event, can be called from tasks and interrupts.
+ */
+void EVTR_Record(uint8_t eventNo, EventTraceKind kind);
+
+/*!
+ * \brief Writes the recorded events, oldest first.
+ */
+void EVTR_Dump(IOStream& ioStream);
+
+/*!
+ * \brief Removes all recorded events.
+ */
+void EVTR_Clear(void);
+
+/*!
+ * \brief Tracer for the EventQueue which records into the global event trace.
+ */
+struct GlobalEventTracer
+{
+	void eventSet(uint8_t eventNo)
+	{
+		EVTR_Record(eventNo, EventTraceKind::Set);
+	}
+
+	void eventHandled(uint8_t eventNo)
+	{
+		EVTR_Record(eventNo, EventTraceKind::Handled);
+	}
+};
+#endif /* PL_HAS_EVENT_TRACE */
+
+#endif /* EVENTTRACE_H_ */
@@ -0,0 +1,139 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "CircularBuffer.h"
+#include "IOStream.h"
+
+enum class EventTraceKind : uint8_t
+{
+	Set,
+	Handled
+};
+
+/**
+ * One entry of the event trace. Encoded it takes EncodedSize bytes, little endian:
+ * timestamp (4 bytes), event number, kind, source, reserved.
+ */
+struct EventTraceRecord
+{
+	static constexpr size_t EncodedSize = 8;
+
+	uint32_t timestampUs;
+	uint8_t eventNo;
+	EventTraceKind kind;
+	uint8_t source; //!< 0 for tasks, the exception number for interrupts
+
+	void encode(uint8_t* pData) const
+	{
+		pData[0] = static_cast<uint8_t>(timestampUs);
+		pData[1] = static_cast<uint8_t>(timestampUs >> 8);
+		pData[2] = static_cast<uint8_t>(timestampUs >> 16);
+		pData[3] = static_cast<uint8_t>(timestampUs >> 24);
+		pData[4] = eventNo;
+		pData[5] = static_cast<uint8_t>(kind);
+		pData[6] = source;
+		pData[7] = 0;
+	}
+
+	static EventTraceRecord decode(const uint8_t* pData)
+	{
+		EventTraceRecord record;
+		record.timestampUs = static_cast<uint32_t>(pData[0])
+			| static_cast<uint32_t>(pData[1]) << 8
+			| static_cast<uint32_t>(pData[2]) << 16
+			| static_cast<uint32_t>(pData[3]) << 24;
+		record.eventNo = pData[4];
+		record.kind = static_cast<EventTraceKind>(pData[5]);
+		record.source = pData[6];
+		return record;
+	}
+};
+
+/**
+ * Ring buffer of the last Capacity trace records. record() can be called from any task or
+ * interrupt without a lock, a slot is claimed with a single atomic increment.
+ * Record has to be trivially copyable, see EventTraceRecord.
+ */
+template <size_t Capacity, typename Record = EventTraceRecord>
+class EventTraceBuffer
+{
+	static_assert(detail::isPowerOfTwo(Capacity), "Capacity must be a power of two, the write index wraps around");
+
+public:
+	void record(const Record& record)
+	{
+		auto index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+		records[index & (Capacity - 1)] = record;
+	}
+
+	/**
+	 * copies the newest records, oldest first. Records overwritten during the copy are left out,
+	 * a record which is written just now may be incomplete.
+	 * \return the amount of records copied
+	 */
+	template <size_t N>
+	size_t copy_to(std::array<Record, N>& copy) const
+	{
+		uint32_t end = writeIndex.load(std::memory_order_acquire);
+		auto count = std::min<uint32_t>(end, std::min(Capacity, N));
+		auto begin = end - count;
+		for (auto i = uint32_t{0}; i < count; ++i)
+		{
+			copy[i] = records[(begin + i) & (Capacity - 1)];
+		}
+
+		//new records first reuse the slots which were not copied, then the oldest copied ones
+		uint32_t nofNewRecords = writeIndex.load(std::memory_order_acquire) - end;
+		uint32_t nofUncopiedSlots = Capacity - count;
+		auto nofOverwritten = nofNewRecords > nofUncopiedSlots ? std::min<uint32_t>(count, nofNewRecords - nofUncopiedSlots) : 0;
+		std::copy(copy.begin() + nofOverwritten, copy.begin() + count, copy.begin());
+		return count - nofOverwritten;
+	}
+
+	void clear()
+	{
+		writeIndex.store(0, std::memory_order_release);
+	}
+
+private:
+	std::array<Record, Capacity> records;
+	std::atomic<uint32_t> writeIndex{0};
+};
+
+/**
+ * Writes the records as text, which survives any terminal:
+ * a line "<name> <count>" followed by one line of hex encoded bytes per record.
+ */
+template <typename Record>
+void writeTrace(IOStream& out, const char* name, const Record* pRecords, size_t count)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+	out.write(name);
+	out.writeChar(' ');
+	out.write(static_cast<uint32_t>(count));
+	out.writeChar('\n');
+	for (auto i = size_t{0}; i < count; ++i)
+	{
+		uint8_t encoded[Record::EncodedSize];
+		pRecords[i].encode(encoded);
+		for (auto byte : encoded)
+		{
+			out.writeChar(hexDigits[byte >> 4]);
+			out.writeChar(hexDigits[byte & 0xf]);
+		}
+		out.writeChar('\n');
+	}
+}
+
+inline void writeEventTrace(IOStream& out, const EventTraceRecord* pRecords, size_t count)
+{
+	writeTrace(out, "evtrace", pRecords, count);
+}
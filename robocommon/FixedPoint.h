@@ -0,0 +1,223 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include "FixedSizeString.h"
+#include "NumberConversion.h"
+#include "Optional.h"
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace detail
+{
+
+template <typename T>
+constexpr T pow10(unsigned exponent)
+{
+	return (exponent == 0) ? T{1} : static_cast<T>(10 * pow10<T>(exponent - 1));
+}
+
+//! the parts of a number like "-12.345"
+struct DecimalText
+{
+	bool isNegative;
+	uint64_t integral;
+	uint32_t fraction;		//!< the digits after the point as a number, 345 in the example
+	uint8_t nofFractionDigits;
+};
+
+constexpr uint8_t MaxIntegralDigits = 18; //fits into an uint64_t
+constexpr uint8_t MaxFractionDigits = 9; //fits into an uint32_t
+
+/**
+ * splits a decimal number with an optional sign and fraction, all characters up to pEnd have
+ * to belong to the number
+ */
+inline optional<DecimalText> parseDecimalText(const char* p, const char* pEnd)
+{
+	DecimalText text{false, 0, 0, 0};
+	if (p != pEnd && (*p == '-' || *p == '+'))
+	{
+		text.isNegative = (*p == '-');
+		++p;
+	}
+
+	uint8_t nofIntegralDigits = 0;
+	for (; p != pEnd && *p >= '0' && *p <= '9'; ++p)
+	{
+		if (++nofIntegralDigits > MaxIntegralDigits)
+		{
+			return {};
+		}
+		text.integral = text.integral * 10 + static_cast<uint64_t>(*p - '0');
+	}
+
+	if (p != pEnd && *p == '.')
+	{
+		++p;
+		for (; p != pEnd && *p >= '0' && *p <= '9'; ++p)
+		{
+			if (++text.nofFractionDigits > MaxFractionDigits)
+			{
+				return {};
+			}
+			text.fraction = text.fraction * 10 + static_cast<uint32_t>(*p - '0');
+		}
+		if (text.nofFractionDigits == 0)
+		{ //"1." or "."
+			return {};
+		}
+	}
+
+	if (p != pEnd || (nofIntegralDigits == 0 && text.nofFractionDigits == 0))
+	{
+		return {};
+	}
+	return text;
+}
+
+//! applies the sign to a magnitude, if T can hold the result
+template <typename T>
+optional<T> toSigned(uint64_t magnitude, bool isNegative)
+{
+	if (magnitude > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+	{
+		return {};
+	}
+	if (isNegative)
+	{
+		if (!std::is_signed<T>::value && magnitude != 0)
+		{
+			return {};
+		}
+		return static_cast<T>(-static_cast<int64_t>(magnitude));
+	}
+	return static_cast<T>(magnitude);
+}
+
+}
+
+/**
+ * A number with Decimals decimal places, stored as value * 10^Decimals: Decimal<int32_t, 2>
+ * holds 1.25 as 125, like the PID factors times 100.
+ */
+template <typename T, unsigned Decimals>
+struct Decimal
+{
+	static_assert(std::is_integral<T>::value && sizeof(T) <= sizeof(int32_t), "a decimal is stored in an integer of up to 32 bits");
+	static_assert(Decimals <= 9, "at most 9 decimals");
+
+	T scaled;
+
+	//! 10^Decimals
+	static constexpr T scale()
+	{
+		return detail::pow10<T>(Decimals);
+	}
+};
+
+/**
+ * A Q-format fixed point number with FractionalBits bits after the binary point, stored as
+ * value * 2^FractionalBits: Fixed<int32_t, 16> (Q15.16) holds 1.5 as 0x18000.
+ */
+template <typename T, unsigned FractionalBits>
+struct Fixed
+{
+	static_assert(std::is_integral<T>::value && sizeof(T) <= sizeof(int32_t), "a fixed point number is stored in an integer of up to 32 bits");
+	static_assert(FractionalBits + (std::is_signed<T>::value ? 1 : 0) <= sizeof(T) * CHAR_BIT, "not enough bits for the sign");
+
+	T raw;
+
+	//! 1.0 as raw value
+	static constexpr T one()
+	{
+		return static_cast<T>(T{1} << FractionalBits);
+	}
+};
+
+/**
+ * parses a number like "-1.25", it may have at most Decimals decimals
+ * \return nothing if the slice has other characters or the number doesn't fit
+ */
+template <typename T, unsigned Decimals>
+optional<Decimal<T, Decimals>> stringToDecimal(const StringSlice& str)
+{
+	auto text = detail::parseDecimalText(str.begin(), str.end());
+	if (!text || (*text).nofFractionDigits > Decimals)
+	{
+		return {};
+	}
+	const auto& parts = *text;
+
+	constexpr auto Scale = detail::pow10<uint64_t>(Decimals);
+	if (parts.integral > static_cast<uint64_t>(std::numeric_limits<T>::max()) / Scale)
+	{
+		return {};
+	}
+	auto magnitude = parts.integral * Scale + parts.fraction * detail::pow10<uint64_t>(Decimals - parts.nofFractionDigits);
+	auto scaled = detail::toSigned<T>(magnitude, parts.isNegative);
+	if (!scaled)
+	{
+		return {};
+	}
+	return Decimal<T, Decimals>{*scaled};
+}
+
+/**
+ * parses a number like "-1.25" into the nearest fixed point value
+ * \return nothing if the slice has other characters or the number doesn't fit
+ */
+template <typename T, unsigned FractionalBits>
+optional<Fixed<T, FractionalBits>> stringToFixed(const StringSlice& str)
+{
+	auto text = detail::parseDecimalText(str.begin(), str.end());
+	if (!text)
+	{
+		return {};
+	}
+	const auto& parts = *text;
+
+	if (parts.integral > (static_cast<uint64_t>(std::numeric_limits<T>::max()) >> FractionalBits))
+	{
+		return {};
+	}
+	//the fraction has at most 9 digits (< 2^30), shifted by at most 31 bits it still fits
+	auto divisor = detail::pow10<uint64_t>(parts.nofFractionDigits);
+	auto fractionBits = ((static_cast<uint64_t>(parts.fraction) << FractionalBits) + divisor / 2) / divisor;
+	auto raw = detail::toSigned<T>((parts.integral << FractionalBits) + fractionBits, parts.isNegative);
+	if (!raw)
+	{
+		return {};
+	}
+	return Fixed<T, FractionalBits>{*raw};
+}
+
+//! writes all decimals, 125 of a Decimal<int32_t, 2> as "1.25"
+template <typename T, unsigned Decimals>
+String<detail::calcMaxStringSizeByNumberType(sizeof(T) * CHAR_BIT, true) + 2> decimalToString(const Decimal<T, Decimals>& number)
+{
+	String<detail::calcMaxStringSizeByNumberType(sizeof(T) * CHAR_BIT, true) + 2> str;
+	auto isNegative = number.scaled < 0;
+	auto magnitude = isNegative ? static_cast<uint64_t>(-static_cast<int64_t>(number.scaled)) : static_cast<uint64_t>(number.scaled);
+	constexpr auto Scale = detail::pow10<uint64_t>(Decimals);
+
+	if (isNegative)
+	{
+		str.append('-');
+	}
+	str.append(numberToString(static_cast<uint32_t>(magnitude / Scale)));
+	if (Decimals > 0)
+	{
+		str.append('.');
+		auto fraction = magnitude % Scale;
+		for (auto divisor = Scale / 10; divisor > 0; divisor /= 10)
+		{
+			str.append(static_cast<char>('0' + (fraction / divisor) % 10));
+		}
+	}
+	return str;
+}
@@ -5,6 +5,7 @@
 #endif
 
 
+#include <algorithm>
 #include <array>
 #include <type_traits>
 #include <cstring>
@@ -351,3 +352,82 @@ bool operator!=(const String<OtherSize>& str, CharT c)
 {
 	return (c == str);
 }
+
+/**
+ * Characters of a String (or of another buffer) without a copy of them. It does not own them:
+ * the String has to outlive the slice and must not change while the slice is in use.
+ */
+class StringSlice
+{
+public:
+	using const_iterator = const CharT*;
+
+	StringSlice()
+		: pBegin(nullptr)
+		, pEnd(nullptr)
+	{
+	}
+
+	StringSlice(const CharT* pBegin, const CharT* pEnd)
+		: pBegin(pBegin)
+		, pEnd(pEnd)
+	{
+		ASSERT(pEnd >= pBegin);
+	}
+
+	StringSlice(const CharT* pStr)
+		: StringSlice(pStr, pStr + strlen(pStr))
+	{
+	}
+
+	template <size_t MaxSize>
+	StringSlice(const String<MaxSize>& str)
+		: StringSlice(str.begin(), str.end())
+	{
+	}
+
+	//! a slice of a temporary would dangle
+	template <size_t MaxSize>
+	StringSlice(const String<MaxSize>&& str) = delete;
+
+	size_t size() const
+	{
+		return pEnd - pBegin;
+	}
+
+	bool empty() const
+	{
+		return pBegin == pEnd;
+	}
+
+	const CharT* begin() const
+	{
+		return pBegin;
+	}
+
+	const CharT* end() const
+	{
+		return pEnd;
+	}
+
+	CharT operator[](size_t index) const
+	{
+		ASSERT(index < size());
+		return pBegin[index];
+	}
+
+private:
+	const CharT* pBegin;
+	const CharT* pEnd;
+};
+
+inline bool operator==(const StringSlice& slice, const CharT* pStr)
+{
+	auto size = strlen(pStr);
+	return (slice.size() == size) && std::equal(slice.begin(), slice.end(), pStr);
+}
+
+inline bool operator!=(const StringSlice& slice, const CharT* pStr)
+{
+	return !(slice == pStr);
+}
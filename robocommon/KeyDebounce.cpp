@@ -3,7 +3,8 @@
  * \brief Key debouncing implementation.
  * \author Erich Styger, erich.styger@hslu.ch
  *
- * This module implements debouncing of up to 4 Keys.
+ * This module debounces up to 7 keys at once with vertical counters and maps
+ * their edges to events through a table.
  */
 
 #include "Platform.h"
@@ -11,16 +12,15 @@
 
 #include "KeyDebounce.h"
 #include "Keys.h"
-#include "Debounce.h"
-#include "Trigger.h"
 #include "Event.h"
+#include "VerticalCounterDebouncer.h"
 
 /*!
  * \brief Returns the state of the keys. This directly reflects the value of the port
  * \return Port bits
  */
-static DBNC_KeySet KEYDBNC_GetKeys(void) {
-	DBNC_KeySet keys = 0;
+static uint8_t KEYDBNC_GetKeys(void) {
+	uint8_t keys = 0;
 
 #if PL_NOF_KEYS >= 1
 	if (KEY1_Get()) {
@@ -60,205 +60,25 @@ static DBNC_KeySet KEYDBNC_GetKeys(void) {
 	return keys;
 }
 
-/*!
- * \brief Event called in the event of a long key press detected.
- * \param keys The keyboard port content
- * \param event The event kind
- */
-static void KEYDBNC_OnDebounceEvent(DBNC_EventKinds event, DBNC_KeySet keys) {
-	switch (event) {
-	/* pressed */
-	case DBNC_EVENT_PRESSED:
-#if PL_NOF_KEYS >= 1
-		if (keys == (1 << 0)) {
-			eventQueue.setEvent(Event::Sw1Pressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 2
-		if (keys==(1<<1)) {
-			eventQueue.setEvent(Event::Sw2Pressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 3
-		if (keys==(1<<2)) {
-			eventQueue.setEvent(Event::Sw3Pressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 4
-		if (keys==(1<<3)) {
-			eventQueue.setEvent(Event::Sw4Pressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 5
-		if (keys==(1<<4)) {
-			eventQueue.setEvent(Event::Sw5Pressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 6
-		if (keys==(1<<5)) {
-			eventQueue.setEvent(Event::Sw6Pressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 7
-		if (keys==(1<<6)) {
-			eventQueue.setEvent(Event::Sw7Pressed);
-		}
-#endif
-		break;
+static VerticalCounterDebouncer<KEYDBNC_LONG_PRESS_MS/KEYDBNC_SCAN_PERIOD_MS> KEYDBNC_Debouncer;
+static KeyEventMapper KEYDBNC_Mapper;
 
-		/* long pressed */
-	case DBNC_EVENT_LONG_PRESSED:
-#if PL_NOF_KEYS >= 1
-		if (keys == (1 << 0)) {
-			eventQueue.setEvent(Event::Sw1LongPressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 2
-		if (keys==(1<<1)) {
-			eventQueue.setEvent(Event::Sw2LongPressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 3
-		if (keys==(1<<2)) {
-			eventQueue.setEvent(Event::Sw3LongPressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 4
-		if (keys==(1<<3)) {
-			eventQueue.setEvent(Event::Sw4LongPressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 5
-		if (keys==(1<<4)) {
-			eventQueue.setEvent(Event::Sw5LongPressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 6
-		if (keys==(1<<5)) {
-			eventQueue.setEvent(Event::Sw6LongPressed);
-		}
-#endif
-#if PL_NOF_KEYS >= 7
-		if (keys==(1<<6)) {
-			eventQueue.setEvent(Event::Sw7LongPressed);
-		}
-#endif
-		break;
+/*! \brief Sw1Pressed to Sw<PL_NOF_KEYS>ReleasedLong, key n is bit n-1 */
+static constexpr auto KEYDBNC_KeyEvents = makeKeyEventTable<Event, Event::Sw1Pressed, PL_NOF_KEYS>();
 
-		/* released */
-	case DBNC_EVENT_RELEASED:
-#if PL_NOF_KEYS >= 1
-		if (keys == (1 << 0)) {
-			eventQueue.setEvent(Event::Sw1Released);
-		}
-#endif
+/*! \brief Keys pressed together */
+static constexpr std::array<KeyEventMapping<Event>, (PL_NOF_KEYS >= 2) ? 1 : 0> KEYDBNC_Chords = {{
 #if PL_NOF_KEYS >= 2
-		if (keys==(1<<1)) {
-			eventQueue.setEvent(Event::Sw2Released);
-		}
+	{KeyEdge::Chord, (1<<0)|(1<<1), Event::Sw1Sw2Chord},
 #endif
-#if PL_NOF_KEYS >= 3
-		if (keys==(1<<2)) {
-			eventQueue.setEvent(Event::Sw3Released);
-		}
-#endif
-#if PL_NOF_KEYS >= 4
-		if (keys==(1<<3)) {
-			eventQueue.setEvent(Event::Sw4Released);
-		}
-#endif
-#if PL_NOF_KEYS >= 5
-		if (keys==(1<<4)) {
-			eventQueue.setEvent(Event::Sw5Released);
-		}
-#endif
-#if PL_NOF_KEYS >= 6
-		if (keys==(1<<5)) {
-			eventQueue.setEvent(Event::Sw6Released);
-		}
-#endif
-#if PL_NOF_KEYS >= 7
-		if (keys==(1<<6)) {
-			eventQueue.setEvent(Event::Sw7Released);
-		}
-#endif
-		break;
-
-		/* released after long press*/
-	case DBNC_EVENT_RELEASED_LONG:
-#if PL_NOF_KEYS >= 1
-		if (keys == (1 << 0)) {
-			eventQueue.setEvent(Event::Sw1ReleasedLong);
-		}
-#endif
-#if PL_NOF_KEYS >= 2
-		if (keys==(1<<1)) {
-			eventQueue.setEvent(Event::Sw2ReleasedLong);
-		}
-#endif
-#if PL_NOF_KEYS >= 3
-		if (keys==(1<<2)) {
-			eventQueue.setEvent(Event::Sw3ReleasedLong);
-		}
-#endif
-#if PL_NOF_KEYS >= 4
-		if (keys==(1<<3)) {
-			eventQueue.setEvent(Event::Sw4ReleasedLong);
-		}
-#endif
-#if PL_NOF_KEYS >= 5
-		if (keys==(1<<4)) {
-			eventQueue.setEvent(Event::Sw5ReleasedLong);
-		}
-#endif
-#if PL_NOF_KEYS >= 6
-		if (keys==(1<<5)) {
-			eventQueue.setEvent(Event::Sw6ReleasedLong);
-		}
-#endif
-#if PL_NOF_KEYS >= 7
-		if (keys==(1<<6)) {
-			eventQueue.setEvent(Event::Sw7ReleasedLong);
-		}
-#endif
-		break;
-
-	case DBNC_EVENT_END:
-		/*! \todo Implement what you have to do at the end of the debouncing. Need to re-enable interrupts? */
-#if PL_HAS_KBI
-		KEY_EnableInterrupts();
-#endif
-		break;
-	} /* switch */
-}
-
-/*! \brief This struct contains all the data and pointers needed to have
- *         our debounce FSM reentrant and usable for multiple ISR's.
- */
-static DBNC_FSMData KEYDBNC_FSMdata = {
-/* callbacks: */
-KEYDBNC_GetKeys, /* returns bit set of pressed keys */
-KEYDBNC_OnDebounceEvent, /* event callback */
-/* data: */
-DBNC_KEY_IDLE, /* initial state machine state, here the state is stored */
-0, /* key scan value */
-0, /* long key count */
-TRG_KEYPRESS, /* trigger to be used */
-(50 / TRG_TICKS_MS), /* debounceTicks for 50 ms */
-(500 / TRG_TICKS_MS), /* longKeyTicks for 500 ms */
-};
+}};
 
 void KEYDBNC_Process(void) {
-	/** \todo call DBNC_Process(&KEYDBNC_FSMdata);
-	 * But be careful: only if we are not debouncing, and if we have a key press if we are polling.
-	 * And you will need to disable the keyboard interrupts too!
-	 */
-	if (KEYDBNC_FSMdata.state == DBNC_KEY_IDLE && KEYDBNC_GetKeys() != 0) { /* a key is pressed and we are not debouncing */
-#if PL_HAS_KBI
-		KEY_DisableInterrupts(); /* disable interrupts for all keys */
-#endif
-		DBNC_Process(&KEYDBNC_FSMdata); /* starts the state machine */
-	}
+	KeyEdges edges = KEYDBNC_Debouncer.sample(KEYDBNC_GetKeys());
+
+	KEYDBNC_Mapper.map(edges, KEYDBNC_Chords, KEYDBNC_KeyEvents, [](Event event) {
+		eventQueue.setEvent(event);
+	});
 }
 
 void KEYDBNC_Init(void) {
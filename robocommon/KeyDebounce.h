@@ -10,8 +10,15 @@
 #ifndef __cplusplus
 #error sorry, this header is c++ only
 #endif
+
+#define KEYDBNC_SCAN_PERIOD_MS  (10)
+  /*!< KEYDBNC_Process has to be called with this period, a key is debounced after 4 periods */
+
+#define KEYDBNC_LONG_PRESS_MS  (500)
+  /*!< time a key has to be held for a long press */
+
 /*!
- * \brief Kicks the debouncing state machine.
+ * \brief Samples the keys and sets the events of the keys which changed.
  */
 void KEYDBNC_Process(void);
 
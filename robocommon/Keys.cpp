@@ -63,7 +63,7 @@ void KEY_Scan(void) {
 #if PL_HAS_KBI
 void KEY_OnInterrupt(KEY_Buttons button) {
 #if PL_HAS_DEBOUNCE
-  KEYDBNC_Process();
+  (void)button; /* the keys are sampled periodically by KEY_Scan */
 #else
   switch(button) {
 #if PL_NOF_KEYS >= 1
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+#include <cstdint>
+
+/**
+ * Latencies in power of two buckets: bucket 0 counts latencies below 2us, bucket n those in [2^n, 2^(n+1)) us.
+ */
+struct LatencyHistogram
+{
+	static constexpr size_t NofBuckets = 24;
+
+	std::array<uint32_t, NofBuckets> buckets{};
+	uint32_t count = 0;
+	uint32_t maxUs = 0;
+
+	static size_t bucketOf(uint32_t latencyUs)
+	{
+		auto bucket = size_t{0};
+		while ((latencyUs >> (bucket + 1)) != 0 && bucket + 1 < NofBuckets)
+		{
+			++bucket;
+		}
+		return bucket;
+	}
+
+	void add(uint32_t latencyUs)
+	{
+		++buckets[bucketOf(latencyUs)];
+		++count;
+		if (latencyUs > maxUs)
+		{
+			maxUs = latencyUs;
+		}
+	}
+};
@@ -113,12 +113,47 @@ inline void CLS1_SendNum8u(uint8_t val, const Adapter *io)
   static_cast<const detail::CppAdapter*>(io)->sendStr(buf);
 }
 
+inline void CLS1_SendNum32u(uint32_t val, const Adapter *io)
+{
+  unsigned char buf[sizeof("4294967295")];
+
+  UTIL1_Num32uToStr(buf, sizeof(buf), val);
+  static_cast<const detail::CppAdapter*>(io)->sendStr(buf);
+}
+
+//! writes to the output of a legacy command, e.g. for its "status" with the printer of a typed command
+class LegacyIOStream final : public IOStream
+{
+public:
+	explicit LegacyIOStream(const Adapter* io)
+		: io(io)
+	{
+	}
+
+	optional<char> readChar() final override
+	{
+		return {};
+	}
+
+	void writeChar(char c) final override
+	{
+		const unsigned char text[] = {static_cast<unsigned char>(c), '\0'};
+		CLS1_SendStr(text, io);
+	}
+
+private:
+	const Adapter* io;
+};
+
 namespace detail
 {
 
 class LegacyArgsCommand
 {
 public:
+	//! the parse function may handle more, e.g. "status", see ConcreteCommandParser
+	static constexpr bool MatchesOnlyItsName = false;
+
 	LegacyArgsCommand(ParseCommandFn fn)
 		: fn(fn)
 	{
@@ -184,6 +219,12 @@ public:
 		return cmd;
 	}
 
+	//! the help of a legacy command lists its sub commands, it is printed by "<name> help"
+	CommandInfo getInfo() const
+	{
+		return CommandInfo{getCmd(), nullptr, nullptr};
+	}
+
 private:
 	bool matches(const String<MaxCommandLength>& cmdToExecute)
 	{
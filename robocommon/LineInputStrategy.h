@@ -54,7 +54,20 @@ public:
 	}
 };
 
-template <size_t MaxLineLength, typename LineSink = DiscardingLineSink<MaxLineLength>, typename EchoConsole = DiscardingEchoConsole<MaxLineLength>, typename HistoryController = NoHistoryController<MaxLineLength>>
+class NoCompleter
+{
+public:
+	template <size_t MaxLineLength>
+	StringSlice complete(const String<MaxLineLength>& /*line*/) const
+	{
+		return {};
+	}
+};
+
+/**
+ * \tparam Completer tab appends what its complete(line) returns, see CommandNameCompleter
+ */
+template <size_t MaxLineLength, typename LineSink = DiscardingLineSink<MaxLineLength>, typename EchoConsole = DiscardingEchoConsole<MaxLineLength>, typename HistoryController = NoHistoryController<MaxLineLength>, typename Completer = NoCompleter>
 class LineInputStrategy
 {
 private:
@@ -67,10 +80,11 @@ private:
 public:
 	using Line = String<MaxLineLength>;
 
-	explicit LineInputStrategy(LineSink lineSink = {}, EchoConsole echoConsole = {}, HistoryController historyController = {})
+	explicit LineInputStrategy(LineSink lineSink = {}, EchoConsole echoConsole = {}, HistoryController historyController = {}, Completer completer = {})
 		: lineSink(lineSink)
 		, echoConsole(echoConsole)
 		, historyController(historyController)
+		, completer(completer)
 	{
 	}
 
@@ -125,6 +139,17 @@ private:
 			}
 			return InputState::ReceiveNormalCharacter;
 		}
+		else if (c == '\t')
+		{
+			for (auto completion : completer.complete(currentlyReceivingLine))
+			{
+				if (currentlyReceivingLine.append(completion) == StringManipulationResult::Ok)
+				{
+					echoConsole.write(ioStream, completion);
+				}
+			}
+			return InputState::ReceiveNormalCharacter;
+		}
 		else if (c == 0x1b)
 		{
 			return InputState::ReceiveEscapeSequence;
@@ -250,10 +275,11 @@ private:
 	LineSink lineSink;
 	EchoConsole echoConsole;
 	HistoryController historyController;
+	Completer completer;
 };
 
-template <size_t MaxLineLength, typename LineSink = DiscardingLineSink<MaxLineLength>, typename EchoConsole = DiscardingEchoConsole<MaxLineLength>, typename HistoryController = NoHistoryController<MaxLineLength>>
-LineInputStrategy<MaxLineLength, LineSink, EchoConsole, HistoryController> makeLineInputStrategy(LineSink lineSink = {}, EchoConsole echoConsole = {}, HistoryController historyController = {})
+template <size_t MaxLineLength, typename LineSink = DiscardingLineSink<MaxLineLength>, typename EchoConsole = DiscardingEchoConsole<MaxLineLength>, typename HistoryController = NoHistoryController<MaxLineLength>, typename Completer = NoCompleter>
+LineInputStrategy<MaxLineLength, LineSink, EchoConsole, HistoryController, Completer> makeLineInputStrategy(LineSink lineSink = {}, EchoConsole echoConsole = {}, HistoryController historyController = {}, Completer completer = {})
 {
-	return LineInputStrategy<MaxLineLength, LineSink, EchoConsole, HistoryController>{lineSink, echoConsole, historyController};
+	return LineInputStrategy<MaxLineLength, LineSink, EchoConsole, HistoryController, Completer>{lineSink, echoConsole, historyController, completer};
 }
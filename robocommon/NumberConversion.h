@@ -147,14 +147,14 @@ auto numberToStringImpl(TVal val) -> String<calcMaxStringSizeByNumberType(sizeof
 }
 
 template <typename TVal>
-optional<TVal> stringToNumber(const unsigned char* pStr)
+optional<TVal> stringToNumber(const char* pStr, const char* pEnd)
 {
-	/* scans a decimal number, and stops at any non-number. Number can have any preceding zeros or spaces. */
+	/* scans a decimal number up to pEnd, and stops at any non-number. Number can have any preceding zeros or spaces. */
 	constexpr auto MaxNoOfDigits = calcMaxStringSizeByNumberType(sizeof(TVal) * CHAR_BIT, false) + 1;
 	uint8_t noOfDigits = MaxNoOfDigits;
-	const unsigned char *p = pStr;
+	const char *p = pStr;
 
-	while(*p==' ')
+	while(p != pEnd && *p==' ')
 	{ /* skip leading spaces */
 		p++;
 	}
@@ -162,7 +162,7 @@ optional<TVal> stringToNumber(const unsigned char* pStr)
 	bool isNeg = false;
 	if (std::is_signed<TVal>::value)
 	{
-		if (*p=='-')
+		if (p != pEnd && *p=='-')
 		{
 			isNeg = true;
 			p++; /* skip minus */
@@ -170,7 +170,7 @@ optional<TVal> stringToNumber(const unsigned char* pStr)
 	}
 
 	TVal val = 0;
-	while(*p>='0' && *p<='9' && noOfDigits > 0)
+	while(p != pEnd && *p>='0' && *p<='9' && noOfDigits > 0)
 	{
 		val = (TVal)((val)*10 + *p-'0');
 		noOfDigits--;
@@ -219,20 +219,27 @@ auto numberToString(TVal val) -> decltype(detail::numberToStringImpl<std::is_sig
 	return detail::numberToStringImpl<std::is_signed<TVal>::value, TVal>(val);
 }
 
+template <typename TVal>
+optional<TVal> stringToNumber(const char* pStr)
+{
+	return detail::stringToNumber<TVal>(pStr, pStr + strlen(pStr));
+}
+
 template <typename TVal>
 optional<TVal> stringToNumber(const unsigned char* pStr)
 {
-	return detail::stringToNumber<TVal>(pStr);
+	return stringToNumber<TVal>(reinterpret_cast<const char*>(pStr));
 }
 
+//! parses only the characters of the slice, they need not be followed by a '\0'
 template <typename TVal>
-optional<TVal> stringToNumber(const char* pStr)
+optional<TVal> stringToNumber(const StringSlice& str)
 {
-	return detail::stringToNumber<TVal>(reinterpret_cast<const unsigned char*>(pStr));
+	return detail::stringToNumber<TVal>(str.begin(), str.end());
 }
 
 template <typename TVal, size_t MaxSize>
 optional<TVal> stringToNumber(const String<MaxSize>& str)
 {
-	return stringToNumber<TVal>(str.begin());
+	return detail::stringToNumber<TVal>(str.begin(), str.end());
 }
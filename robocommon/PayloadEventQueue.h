@@ -0,0 +1,145 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "CharBit.h"
+#include "CircularBuffer.h"
+#include "Optional.h"
+
+/**
+ * Channel of a PayloadEventQueue which only keeps the latest payload of its event,
+ * e.g. for sensor values where only the newest one matters.
+ */
+template <typename Payload>
+class LatestWins
+{
+public:
+	using PayloadType = Payload;
+
+	bool push(const Payload& payload)
+	{
+		latest = payload;
+		return true;
+	}
+
+	optional<Payload> pop()
+	{
+		auto payload = std::move(latest);
+		latest.reset();
+		return payload;
+	}
+
+	bool empty() const
+	{
+		return !latest;
+	}
+
+private:
+	optional<Payload> latest;
+};
+
+/**
+ * Channel of a PayloadEventQueue which keeps up to Capacity payloads in the order they were
+ * posted, e.g. for commands which must not get lost. Payloads posted to a full channel are dropped.
+ */
+template <typename Payload, size_t Capacity>
+class QueueAll
+{
+public:
+	using PayloadType = Payload;
+
+	bool push(const Payload& payload)
+	{
+		return payloads.push_n(&payload, 1) == 1;
+	}
+
+	optional<Payload> pop()
+	{
+		return payloads.pop_front();
+	}
+
+	bool empty() const
+	{
+		return payloads.size() == 0;
+	}
+
+private:
+	CircularBuffer<Payload, Capacity> payloads;
+};
+
+/**
+ * Event queue whose events carry data. Every event of EventEnumType has a channel (LatestWins
+ * or QueueAll) in Channels, in the order of the enum, which defines its payload type and how
+ * payloads are coalesced. All payloads live in the queue itself, nothing is allocated.
+ *
+ * Use handleOnePayloadEvent() from EventHandler.h to dispatch.
+ */
+template <typename EventEnumType, typename GlobalLockGuard, typename... Channels>
+class PayloadEventQueue
+{
+public:
+	using EnumType = EventEnumType;
+	using EventUnderlyingType = typename std::underlying_type<EventEnumType>::type;
+	using PendingMask = uint32_t;
+
+	static constexpr EventUnderlyingType AmountOfEvents = static_cast<EventUnderlyingType>(EventEnumType::AmountOfEvents);
+	static_assert(sizeof...(Channels) == AmountOfEvents, "every event needs a channel");
+	static_assert(AmountOfEvents <= sizeof(PendingMask) * CHAR_BIT, "too many events for the pending mask");
+
+	template <EventEnumType Event>
+	using PayloadOf = typename std::tuple_element<static_cast<size_t>(Event), std::tuple<Channels...>>::type::PayloadType;
+
+	/**
+	 * \return false if the payload was dropped because the channel is full
+	 */
+	template <EventEnumType Event>
+	bool post(const PayloadOf<Event>& payload)
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		auto posted = std::get<static_cast<size_t>(Event)>(channels).push(payload);
+		if (posted)
+		{
+			pending |= maskOf(Event);
+		}
+		return posted;
+	}
+
+	template <EventEnumType Event>
+	optional<PayloadOf<Event>> take()
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		auto& channel = std::get<static_cast<size_t>(Event)>(channels);
+		auto payload = channel.pop();
+		if (channel.empty())
+		{
+			pending &= ~maskOf(Event);
+		}
+		return payload;
+	}
+
+	//! bit n is set if event n has a payload
+	PendingMask pendingEvents() const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		return pending;
+	}
+
+private:
+	static constexpr PendingMask maskOf(EventEnumType event)
+	{
+		return PendingMask{1} << static_cast<EventUnderlyingType>(event);
+	}
+
+	std::tuple<Channels...> channels;
+	PendingMask pending = 0;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+#include <cstdint>
+
+enum class ControlPhase : uint8_t
+{
+	Sense,	//!< read the inputs of the cycle
+	Decide,	//!< choose what to do, no outputs yet
+	Act		//!< write the outputs
+};
+
+constexpr size_t NofControlPhases = 3;
+
+/**
+ * Timing of the cycles of a PeriodicExecutive, all times in us.
+ * Jitter is how far a cycle started from its release time (previous release + period).
+ */
+struct CycleStats
+{
+	uint32_t periodUs = 0;
+	uint32_t cycles = 0;
+	uint32_t overruns = 0;		//!< cycles which didn't finish before the next release
+	uint32_t lastExecUs = 0;
+	uint32_t wcetUs = 0;		//!< worst case execution time of a whole cycle
+	std::array<uint32_t, NofControlPhases> phaseWcetUs{};
+	uint32_t maxJitterUs = 0;
+	uint64_t totalJitterUs = 0;
+
+	uint32_t averageJitterUs() const
+	{
+		return cycles == 0 ? 0 : static_cast<uint32_t>(totalJitterUs / cycles);
+	}
+};
+
+/**
+ * Runs one sense-decide-act cycle per period and keeps its CycleStats. The caller waits for the
+ * next release in between (vTaskDelayUntil() on the target), runCycle() only measures:
+ * Clock::nowUs() gives the time, GlobalLockGuard protects the stats against getStats() from
+ * another task.
+ *
+ * The first cycle defines the release times. A cycle which overruns the next release is counted
+ * and the following cycle defines the release times again, so a late cycle is not followed by
+ * a burst of cycles catching up.
+ */
+template <typename Clock, typename GlobalLockGuard>
+class PeriodicExecutive
+{
+public:
+	explicit PeriodicExecutive(uint32_t periodUs)
+	{
+		stats.periodUs = periodUs;
+	}
+
+	/**
+	 * \return true if the cycle overran, the caller should realign its release times to now
+	 */
+	template <typename Sense, typename Decide, typename Act>
+	bool runCycle(Sense sense, Decide decide, Act act)
+	{
+		std::array<uint32_t, NofControlPhases + 1> timesUs;
+		timesUs[0] = Clock::nowUs();
+		sense();
+		timesUs[1] = Clock::nowUs();
+		decide();
+		timesUs[2] = Clock::nowUs();
+		act();
+		timesUs[3] = Clock::nowUs();
+
+		GlobalLockGuard lock;
+		(void)lock;
+		if (!isAligned)
+		{
+			releaseUs = timesUs[0];
+			isAligned = true;
+		}
+		auto jitterUs = static_cast<int32_t>(timesUs[0] - releaseUs);
+		record(static_cast<uint32_t>(jitterUs < 0 ? -jitterUs : jitterUs), timesUs);
+
+		releaseUs += stats.periodUs;
+		auto overran = static_cast<int32_t>(timesUs[NofControlPhases] - releaseUs) > 0;
+		if (overran)
+		{
+			++stats.overruns;
+			isAligned = false;
+		}
+		return overran;
+	}
+
+	//! the stats are cleared, the next cycle defines the release times
+	void setPeriodUs(uint32_t periodUs)
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		stats = CycleStats{};
+		stats.periodUs = periodUs;
+		isAligned = false;
+	}
+
+	CycleStats getStats() const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		return stats;
+	}
+
+	void clearStats()
+	{
+		setPeriodUs(getStats().periodUs);
+	}
+
+private:
+	void record(uint32_t jitterUs, const std::array<uint32_t, NofControlPhases + 1>& timesUs)
+	{
+		++stats.cycles;
+		stats.totalJitterUs += jitterUs;
+		if (jitterUs > stats.maxJitterUs)
+		{
+			stats.maxJitterUs = jitterUs;
+		}
+		stats.lastExecUs = timesUs[NofControlPhases] - timesUs[0];
+		if (stats.lastExecUs > stats.wcetUs)
+		{
+			stats.wcetUs = stats.lastExecUs;
+		}
+		for (auto phase = size_t{0}; phase < NofControlPhases; ++phase)
+		{
+			uint32_t phaseUs = timesUs[phase + 1] - timesUs[phase];
+			if (phaseUs > stats.phaseWcetUs[phase])
+			{
+				stats.phaseWcetUs[phase] = phaseUs;
+			}
+		}
+	}
+
+	CycleStats stats;
+	uint32_t releaseUs = 0;
+	bool isAligned = false;
+};
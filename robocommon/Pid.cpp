@@ -98,119 +98,70 @@ void PID_Speed(int32_t currSpeed, int32_t setSpeed, bool isLeft) {
 }
 
 #if PL_HAS_SHELL
+typedef Decimal<int32_t, 2> PID_Factor100; /*!< a factor of PID_Config as decimal, the binary protocol may set negative ones */
+
+/*! \brief The parameters of the shell are unsigned, the configuration is signed */
+static int32_t PID_ClampToInt32(uint32_t value) {
+  return value>INT32_MAX ? INT32_MAX : (int32_t)value;
+}
+
+static void PrintPIDstatus(IOStream& ioStream, const PID_Config *config, const char *kindStr) {
+  ioStream << " " << kindStr << ": p " << decimalToString(PID_Factor100{config->pFactor100})
+    << " i " << decimalToString(PID_Factor100{config->iFactor100})
+    << " d " << decimalToString(PID_Factor100{config->dFactor100}) << "\n";
+  ioStream << " " << kindStr << ": windup " << config->iAntiWindup
+    << " error " << config->lastError << " integral " << config->integral << "\n";
+}
+
+void PID_CmdStatus(IOStream& ioStream) {
+  ioStream << "PID\n";
+  PrintPIDstatus(ioStream, &speedLeftConfig, "speed L");
+  PrintPIDstatus(ioStream, &speedRightConfig, "speed R");
+}
+
 static void PID_PrintHelp(const CLS1_StdIOType *io) {
-  CLS1_SendHelpStr((unsigned char*)"pid", (unsigned char*)"Group of PID commands\r\n", io->stdOut);
+  CLS1_SendHelpStr((unsigned char*)"pid", (unsigned char*)"Group of PID commands, set with pidspeed and pidwindup\r\n", io->stdOut);
   CLS1_SendHelpStr((unsigned char*)"  help|status", (unsigned char*)"Shows PID help or status\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  speed (L|R) (p|d|i|w) <value>", (unsigned char*)"Sets P, D, I or anti-windup position value\r\n", io->stdOut);
-}
-
-static void PrintPIDstatus(PID_Config *config, const unsigned char *kindStr, const CLS1_StdIOType *io) {
-  unsigned char buf[48];
-  unsigned char kindBuf[16];
-
-  UTIL1_strcpy(kindBuf, sizeof(buf), (unsigned char*)"  ");
-  UTIL1_strcat(kindBuf, sizeof(buf), kindStr);
-  UTIL1_strcat(kindBuf, sizeof(buf), (unsigned char*)" PID  ");
-  UTIL1_strcpy(buf, sizeof(buf), (unsigned char*)"p: ");
-  UTIL1_strcatNum32s(buf, sizeof(buf), config->pFactor100);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)" i: ");
-  UTIL1_strcatNum32s(buf, sizeof(buf), config->iFactor100);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)" d: ");
-  UTIL1_strcatNum32s(buf, sizeof(buf), config->dFactor100);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"\r\n");
-  CLS1_SendStatusStr(kindBuf, buf, io->stdOut);
-
-  UTIL1_strcpy(kindBuf, sizeof(buf), (unsigned char*)"  ");
-  UTIL1_strcat(kindBuf, sizeof(buf), kindStr);
-  UTIL1_strcpy(buf, sizeof(buf), (unsigned char*)" windup: ");
-  UTIL1_strcatNum32s(buf, sizeof(buf), config->iAntiWindup);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"\r\n");
-  CLS1_SendStatusStr(kindBuf, buf, io->stdOut);
-
-  UTIL1_strcpy(kindBuf, sizeof(buf), (unsigned char*)"  ");
-  UTIL1_strcat(kindBuf, sizeof(buf), kindStr);
-  UTIL1_strcpy(buf, sizeof(buf), (unsigned char*)" error: ");
-  UTIL1_strcatNum32s(buf, sizeof(buf), config->lastError);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"\r\n");
-  CLS1_SendStatusStr(kindBuf, buf, io->stdOut);
-
-  UTIL1_strcpy(kindBuf, sizeof(buf), (unsigned char*)"  ");
-  UTIL1_strcat(kindBuf, sizeof(buf), kindStr);
-  UTIL1_strcpy(buf, sizeof(buf), (unsigned char*)" integral: ");
-  UTIL1_strcatNum32s(buf, sizeof(buf), config->integral);
-  UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"\r\n");
-  CLS1_SendStatusStr(kindBuf, buf, io->stdOut);
-}
-
-static void PID_PrintStatus(const CLS1_StdIOType *io) {
-  CLS1_SendStatusStr((unsigned char*)"pid", (unsigned char*)"\r\n", io->stdOut);
-  PrintPIDstatus(&speedLeftConfig, (unsigned char*)"speed L", io);
-  PrintPIDstatus(&speedRightConfig, (unsigned char*)"speed R", io);
-}
-
-static uint8_t ParsePidParameter(PID_Config *config, const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io) {
-  const unsigned char *p;
-  uint32_t val32u;
-  uint8_t res = ERR_OK;
-
-  if (UTIL1_strncmp((char*)cmd, (char*)"p ", sizeof("p ")-1)==0) {
-    p = cmd+sizeof("p");
-    if (UTIL1_ScanDecimal32uNumber(&p, &val32u)==ERR_OK) {
-      config->pFactor100 = val32u;
-      *handled = TRUE;
-    } else {
-      CLS1_SendStr((unsigned char*)"Wrong argument\r\n", io->stdErr);
-      res = ERR_FAILED;
-    }
-  } else if (UTIL1_strncmp((char*)cmd, (char*)"i ", sizeof("i ")-1)==0) {
-    p = cmd+sizeof("i");
-    if (UTIL1_ScanDecimal32uNumber(&p, &val32u)==ERR_OK) {
-      config->iFactor100 = val32u;
-      *handled = TRUE;
-    } else {
-      CLS1_SendStr((unsigned char*)"Wrong argument\r\n", io->stdErr);
-      res = ERR_FAILED;
-    }
-  } else if (UTIL1_strncmp((char*)cmd, (char*)"d ", sizeof("d ")-1)==0) {
-    p = cmd+sizeof("d");
-    if (UTIL1_ScanDecimal32uNumber(&p, &val32u)==ERR_OK) {
-      config->dFactor100 = val32u;
-      *handled = TRUE;
-    } else {
-      CLS1_SendStr((unsigned char*)"Wrong argument\r\n", io->stdErr);
-      res = ERR_FAILED;
-    }
-  } else if (UTIL1_strncmp((char*)cmd, (char*)"w ", sizeof("w ")-1)==0) {
-    p = cmd+sizeof("w");
-    if (UTIL1_ScanDecimal32uNumber(&p, &val32u)==ERR_OK) {
-      config->iAntiWindup = val32u;
-      *handled = TRUE;
-    } else {
-      CLS1_SendStr((unsigned char*)"Wrong argument\r\n", io->stdErr);
-      res = ERR_FAILED;
-    }
-  }
-  return res;
 }
 
 uint8_t PID_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io) {
-  uint8_t res = ERR_OK;
-
   if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_HELP)==0 || UTIL1_strcmp((char*)cmd, (char*)"pid help")==0) {
     PID_PrintHelp(io);
     *handled = TRUE;
   } else if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_STATUS)==0 || UTIL1_strcmp((char*)cmd, (char*)"pid status")==0) {
-    PID_PrintStatus(io);
+    LegacyIOStream ioStream(io->stdOut);
+    PID_CmdStatus(ioStream);
     *handled = TRUE;
-  } else if (UTIL1_strncmp((char*)cmd, (char*)"pid speed L ", sizeof("pid speed L ")-1)==0) {
-    res = ParsePidParameter(&speedLeftConfig, cmd+sizeof("pid speed L ")-1, handled, io);
-  } else if (UTIL1_strncmp((char*)cmd, (char*)"pid speed R ", sizeof("pid speed R ")-1)==0) {
-    res = ParsePidParameter(&speedRightConfig, cmd+sizeof("pid speed R ")-1, handled, io);
   }
-  return res;
+  return ERR_OK;
+}
+
+void PID_CmdSpeedGain(Side side, PidGain gain, PidFactor factor) {
+  PID_Config *config = (side == Side::Left) ? &speedLeftConfig : &speedRightConfig;
+
+  switch (gain) {
+    case PidGain::P: config->pFactor100 = PID_ClampToInt32(factor.scaled); break;
+    case PidGain::I: config->iFactor100 = PID_ClampToInt32(factor.scaled); break;
+    case PidGain::D: config->dFactor100 = PID_ClampToInt32(factor.scaled); break;
+  }
+}
+
+void PID_CmdSpeedWindup(Side side, uint32_t limit) {
+  PID_Config *config = (side == Side::Left) ? &speedLeftConfig : &speedRightConfig;
+
+  config->iAntiWindup = PID_ClampToInt32(limit);
 }
 #endif /* PL_HAS_SHELL */
 
+void PID_SetSpeedConfig(bool isLeft, int32_t pFactor100, int32_t iFactor100, int32_t dFactor100, int32_t iAntiWindup) {
+  PID_Config *config = isLeft ? &speedLeftConfig : &speedRightConfig;
+
+  config->pFactor100 = pFactor100;
+  config->iFactor100 = iFactor100;
+  config->dFactor100 = dFactor100;
+  config->iAntiWindup = iAntiWindup;
+}
+
 void PID_Start(void) {
   /* reset the 'memory' values of the structure back to zero */
   speedLeftConfig.lastError = 0;
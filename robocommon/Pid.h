@@ -11,15 +11,45 @@
 #if PL_HAS_PID
 
 #if PL_HAS_SHELL
-//#include "CLS1.h"
 #include "LegacyArgsCommand.h"
+#include <IOStream.h>
+#include <EnumNames.h>
+#include <FixedPoint.h>
+
+/*! \brief Gain of a PID, "p", "i" or "d" on the shell */
+enum class PidGain : uint8_t {
+  P,
+  I,
+  D
+};
+
+template <>
+struct EnumNames<PidGain> {
+  static constexpr std::array<EnumName<PidGain>, 3> names() {
+    return {{{"p", PidGain::P}, {"i", PidGain::I}, {"d", PidGain::D}}};
+  }
+};
+
+/*! \brief A gain as typed on the shell, "1.25" is stored as the factor times 100, it can't be negative */
+using PidFactor = Decimal<uint32_t, 2>;
+
 /*!
- * \brief Shell command line parser.
+ * \brief Shell command line parser, only for help and status, the commands are typed ones.
  * \param[in] cmd Pointer to command string
  * \param[out] handled If command is handled by the parser
  * \param[in] io Std I/O handler of shell
  */
 uint8_t PID_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io);
+
+
+/*! \brief Writes the configuration and state of the speed PIDs */
+void PID_CmdStatus(IOStream& ioStream);
+
+/*! \brief Sets a gain of the speed PID of a motor, e.g. "pidspeed L p 1.25" */
+void PID_CmdSpeedGain(Side side, PidGain gain, PidFactor factor);
+
+/*! \brief Sets the anti-windup limit of the speed PID of a motor */
+void PID_CmdSpeedWindup(Side side, uint32_t limit);
 #endif
 
 /*!
@@ -38,6 +68,14 @@ void PID_Speed(int32_t currSpeed, int32_t setSpeed, bool isLeft);
  */
 void PID_Pos(int32_t currPos, int32_t setPos, bool isLeft);
 
+/*!
+ * \brief Sets the gains of the speed controller of a motor, e.g. from the binary protocol
+ * \param isLeft TRUE for the left motor, otherwise for the right motor
+ * \param pFactor100 P factor times 100, iFactor100 and dFactor100 alike
+ * \param iAntiWindup limit of the integral part
+ */
+void PID_SetSpeedConfig(bool isLeft, int32_t pFactor100, int32_t iFactor100, int32_t dFactor100, int32_t iAntiWindup);
+
 /*! \brief Driver initialization */
 void PID_Start(void);
 
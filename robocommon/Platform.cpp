@@ -12,7 +12,6 @@
 #include "Keys.h"
 #include "Trigger.h"
 #include "Buzzer.h"
-#include "Debounce.h"
 #include "RTOS.h"
 #include "Reflectance.h"
 #include "Motor.h"
@@ -73,9 +72,6 @@ void PL_Init(void){
 #if PL_HAS_BUZZER
   BUZ_Init();
 #endif
-#if PL_HAS_DEBOUNCE
-  DBNC_Init();
-#endif
 #if PL_HAS_RTOS
   RTOS_Init();
 #endif
@@ -173,9 +169,6 @@ void PL_Deinit(void){
 #if PL_HAS_RTOS
   RTOS_Deinit();
 #endif
-#if PL_HAS_DEBOUNCE
-  DBNC_Deinit();
-#endif
 #if PL_HAS_BUZZER
   BUZ_Init();
 #endif
@@ -28,6 +28,12 @@
 #define PL_HAS_EVENT	(PL_L_HAS_EVENT)
 /*!< Macro is defined in the local platform file */
 
+#define PL_HAS_EVENT_TRACE	(PL_L_HAS_EVENT_TRACE && PL_HAS_EVENT && PL_HAS_DRIVE)
+/*!< Set to 1 to record set/handled events with timestamps, needs TMR_ValueUs() (drive) */
+
+#define PL_HAS_BEHAVIOUR_TRACE	(PL_L_HAS_BEHAVIOUR_TRACE && PL_HAS_DRIVE)
+/*!< Set to 1 to record the behaviour switches and reaction latencies of MainControl, needs TMR_ValueUs() (drive) */
+
 #define PL_HAS_TIMER	(PL_L_HAS_TIMER)
 /*!< Macro is defined in the local platform file */
 
@@ -49,6 +55,9 @@
 #define PL_HAS_TRIGGER        (PL_L_HAS_TRIGGER)
   /*!< Set to 1 for trigger enabled, 0 otherwise */
 
+#define PL_HAS_TRIGGER_STATS  (PL_L_HAS_TRIGGER_STATS && PL_HAS_TRIGGER && PL_HAS_DRIVE)
+  /*!< Set to 1 to measure the execution time of the trigger callbacks, needs TMR_ValueUs() (drive) */
+
 #define PL_HAS_SHELL          (PL_L_HAS_SHELL)
   /*!< Set to 1 for shell enabled, 0 otherwise */
 
@@ -0,0 +1,103 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+
+#include "Assert.h"
+#include "CircularBuffer.h"
+#include "Optional.h"
+
+/**
+ * Fixed capacity queue for messages from several producers (tasks or interrupts) to one consumer.
+ *
+ * Every priority has its own lane of LaneCapacity messages, so a burst of unimportant messages
+ * can't push out the important ones. Within a lane the order of the messages is kept, priority 0
+ * is drained first. Nothing is allocated.
+ *
+ * GlobalLockGuard is held for the few instructions of a push or a drain, with DisableInterrupts
+ * try_push() can be called from interrupts as well.
+ */
+template <typename T, size_t NofPriorities, size_t LaneCapacity, typename GlobalLockGuard>
+class PriorityMessageQueue
+{
+	static_assert(NofPriorities > 0, "at least one priority is needed");
+
+public:
+	/**
+	 * never blocks longer than the lock
+	 * \return false if the lane of the priority is full, the message is dropped then
+	 */
+	bool try_push(size_t priority, const T& message)
+	{
+		ASSERT(priority < NofPriorities);
+		GlobalLockGuard lock;
+		(void)lock;
+		if (lanes[priority].push_n(&message, 1) == 0)
+		{
+			++nofDropped;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * moves up to N messages into messages with a single lock, highest priority (0) first and in
+	 * the order they were pushed within a priority
+	 * \return the amount of messages
+	 */
+	template <size_t N>
+	size_t drain(std::array<T, N>& messages)
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		auto count = size_t{0};
+		for (auto& lane : lanes)
+		{
+			count += lane.pop_n(messages.data() + count, N - count);
+		}
+		return count;
+	}
+
+	//! takes out the next message drain() would return first, for consumers handling one at a time
+	optional<T> try_pop()
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		for (auto& lane : lanes)
+		{
+			auto message = lane.pop_front();
+			if (message)
+			{
+				return message;
+			}
+		}
+		return {};
+	}
+
+	size_t size() const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		auto count = size_t{0};
+		for (auto& lane : lanes)
+		{
+			count += lane.size();
+		}
+		return count;
+	}
+
+	//! messages lost because their lane was full
+	size_t dropped() const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		return nofDropped;
+	}
+
+private:
+	std::array<CircularBuffer<T, LaneCapacity>, NofPriorities> lanes;
+	size_t nofDropped = 0;
+};
@@ -47,6 +47,8 @@ constexpr uint8_t REF_MIN_NOISE_VAL = 0x40;   /* values below this are not added
   //static xSemaphoreHandle REF_StartStopSem = NULL;
 #endif
 
+static volatile bool REF_startStopRequested = FALSE; /* set by REF_StartStopCalibration(), consumed by the state machine */
+
 
 typedef enum {
   REF_STATE_INIT,
@@ -371,6 +373,20 @@ void REF_PrintStatus(IOStream& out)
 //  return ERR_OK;
 //}
 
+void REF_StartStopCalibration(void) {
+  REF_startStopRequested = TRUE;
+}
+
+static bool REF_GetAndResetStartStopRequest(void) {
+  bool requested;
+
+  EnterCritical();
+  requested = REF_startStopRequested;
+  REF_startStopRequested = FALSE;
+  ExitCritical();
+  return requested;
+}
+
 static void REF_StateMachine(void) {
   int i;
   void *p;
@@ -392,7 +408,7 @@ static void REF_StateMachine(void) {
 
   	  case REF_STATE_NOT_CALIBRATED:
   		  REF_MeasureRaw(SensorRaw);
-  		  if (eventQueue.getAndResetEvent(Event::RefStartStopCalibration)) {
+  		  if (REF_GetAndResetStartStopRequest()) {
   			  refState = REF_STATE_START_CALIBRATION;
   		  }
   		  break;
@@ -412,7 +428,7 @@ static void REF_StateMachine(void) {
 #if PL_HAS_BUZZER
   		  (void)BUZ_Beep(300, 20);
 #endif
-  		  if (eventQueue.getAndResetEvent(Event::RefStartStopCalibration)) {
+  		  if (REF_GetAndResetStartStopRequest()) {
   			  refState = REF_STATE_STOP_CALIBRATION;
   		  }
   		  break;
@@ -425,7 +441,7 @@ static void REF_StateMachine(void) {
 
   	  case REF_STATE_READY:
   		  REF_Measure();
-  		  if (eventQueue.getAndResetEvent(Event::RefStartStopCalibration)) {
+  		  if (REF_GetAndResetStartStopRequest()) {
   			  refState = REF_STATE_START_CALIBRATION;
   		  }
   		  break;
@@ -19,6 +19,11 @@ uint16_t REF_GetLineValue(void);
 
 bool REF_SeesLine(void);
 
+/*!
+ * \brief Starts the calibration, or stops it if it is running.
+ */
+void REF_StartStopCalibration(void);
+
 /*!
  * \brief Driver Deinitialization.
  */
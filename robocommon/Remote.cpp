@@ -375,89 +375,67 @@ uint8_t REMOTE_HandleRemoteRxMessage(RAPP_MSG_Type type, uint8_t size, uint8_t *
 }
 
 #if PL_HAS_JOYSTICK
-static void StatusPrintXY(CLS1_ConstStdIOType *io) {
+static void StatusPrintXY(IOStream& ioStream) {
   uint16_t x, y;
   int8_t x8, y8;
-  uint8_t buf[64];
 
   if (APP_GetXY(&x, &y, &x8, &y8)==ERR_OK) {
-    UTIL1_strcpy(buf, sizeof(buf), (unsigned char*)"X: 0x");
-    UTIL1_strcatNum16Hex(buf, sizeof(buf), x);
-    UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"(");
-    UTIL1_strcatNum8s(buf, sizeof(buf), x8);
-    UTIL1_strcat(buf, sizeof(buf), (unsigned char*)") Y: 0x");
-    UTIL1_strcatNum16Hex(buf, sizeof(buf), y);
-    UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"(");
-    UTIL1_strcatNum8s(buf, sizeof(buf), y8);
-    UTIL1_strcat(buf, sizeof(buf), (unsigned char*)")\r\n");
+    ioStream << " analog X: 0x" << numberToHex(x) << "(" << x8 << ") Y: 0x" << numberToHex(y) << "(" << y8 << ")\n";
   } else {
-    UTIL1_strcpy(buf, sizeof(buf), (unsigned char*)"GetXY() failed!\r\n");
+    ioStream << " analog GetXY() failed!\n";
   }
-  CLS1_SendStatusStr((unsigned char*)"  analog", buf, io->stdOut);
 }
 #endif
 
-static void REMOTE_PrintHelp(const CLS1_StdIOType *io) {
-  CLS1_SendHelpStr((unsigned char*)"remote", (unsigned char*)"Group of remote commands\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  help|status", (unsigned char*)"Shows remote help or status\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  on|off", (unsigned char*)"Turns the remote on or off\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  verbose on|off", (unsigned char*)"Turns the verbose mode on or off\r\n", io->stdOut);
+void REMOTE_CmdStatus(IOStream& ioStream) {
+  ioStream << "remote\n";
+  ioStream << " remote " << enumToString(REMOTE_isOn ? OnOff::On : OnOff::Off) << "\n";
+  ioStream << " accel " << enumToString(REMOTE_useAccelerometer ? OnOff::On : OnOff::Off) << "\n";
+  ioStream << " joystick " << enumToString(REMOTE_useJoystick ? OnOff::On : OnOff::Off) << "\n";
+  ioStream << " verbose " << enumToString(REMOTE_isVerbose ? OnOff::On : OnOff::Off) << "\n";
 #if PL_HAS_JOYSTICK
-  CLS1_SendHelpStr((unsigned char*)"  accel on|off", (unsigned char*)"Use accelerometer\r\n", io->stdOut);
-  CLS1_SendHelpStr((unsigned char*)"  joystick on|off", (unsigned char*)"Use joystick\r\n", io->stdOut);
+  StatusPrintXY(ioStream);
 #endif
 }
 
-static void REMOTE_PrintStatus(const CLS1_StdIOType *io) {
-  CLS1_SendStatusStr((unsigned char*)"remote", (unsigned char*)"\r\n", io->stdOut);
-  CLS1_SendStatusStr((unsigned char*)"  remote ", REMOTE_isOn?(unsigned char*)"on\r\n":(unsigned char*)"off\r\n", io->stdOut);
-  CLS1_SendStatusStr((unsigned char*)"  accel ", REMOTE_useAccelerometer?(unsigned char*)"on\r\n":(unsigned char*)"off\r\n", io->stdOut);
-  CLS1_SendStatusStr((unsigned char*)"  joystick ", REMOTE_useJoystick?(unsigned char*)"on\r\n":(unsigned char*)"off\r\n", io->stdOut);
-  CLS1_SendStatusStr((unsigned char*)"  verbose ", REMOTE_isVerbose?(unsigned char*)"on\r\n":(unsigned char*)"off\r\n", io->stdOut);
-#if PL_HAS_JOYSTICK
-  StatusPrintXY(io);
-#endif
+static void REMOTE_PrintHelp(const CLS1_StdIOType *io) {
+  /* not "remote", which is the typed command to turn it on or off */
+  CLS1_SendHelpStr((unsigned char*)"rem", (unsigned char*)"Group of remote commands, set with remote, remverbose, remaccel and remjoy\r\n", io->stdOut);
+  CLS1_SendHelpStr((unsigned char*)"  help|status", (unsigned char*)"Shows remote help or status\r\n", io->stdOut);
 }
 
 uint8_t REMOTE_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io) {
-  uint8_t res = ERR_OK;
-
-  if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_HELP)==0 || UTIL1_strcmp((char*)cmd, (char*)"remote help")==0) {
+  if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_HELP)==0 || UTIL1_strcmp((char*)cmd, (char*)"rem help")==0) {
     REMOTE_PrintHelp(io);
     *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_STATUS)==0 || UTIL1_strcmp((char*)cmd, (char*)"remote status")==0) {
-    REMOTE_PrintStatus(io);
+  } else if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_STATUS)==0 || UTIL1_strcmp((char*)cmd, (char*)"rem status")==0) {
+    LegacyIOStream ioStream(io->stdOut);
+    REMOTE_CmdStatus(ioStream);
     *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote on")==0) {
-    REMOTE_isOn = TRUE;
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote off")==0) {
+  }
+  return ERR_OK;
+}
+
+void REMOTE_CmdOnOff(OnOff onOff) {
+  if (onOff == OnOff::Off) {
 #if PL_HAS_MOTOR
     MOT_SetSpeedPercent(MOT_GetMotorHandle(MOT_MOTOR_LEFT), 0);
     MOT_SetSpeedPercent(MOT_GetMotorHandle(MOT_MOTOR_RIGHT), 0);
 #endif
-    REMOTE_isOn = FALSE;
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote verbose on")==0) {
-    REMOTE_isVerbose = TRUE;
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote verbose off")==0) {
-    REMOTE_isVerbose = FALSE;
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote accel on")==0) {
-    REMOTE_useAccelerometer = TRUE;
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote accel off")==0) {
-    REMOTE_useAccelerometer = FALSE;
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote joystick on")==0) {
-    REMOTE_useJoystick = TRUE;
-    *handled = TRUE;
-  } else if (UTIL1_strcmp((char*)cmd, (char*)"remote joystick off")==0) {
-    REMOTE_useJoystick = FALSE;
-    *handled = TRUE;
   }
-  return res;
+  REMOTE_isOn = (onOff == OnOff::On);
+}
+
+void REMOTE_CmdVerbose(OnOff onOff) {
+  REMOTE_isVerbose = (onOff == OnOff::On);
+}
+
+void REMOTE_CmdAccel(OnOff onOff) {
+  REMOTE_useAccelerometer = (onOff == OnOff::On);
+}
+
+void REMOTE_CmdJoystick(OnOff onOff) {
+  REMOTE_useJoystick = (onOff == OnOff::On);
 }
 
 bool REMOTE_GetOnOff(void) {
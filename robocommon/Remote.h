@@ -10,6 +10,8 @@
 #include "Platform.h"
 #if PL_HAS_REMOTE
 #include "LegacyArgsCommand.h"
+#include <IOStream.h>
+#include <EnumNames.h>
 //#include "CLS1.h"
 extern "C"{
 #include "RApp.h"
@@ -35,14 +37,28 @@ bool REMOTE_GetOnOff(void);
 void REMOTE_SetOnOff(bool on);
 
 /*!
- * \brief Parses a command
- * \param cmd Command string to be parsed
- * \param handled Sets this variable to TRUE if command was handled
- * \param io I/O stream to be used for input/output
- * \return Error code, ERR_OK if everything was fine
+ * \brief Shell command line parser, only for help and status, the commands are typed ones.
+ * \param[in] cmd Pointer to command string
+ * \param[out] handled If command is handled by the parser
+ * \param[in] io Std I/O handler of shell
  */
 uint8_t REMOTE_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io);
 
+/*! \brief Writes the state of the remote and its options */
+void REMOTE_CmdStatus(IOStream& ioStream);
+
+/*! \brief Turns the remote on or off, off stops the motors */
+void REMOTE_CmdOnOff(OnOff onOff);
+
+/*! \brief Turns the verbose mode on or off */
+void REMOTE_CmdVerbose(OnOff onOff);
+
+/*! \brief Turns steering with the accelerometer on or off */
+void REMOTE_CmdAccel(OnOff onOff);
+
+/*! \brief Turns steering with the joystick on or off */
+void REMOTE_CmdJoystick(OnOff onOff);
+
 /*! \brief De-initialization of the module */
 void REMOTE_Deinit(void);
 
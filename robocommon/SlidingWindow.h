@@ -0,0 +1,264 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "Assert.h"
+#include "CircularBuffer.h"
+
+namespace detail
+{
+	/**
+	 * Monotonic deque of (sequence, value) entries. Each value which can't become the extreme
+	 * value of the window anymore is dropped at the back, so the front always is the extreme
+	 * value. Every sample is pushed and dropped at most once, which gives O(1) amortized.
+	 */
+	template <typename T, size_t N, typename Compare>
+	class MonotonicDeque
+	{
+	public:
+		void push(uint32_t sequence, const T& value)
+		{
+			while (count > 0 && !Compare{}(entries[backPos()].value, value))
+			{
+				--count;
+			}
+			ASSERT(count < N);
+			entries[WrapAround<N>::add(frontPos, count)] = Entry{sequence, value};
+			++count;
+		}
+
+		//! the window moves by one sample per push, so only the front can leave the window
+		void evict(uint32_t sequence)
+		{
+			if (count > 0 && entries[frontPos].sequence == sequence)
+			{
+				frontPos = WrapAround<N>::add(frontPos, 1);
+				--count;
+			}
+		}
+
+		const T& front() const
+		{
+			ASSERT(count > 0);
+			return entries[frontPos].value;
+		}
+
+		void clear()
+		{
+			frontPos = 0;
+			count = 0;
+		}
+
+	private:
+		struct Entry
+		{
+			uint32_t sequence;
+			T value;
+		};
+
+		size_t backPos() const
+		{
+			return WrapAround<N>::add(frontPos, count - 1);
+		}
+
+		std::array<Entry, N> entries;
+		size_t frontPos = 0;
+		size_t count = 0;
+	};
+}
+
+/**
+ * Running sum and mean of the window.
+ */
+template <typename T, size_t N>
+class WindowSum
+{
+public:
+	using SumType = decltype(T{} + T{});
+
+	SumType sum() const
+	{
+		return currSum;
+	}
+
+	SumType mean() const
+	{
+		ASSERT(nofSamples > 0);
+		return currSum / static_cast<SumType>(nofSamples);
+	}
+
+protected:
+	void addSample(uint32_t, const T& value)
+	{
+		currSum += value;
+		++nofSamples;
+	}
+
+	void removeSample(uint32_t, const T& value)
+	{
+		currSum -= value;
+		--nofSamples;
+	}
+
+	void clear()
+	{
+		currSum = SumType{};
+		nofSamples = 0;
+	}
+
+private:
+	SumType currSum{};
+	size_t nofSamples = 0;
+};
+
+/**
+ * Running minimum of the window.
+ */
+template <typename T, size_t N>
+class WindowMin
+{
+public:
+	const T& min() const
+	{
+		return deque.front();
+	}
+
+protected:
+	void addSample(uint32_t sequence, const T& value)
+	{
+		deque.push(sequence, value);
+	}
+
+	void removeSample(uint32_t sequence, const T&)
+	{
+		deque.evict(sequence);
+	}
+
+	void clear()
+	{
+		deque.clear();
+	}
+
+private:
+	detail::MonotonicDeque<T, N, std::less<T>> deque;
+};
+
+/**
+ * Running maximum of the window.
+ */
+template <typename T, size_t N>
+class WindowMax
+{
+public:
+	const T& max() const
+	{
+		return deque.front();
+	}
+
+protected:
+	void addSample(uint32_t sequence, const T& value)
+	{
+		deque.push(sequence, value);
+	}
+
+	void removeSample(uint32_t sequence, const T&)
+	{
+		deque.evict(sequence);
+	}
+
+	void clear()
+	{
+		deque.clear();
+	}
+
+private:
+	detail::MonotonicDeque<T, N, std::greater<T>> deque;
+};
+
+/**
+ * Keeps the last N samples and updates the aggregates given by Ops (WindowSum, WindowMin,
+ * WindowMax) in O(1) per pushed sample, so nobody has to rescan the history.
+ *
+ * e.g. SlidingWindow<int32_t, 16, WindowSum, WindowMax> window;
+ *      window.push(value);
+ *      window.mean(); window.max();
+ *
+ * There is no locking, a window shared with an interrupt has to be accessed in a critical section.
+ */
+template <typename T, size_t N, template <typename, size_t> class... Ops>
+class SlidingWindow : public Ops<T, N>...
+{
+	static_assert(N > 0, "window must hold at least one sample");
+
+public:
+	void push(const T& value)
+	{
+		using expander = int[];
+		if (samples.size() == N)
+		{
+			auto evicted = *samples.pop_front();
+			auto evictedSequence = nextSequence - N;
+			(void)evicted;
+			(void)evictedSequence;
+			(void)expander{0, (Ops<T, N>::removeSample(evictedSequence, evicted), 0)...};
+		}
+		samples.push_back(value);
+		(void)expander{0, (Ops<T, N>::addSample(nextSequence, value), 0)...};
+		++nextSequence;
+	}
+
+	size_t size() const
+	{
+		return samples.size();
+	}
+
+	bool full() const
+	{
+		return samples.size() == N;
+	}
+
+	T oldest() const
+	{
+		ASSERT(size() > 0);
+		return *samples.front();
+	}
+
+	T newest() const
+	{
+		ASSERT(size() > 0);
+		return *samples.back();
+	}
+
+	//! newest - oldest sample
+	auto delta() const -> decltype(T{} - T{})
+	{
+		return newest() - oldest();
+	}
+
+	//! max - min, only available with WindowMin and WindowMax
+	template <typename Window = SlidingWindow>
+	auto range() const -> decltype(std::declval<const Window&>().max() - std::declval<const Window&>().min())
+	{
+		return this->max() - this->min();
+	}
+
+	void clear()
+	{
+		using expander = int[];
+		while (samples.pop_front())
+		{
+		}
+		(void)expander{0, (Ops<T, N>::clear(), 0)...};
+	}
+
+private:
+	CircularBuffer<T, N> samples;
+	uint32_t nextSequence = 0;
+};
@@ -139,6 +139,16 @@ private:
 		return size;
 	}
 
+	template <typename T>
+	static uint32_t writeImpl(const WriteCharFn& fnWriteChar, const typename std::enable_if<std::is_same<T, StringSlice>::value, T>::type& slice)
+	{
+		for (auto c : slice)
+		{
+			fnWriteChar(c);
+		}
+		return slice.size();
+	}
+
 	template <typename T>
 	static uint32_t writeImpl(const WriteCharFn& fnWriteChar, const typename std::enable_if<is_stdarray<T>::value, T>::type& arr)
 	{
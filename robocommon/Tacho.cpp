@@ -9,6 +9,7 @@
 #include "Platform.h" /* interface to the platform */
 #if PL_HAS_MOTOR_TACHO
 #include "Tacho.h"    /* our own interface */
+#include "SlidingWindow.h"
 extern "C"{
 #include "Q4CLeft.h"
 #include "Q4CRight.h"
@@ -24,10 +25,8 @@ extern "C"{
 #define NOF_HISTORY (16U+1U) // ? 16U+1U to give the compiler the chance to make shifting instead division
   /*!< number of samples for speed calculation (>0):the more, the better, but the slower. */
 
-static volatile uint16_t TACHO_LeftPosHistory[NOF_HISTORY], TACHO_RightPosHistory[NOF_HISTORY];
-  /*!< for better accuracy, we calculate the speed over some samples */
-static volatile uint8_t TACHO_PosHistory_Index = 0;
-  /*!< position index in history */
+static SlidingWindow<uint16_t, NOF_HISTORY> TACHO_LeftPosHistory, TACHO_RightPosHistory;
+  /*!< for better accuracy, we calculate the speed over some samples, written by TACHO_Sample() from the interrupt */
 
 static int32_t TACHO_currLeftSpeed = 0, TACHO_currRightSpeed = 0;
   /*!< position index in history */
@@ -48,48 +47,20 @@ void TACHO_CalcSpeed(void) {
                        samplePeriod (ms) 
   As this function may be called very frequently, it is important to make it as efficient as possible!
    */
-  int16_t deltaLeft, deltaRight, newLeft, newRight, oldLeft, oldRight;
-  int32_t speedLeft, speedRight;
-  bool negLeft, negRight;
+  int16_t deltaLeft, deltaRight;
 
   EnterCritical();
-  oldLeft = (int16_t)TACHO_LeftPosHistory[TACHO_PosHistory_Index]; /* oldest left entry */
-  oldRight = (int16_t)TACHO_RightPosHistory[TACHO_PosHistory_Index]; /* oldest right entry */
-  if (TACHO_PosHistory_Index==0) { /* get newest entry */
-    newLeft = (int16_t)TACHO_LeftPosHistory[NOF_HISTORY-1];
-    newRight = (int16_t)TACHO_RightPosHistory[NOF_HISTORY-1];
-  } else {
-    newLeft = (int16_t)TACHO_LeftPosHistory[TACHO_PosHistory_Index-1];
-    newRight = (int16_t)TACHO_RightPosHistory[TACHO_PosHistory_Index-1];
+  if (!TACHO_LeftPosHistory.full()) { /* not enough samples yet */
+    ExitCritical();
+    return;
   }
+  /* delta of oldest position and most recent one, the window keeps both without rescanning. The cast handles the counter overflow. */
+  deltaLeft = (int16_t)TACHO_LeftPosHistory.delta();
+  deltaRight = (int16_t)TACHO_RightPosHistory.delta();
   ExitCritical();
-  deltaLeft = oldLeft-newLeft; /* delta of oldest position and most recent one */
-  /* use unsigned arithmetic */
-  if (deltaLeft < 0) {
-    deltaLeft = -deltaLeft;
-    negLeft = TRUE;
-  } else {
-    negLeft = FALSE;
-  }
-  deltaRight = oldRight-newRight; /* delta of oldest position and most recent one */
-  /* use unsigned arithmetic */
-  if (deltaRight < 0) {
-    deltaRight = -deltaRight;
-    negRight = TRUE;
-  } else {
-    negRight = FALSE;
-  }
   /* calculate speed. this is based on the delta and the time (number of samples or entries in the history table) */
-  speedLeft = (int32_t)(deltaLeft * 1000/(TACHO_SAMPLE_PERIOD_MS*(NOF_HISTORY-1)));
-  if (negLeft) {
-    speedLeft = -speedLeft;
-  }
-  speedRight = (int32_t)(deltaRight * 1000/(TACHO_SAMPLE_PERIOD_MS*(NOF_HISTORY-1)));
-  if (negRight) {
-    speedRight = -speedRight;
-  }
-  TACHO_currLeftSpeed = -speedLeft; /* store current speed in global variable */
-  TACHO_currRightSpeed = -speedRight; /* store current speed in global variable */
+  TACHO_currLeftSpeed = (int32_t)deltaLeft*1000/(TACHO_SAMPLE_PERIOD_MS*(NOF_HISTORY-1)); /* store current speed in global variable */
+  TACHO_currRightSpeed = (int32_t)deltaRight*1000/(TACHO_SAMPLE_PERIOD_MS*(NOF_HISTORY-1)); /* store current speed in global variable */
 }
 
 void TACHO_Sample(void) {
@@ -102,12 +73,8 @@ void TACHO_Sample(void) {
   }
   cnt = 0; /* reset counter */
   /* left */
-  TACHO_LeftPosHistory[TACHO_PosHistory_Index] = Q4CLeft_GetPos();
-  TACHO_RightPosHistory[TACHO_PosHistory_Index] = Q4CRight_GetPos();
-  TACHO_PosHistory_Index++;
-  if (TACHO_PosHistory_Index >= NOF_HISTORY) {
-    TACHO_PosHistory_Index = 0;
-  }
+  TACHO_LeftPosHistory.push(Q4CLeft_GetPos());
+  TACHO_RightPosHistory.push(Q4CRight_GetPos());
 }
 
 #if PL_HAS_SHELL
@@ -166,7 +133,10 @@ void TACHO_Deinit(void) {
 void TACHO_Init(void) {
   TACHO_currLeftSpeed = 0;
   TACHO_currRightSpeed = 0;
-  TACHO_PosHistory_Index = 0;
+  EnterCritical();
+  TACHO_LeftPosHistory.clear();
+  TACHO_RightPosHistory.clear();
+  ExitCritical();
 }
 
 #endif /* PL_HAS_MOTOR_TACHO */
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+/**
+ * EventQueue notifier which wakes the waiting task with a FreeRTOS task notification.
+ * notify() can be called from tasks and from interrupts.
+ */
+class TaskNotifier
+{
+public:
+	void notify()
+	{
+		auto task = waitingTask;
+		if (task == nullptr)
+		{
+			return; //nobody waits yet, waitUntil() will see the event
+		}
+		if (isInsideInterrupt())
+		{
+			BaseType_t higherPriorityTaskWoken = pdFALSE;
+			vTaskNotifyGiveFromISR(task, &higherPriorityTaskWoken);
+			portYIELD_FROM_ISR(higherPriorityTaskWoken);
+		}
+		else
+		{
+			xTaskNotifyGive(task);
+		}
+	}
+
+	template <typename Predicate>
+	void waitUntil(Predicate ready)
+	{
+		//register first, so a notify() between the check and the take is not lost
+		waitingTask = xTaskGetCurrentTaskHandle();
+		while (!ready())
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+	}
+
+private:
+	static bool isInsideInterrupt()
+	{
+		uint32_t ipsr;
+		__asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+		return ipsr != 0;
+	}
+
+	TaskHandle_t volatile waitingTask = nullptr;
+};
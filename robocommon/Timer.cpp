@@ -60,6 +60,40 @@ uint32_t TMR_ValueMs()
 {
 	return counter.load();
 }
+
+#define TMR_SYST_RVR		(0xE000E014u)
+/*!< SysTick reload value register */
+#define TMR_SYST_CVR		(0xE000E018u)
+/*!< SysTick current value register, counts down to zero every tick */
+#define TMR_SCB_ICSR		(0xE000ED04u)
+/*!< interrupt control and state register */
+#define TMR_ICSR_PENDSTSET	(1u << 26)
+/*!< the SysTick interrupt is pending */
+
+static uint32_t TMR_ReadRegister(uint32_t address)
+{
+	return *reinterpret_cast<volatile uint32_t*>(address);
+}
+
+uint32_t TMR_ValueUs()
+{
+	uint32_t ms, reload, current, pendingMs;
+	do //read again if the tick happened in between
+	{
+		ms = TMR_ValueMs();
+		reload = TMR_ReadRegister(TMR_SYST_RVR);
+		current = TMR_ReadRegister(TMR_SYST_CVR);
+		pendingMs = 0;
+		/* with interrupts disabled (under a lock, in an ISR) the tick can't advance ms, but CVR reloads:
+		 * if the tick is pending, CVR wrapped, read it again after the wrap and add the missing period */
+		if ((TMR_ReadRegister(TMR_SCB_ICSR) & TMR_ICSR_PENDSTSET) != 0)
+		{
+			current = TMR_ReadRegister(TMR_SYST_CVR);
+			pendingMs = TMR_TICK_MS;
+		}
+	} while (ms != TMR_ValueMs());
+	return (ms + pendingMs) * 1000 + (reload - current) * 1000 / (reload + 1);
+}
 #endif
 
 /*! \brief Timer driver initialization */
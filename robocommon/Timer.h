@@ -20,6 +20,9 @@ void TMR_OnInterrupt(void);
 
 uint32_t TMR_ValueMs();
 
+/*! \brief Microseconds since startup: TMR_ValueMs() plus the elapsed part of the current SysTick period */
+uint32_t TMR_ValueUs();
+
 /*! \brief Timer driver initialization */
 void TMR_Init(void);
 
@@ -0,0 +1,193 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+#include <cstdint>
+
+#include "Assert.h"
+
+/**
+ * Entry of a TimerWheel. It lives wherever the owner puts it (usually a static array),
+ * the wheel only links it into its slots.
+ */
+struct TimerWheelEntry
+{
+	using Callback = void (*)(void*);
+
+	TimerWheelEntry* pNext = nullptr;
+	TimerWheelEntry** ppPrevNext = nullptr; //!< the pointer pointing to this entry, for O(1) unlinking
+	uint32_t expires = 0;
+	Callback callback = nullptr;
+	void* pData = nullptr;
+	bool scheduled = false;
+};
+
+/**
+ * Hierarchical timer wheel: NofLevels levels of 2^SlotBits slots, each slot a list of entries.
+ * Level 0 has one slot per tick, level n one slot per 2^(n * SlotBits) ticks. An entry is put into
+ * the level matching its delay and moved down a level when the wheel reaches its slot, so tick()
+ * only touches the slot which expires (and every 2^SlotBits ticks the one to cascade), no matter
+ * how many entries are scheduled. Delays up to 2^(NofLevels * SlotBits) - 1 ticks are supported.
+ *
+ * GlobalLockGuard is held while the lists are changed, never while a callback runs. Callbacks are
+ * called from tick() and may schedule entries again, an entry scheduled with a delay of 0 from
+ * a callback fires within the same tick.
+ */
+template <size_t SlotBits, size_t NofLevels, typename GlobalLockGuard>
+class TimerWheel
+{
+	static_assert(SlotBits * NofLevels <= 32, "the tick counter has 32 bits");
+
+public:
+	static constexpr size_t NofSlots = size_t{1} << SlotBits;
+	static constexpr uint32_t MaxDelay = static_cast<uint32_t>((uint64_t{1} << (SlotBits * NofLevels)) - 1);
+
+	/**
+	 * (re)schedules entry to call callback(pData) after delay ticks. An entry which is still
+	 * scheduled is moved. A delay of 0 fires at the next tick, or within the current tick if
+	 * called from a callback.
+	 */
+	void schedule(TimerWheelEntry& entry, uint32_t delay, TimerWheelEntry::Callback callback, void* pData)
+	{
+		ASSERT(delay <= MaxDelay);
+		GlobalLockGuard lock;
+		(void)lock;
+		if (entry.scheduled)
+		{
+			unlink(entry);
+		}
+		if (delay == 0 && !ticking)
+		{
+			delay = 1;
+		}
+		entry.expires = now + delay;
+		entry.callback = callback;
+		entry.pData = pData;
+		entry.scheduled = true;
+		insert(entry);
+	}
+
+	void cancel(TimerWheelEntry& entry)
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		if (entry.scheduled)
+		{
+			unlink(entry);
+			entry.scheduled = false;
+		}
+	}
+
+	bool isScheduled(const TimerWheelEntry& entry) const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		return entry.scheduled;
+	}
+
+	/**
+	 * advances the wheel by one tick and calls the callbacks of all entries expiring now
+	 */
+	void tick()
+	{
+		{
+			GlobalLockGuard lock;
+			(void)lock;
+			++now;
+			ticking = true;
+			for (auto level = size_t{1}; level < NofLevels && (now & ((uint32_t{1} << (level * SlotBits)) - 1)) == 0; ++level)
+			{
+				cascade(level);
+			}
+		}
+
+		auto& slot = slots[0][now & (NofSlots - 1)];
+		for (;;)
+		{
+			TimerWheelEntry::Callback callback;
+			void* pData;
+			{
+				GlobalLockGuard lock;
+				(void)lock;
+				auto pEntry = slot;
+				if (pEntry == nullptr)
+				{
+					ticking = false;
+					return;
+				}
+				unlink(*pEntry);
+				pEntry->scheduled = false;
+				callback = pEntry->callback;
+				pData = pEntry->pData;
+			}
+			callback(pData);
+		}
+	}
+
+	//! ticks since construction
+	uint32_t ticks() const
+	{
+		GlobalLockGuard lock;
+		(void)lock;
+		return now;
+	}
+
+private:
+	using Slot = TimerWheelEntry*;
+
+	void insert(TimerWheelEntry& entry)
+	{
+		uint32_t delay = entry.expires - now;
+		auto level = size_t{0};
+		while (level + 1 < NofLevels && delay >= (uint32_t{1} << ((level + 1) * SlotBits)))
+		{
+			++level;
+		}
+		auto& slot = slots[level][(entry.expires >> (level * SlotBits)) & (NofSlots - 1)];
+		entry.ppPrevNext = &slot;
+		entry.pNext = slot;
+		if (slot != nullptr)
+		{
+			slot->ppPrevNext = &entry.pNext;
+		}
+		slot = &entry;
+	}
+
+	void unlink(TimerWheelEntry& entry)
+	{
+		*entry.ppPrevNext = entry.pNext;
+		if (entry.pNext != nullptr)
+		{
+			entry.pNext->ppPrevNext = entry.ppPrevNext;
+		}
+		entry.pNext = nullptr;
+		entry.ppPrevNext = nullptr;
+	}
+
+	//! moves the entries of the current slot of level to the levels below
+	void cascade(size_t level)
+	{
+		auto& slot = slots[level][(now >> (level * SlotBits)) & (NofSlots - 1)];
+		auto pEntry = slot;
+		slot = nullptr;
+		while (pEntry != nullptr)
+		{
+			auto pNext = pEntry->pNext;
+			insert(*pEntry);
+			pEntry = pNext;
+		}
+	}
+
+	std::array<std::array<Slot, NofSlots>, NofLevels> slots{};
+	uint32_t now = 0;
+	bool ticking = false;
+};
+
+template <size_t SlotBits, size_t NofLevels, typename GlobalLockGuard>
+constexpr size_t TimerWheel<SlotBits, NofLevels, GlobalLockGuard>::NofSlots;
+
+template <size_t SlotBits, size_t NofLevels, typename GlobalLockGuard>
+constexpr uint32_t TimerWheel<SlotBits, NofLevels, GlobalLockGuard>::MaxDelay;
@@ -10,75 +10,249 @@
 #if PL_HAS_TRIGGER
 #include "Trigger.h"
 #include "Cpu.h"
-#include "CS1.h"
-#include <stddef.h> /* for NULL */
+#include "CriticalSection.h"
+#include "TimerWheel.h"
+#include <array>
+#if PL_HAS_RTOS
+  #include "FRTOS1.h"
+  #include "PriorityMessageQueue.h"
+  #include "TaskNotifier.h"
+#endif
+extern "C"
+{
+#include "UTIL1.h"
+}
+
+#define TRG_NOF_HANDLES  (TRG_NOF_TRIGGERS + TRG_NOF_DYNAMIC_TRIGGERS)
+  /*!< The fixed triggers first, then the pool */
+
+static_assert(TRG_NOF_HANDLES < TRG_INVALID_HANDLE, "too many triggers for TRG_Handle");
 
 /*! \brief Descriptor for a trigger. */
 typedef struct TRG_TriggerDesc {
-  TRG_TriggerTime ticks;    /*!< tick count until trigger */
+  TimerWheelEntry entry;    /*!< position in the timer wheel */
   TRG_Callback callback;    /*!< callback function */
   TRG_CallBackDataPtr data; /*!< additional data pointer for callback */
+  TRG_Mode mode;            /*!< where the callback runs */
+#if PL_HAS_TRIGGER_STATS
+  TRG_CallbackStats stats;  /*!< execution times of the callback */
+#endif
 } TRG_TriggerDesc;
 
-static TRG_TriggerDesc TRG_Triggers[TRG_NOF_TRIGGERS];  /*!< Array of triggers */
+/*! 4 levels of 16 slots cover every TRG_TriggerTime, TRG_IncTick touches one slot per tick */
+static TimerWheel<4, 4, DisableInterrupts> TRG_Wheel;
+static_assert(decltype(TRG_Wheel)::MaxDelay >= UINT16_MAX, "the wheel must cover TRG_TriggerTime");
 
-TRG_TriggerKind operator ++(TRG_TriggerKind &id)
-{
-   id = static_cast<TRG_TriggerKind>( id + 1 );
-   return id;
-}
+static std::array<TRG_TriggerDesc, TRG_NOF_HANDLES> TRG_Triggers;  /*!< Array of triggers */
+static std::array<bool, TRG_NOF_DYNAMIC_TRIGGERS> TRG_Allocated; /*!< Pool state of the dynamic triggers */
 
-uint8_t TRG_SetTrigger(TRG_TriggerKind trigger, TRG_TriggerTime ticks, TRG_Callback callback, TRG_CallBackDataPtr data) {
-  CS1_CriticalVariable()
+#if PL_HAS_RTOS
+/*! \brief A callback which expired in TRG_IncTick, waiting for the daemon task */
+typedef struct TRG_DeferredCall {
+  TRG_Handle handle;
+  TRG_Callback callback;
+  TRG_CallBackDataPtr data;
+} TRG_DeferredCall;
 
-  CS1_EnterCritical();
-  TRG_Triggers[trigger].ticks = ticks;
-  TRG_Triggers[trigger].callback = callback;
-  TRG_Triggers[trigger].data = data;
-  CS1_ExitCritical();
-  return ERR_OK;
+static PriorityMessageQueue<TRG_DeferredCall, 1, TRG_NOF_DEFERRED_CALLS, DisableInterrupts> TRG_DeferredCalls;
+static TaskNotifier TRG_DaemonNotifier;
+static TaskHandle_t TRG_DaemonTaskHandle = NULL;
+static bool TRG_HasNewDeferredCalls = FALSE; /*!< only accessed in TRG_IncTick, the daemon is woken once per tick */
+#endif
+
+/*!
+ * \brief Calls the callback, measuring its execution time.
+ */
+static void TRG_Run(TRG_Handle handle, TRG_Callback callback, TRG_CallBackDataPtr data) {
+#if PL_HAS_TRIGGER_STATS
+  uint32_t startUs = TMR_ValueUs();
+  callback(data);
+  uint32_t durationUs = TMR_ValueUs()-startUs;
+
+  DisableInterrupts lock;
+  (void)lock;
+  TRG_CallbackStats &stats = TRG_Triggers[handle].stats;
+  stats.count++;
+  stats.totalUs += durationUs;
+  if (durationUs>stats.maxUs) {
+    stats.maxUs = durationUs;
+  }
+#else
+  (void)handle;
+  callback(data);
+#endif
 }
 
 /*!
- * \brief Goes through the list of triggers and returns TRUE in case we have to call a callback.
- * \return Returns TRUE if we have called a callback.
+ * \brief Called by the timer wheel when a trigger expires, runs or defers its callback.
  */
-static bool CheckCallbacks(void) {
-  TRG_TriggerKind i;
+static void TRG_Fire(void *descPtr) {
+  TRG_TriggerDesc *desc = static_cast<TRG_TriggerDesc*>(descPtr);
+  TRG_Handle handle = static_cast<TRG_Handle>(desc-TRG_Triggers.data());
   TRG_Callback callback;
   TRG_CallBackDataPtr data;
-  bool calledCallBack = FALSE;
-  CS1_CriticalVariable()
-
-  for(i=(TRG_TriggerKind)0;i<TRG_NOF_TRIGGERS;++i) {
-    CS1_EnterCritical();
-    if (TRG_Triggers[i].ticks==0 && TRG_Triggers[i].callback != NULL) { /* trigger! */
-      callback = TRG_Triggers[i].callback; /* get a copy */
-      data = TRG_Triggers[i].data; /* get backup of data, as we overwrite it below */
-      /* reset trigger structure, as callback might setup this trigger again */
-      TRG_Triggers[i].callback = NULL; /* NULL callback prevents that we are called again */
-      CS1_ExitCritical();
-      callback(data);
-      calledCallBack = TRUE; /* callback may have set a trigger at the current time: rescan trigger list */
-    } else {
-      CS1_ExitCritical();
+  TRG_Mode mode;
+
+  {
+    DisableInterrupts lock; /* get a copy, the callback might set up this trigger again */
+    (void)lock;
+    callback = desc->callback;
+    data = desc->data;
+    mode = desc->mode;
+  }
+#if PL_HAS_RTOS
+  if (mode==TRG_MODE_DEFERRED) {
+    (void)TRG_DeferredCalls.try_push(0, TRG_DeferredCall{handle, callback, data}); /* counted in dropped() if the daemon falls behind */
+    TRG_HasNewDeferredCalls = TRUE;
+    return;
+  }
+#else
+  (void)mode;
+#endif
+  TRG_Run(handle, callback, data);
+}
+
+#if PL_HAS_RTOS
+/*!
+ * \brief Runs the deferred callbacks, all which expired since it ran the last time at once.
+ */
+static portTASK_FUNCTION(TRG_DaemonTask, pvParameters) {
+  static std::array<TRG_DeferredCall, TRG_NOF_DEFERRED_CALLS> calls;
+
+  (void)pvParameters;
+  for(;;) {
+    TRG_DaemonNotifier.waitUntil([]{ return TRG_DeferredCalls.size()!=0; });
+    size_t count = TRG_DeferredCalls.drain(calls);
+    for(size_t i=0;i<count;++i) {
+      TRG_Run(calls[i].handle, calls[i].callback, calls[i].data);
     }
-  } /* for */
-  return calledCallBack;
+  }
+}
+#endif
+
+TRG_Handle TRG_AllocTrigger(void) {
+  DisableInterrupts lock;
+  (void)lock;
+  for(size_t i=0;i<TRG_Allocated.size();++i) {
+    if (!TRG_Allocated[i]) {
+      TRG_Allocated[i] = true;
+      TRG_Triggers[TRG_NOF_TRIGGERS+i].mode = TRG_MODE_ISR;
+      return static_cast<TRG_Handle>(TRG_NOF_TRIGGERS + i);
+    }
+  }
+  return TRG_INVALID_HANDLE;
+}
+
+void TRG_FreeTrigger(TRG_Handle handle) {
+  if (handle<TRG_NOF_TRIGGERS || handle>=TRG_NOF_HANDLES) {
+    return;
+  }
+  TRG_CancelTrigger(handle);
+  DisableInterrupts lock;
+  (void)lock;
+  TRG_Allocated[handle-TRG_NOF_TRIGGERS] = false;
 }
 
+uint8_t TRG_SetHandleTrigger(TRG_Handle handle, TRG_TriggerTime ticks, TRG_Callback callback, TRG_CallBackDataPtr data) {
+  if (handle>=TRG_NOF_HANDLES) {
+    return ERR_FAILED;
+  }
+  TRG_TriggerDesc &desc = TRG_Triggers[handle];
+  DisableInterrupts lock;
+  (void)lock;
+  desc.callback = callback;
+  desc.data = data;
+  TRG_Wheel.schedule(desc.entry, ticks, TRG_Fire, &desc);
+  return ERR_OK;
+}
+
+uint8_t TRG_SetTrigger(TRG_TriggerKind trigger, TRG_TriggerTime ticks, TRG_Callback callback, TRG_CallBackDataPtr data) {
+  return TRG_SetHandleTrigger(static_cast<TRG_Handle>(trigger), ticks, callback, data);
+}
+
+void TRG_CancelTrigger(TRG_Handle handle) {
+  if (handle<TRG_NOF_HANDLES) {
+    TRG_Wheel.cancel(TRG_Triggers[handle].entry);
+  }
+}
+
+void TRG_SetMode(TRG_Handle handle, TRG_Mode mode) {
+  if (handle<TRG_NOF_HANDLES) {
+    DisableInterrupts lock;
+    (void)lock;
+    TRG_Triggers[handle].mode = mode;
+  }
+}
+
+#if PL_HAS_TRIGGER_STATS
+TRG_CallbackStats TRG_GetStats(TRG_Handle handle) {
+  TRG_CallbackStats stats = {0, 0, 0};
+
+  if (handle<TRG_NOF_HANDLES) {
+    DisableInterrupts lock;
+    (void)lock;
+    stats = TRG_Triggers[handle].stats;
+  }
+  return stats;
+}
+#endif
+
 void TRG_IncTick(void) {
-  TRG_TriggerKind i;
-  CS1_CriticalVariable()
+  TRG_Wheel.tick(); /* calls the expired callbacks, including the ones they set again for the current tick */
+#if PL_HAS_RTOS
+  if (TRG_HasNewDeferredCalls) {
+    TRG_HasNewDeferredCalls = FALSE;
+    TRG_DaemonNotifier.notify();
+  }
+#endif
+}
+
+static uint8_t TRG_PrintHelp(const CLS1_StdIOType *io) {
+  CLS1_SendHelpStr((unsigned char*)"trigger", (unsigned char*)"Group of trigger commands\n", io->stdOut);
+  CLS1_SendHelpStr((unsigned char*)"  help|status", (unsigned char*)"Shows trigger help or the mode and callback times per trigger\n", io->stdOut);
+  return ERR_OK;
+}
 
-  CS1_EnterCritical();
-  for(i=(TRG_TriggerKind)0;i<TRG_NOF_TRIGGERS;++i) {
-    if (TRG_Triggers[i].ticks!=0) { /* prevent underflow */
-      TRG_Triggers[i].ticks--;
+static uint8_t TRG_PrintStatus(const CLS1_StdIOType *io) {
+  CLS1_SendStatusStr((unsigned char*)"trigger", (unsigned char*)"\r\n", io->stdOut);
+  for(TRG_Handle i=0;i<TRG_NOF_HANDLES;++i) {
+    if (i>=TRG_NOF_TRIGGERS && !TRG_Allocated[i-TRG_NOF_TRIGGERS]) {
+      continue;
     }
-  } /* for */
-  CS1_ExitCritical();
-  while(CheckCallbacks()) {} /* while we have callbacks, re-iterate the list as this may have added new triggers at the current time */
+    unsigned char buf[16];
+    buf[0] = '\0';
+    UTIL1_strcat(buf, sizeof(buf), (unsigned char*)"  ");
+    UTIL1_strcatNum8u(buf, sizeof(buf), i);
+    UTIL1_strcat(buf, sizeof(buf), (unsigned char*)" : ");
+    CLS1_SendStatusStr(buf, TRG_Triggers[i].mode==TRG_MODE_DEFERRED ? (unsigned char*)"deferred" : (unsigned char*)"isr", io->stdOut);
+#if PL_HAS_TRIGGER_STATS
+    TRG_CallbackStats stats = TRG_GetStats(i);
+    CLS1_SendStr((unsigned char*)", calls ", io->stdOut);
+    CLS1_SendNum32u(stats.count, io->stdOut);
+    CLS1_SendStr((unsigned char*)", avg us ", io->stdOut);
+    CLS1_SendNum32u(stats.count==0 ? 0 : stats.totalUs/stats.count, io->stdOut);
+    CLS1_SendStr((unsigned char*)", max us ", io->stdOut);
+    CLS1_SendNum32u(stats.maxUs, io->stdOut);
+#endif
+    CLS1_SendStr((unsigned char*)"\r\n", io->stdOut);
+  }
+#if PL_HAS_RTOS
+  CLS1_SendStatusStr((unsigned char*)"  dropped", (unsigned char*)"", io->stdOut);
+  CLS1_SendNum32u(TRG_DeferredCalls.dropped(), io->stdOut);
+  CLS1_SendStr((unsigned char*)" deferred calls\r\n", io->stdOut);
+#endif
+  return ERR_OK;
+}
+
+uint8_t TRG_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io) {
+  if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_HELP)==0 || UTIL1_strcmp((char*)cmd, (char*)"trigger help")==0) {
+    *handled = TRUE;
+    return TRG_PrintHelp(io);
+  } else if (UTIL1_strcmp((char*)cmd, (char*)CLS1_CMD_STATUS)==0 || UTIL1_strcmp((char*)cmd, (char*)"trigger status")==0) {
+    *handled = TRUE;
+    return TRG_PrintStatus(io);
+  }
+  return ERR_OK;
 }
 
 void TRG_Deinit(void) {
@@ -86,13 +260,22 @@ void TRG_Deinit(void) {
 }
 
 void TRG_Init(void) {
-  TRG_TriggerKind i;
-
-  for(i=(TRG_TriggerKind)0;i<TRG_NOF_TRIGGERS;++i) {
-    TRG_Triggers[i].ticks = 0;
-    TRG_Triggers[i].callback = NULL;
-    TRG_Triggers[i].data = NULL;
+  for(TRG_Handle i=0;i<TRG_NOF_HANDLES;++i) {
+    TRG_Wheel.cancel(TRG_Triggers[i].entry);
+    TRG_Triggers[i].mode = TRG_MODE_ISR;
+#if PL_HAS_TRIGGER_STATS
+    TRG_Triggers[i].stats = TRG_CallbackStats{0, 0, 0};
+#endif
+  }
+  TRG_Allocated.fill(false);
+#if PL_HAS_RTOS
+  TRG_SetMode(TRG_BUZ_BEEP, TRG_MODE_DEFERRED); /* toggling the buzzer doesn't need to run in the interrupt */
+  if (TRG_DaemonTaskHandle==NULL) {
+    if (FRTOS1_xTaskCreate(TRG_DaemonTask, "TrgDaemon", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES-1, &TRG_DaemonTaskHandle) != pdPASS) {
+      ASSERT(false); /* error */
+    }
   }
+#endif
 }
 
 #endif /* PL_HAS_TRIGGER */
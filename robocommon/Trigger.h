@@ -12,6 +12,7 @@
 
 #include "Platform.h"
 #include "Timer.h"
+#include <LegacyArgsCommand.h>
 
 #define TRG_TICKS_MS  TMR_TICK_MS
   /*!< Defines the period at which TRG_IncTick gets called */
@@ -20,7 +21,6 @@
 typedef enum {
   /*! \todo Extend the list of triggers as needed */
 	TRG_BUZ_BEEP, /*!< Buzzer beep */
-	TRG_KEYPRESS, /*!< key debounce */
 	TRG_NOF_TRIGGERS /*!< Must be last! */
 } TRG_TriggerKind;
 
@@ -33,6 +33,37 @@ typedef void (*TRG_Callback)(TRG_CallBackDataPtr);
 /*! \brief Type to hold the trigger ticks */
 typedef uint16_t TRG_TriggerTime;
 
+/*! \brief Handle of a trigger: a TRG_TriggerKind or a handle from TRG_AllocTrigger() */
+typedef uint8_t TRG_Handle;
+
+#define TRG_INVALID_HANDLE  ((TRG_Handle)0xFF)
+  /*!< Returned by TRG_AllocTrigger if the pool is exhausted */
+
+/*! \brief Where the callback of a trigger runs */
+typedef enum {
+  TRG_MODE_ISR,     /*!< directly in TRG_IncTick, for short callbacks which need the exact time (default) */
+  TRG_MODE_DEFERRED /*!< in the trigger daemon task, keeps the tick interrupt short */
+} TRG_Mode;
+
+#if PL_HAS_TRIGGER_STATS
+/*! \brief Execution times of the callbacks of a trigger */
+typedef struct {
+  uint32_t count;   /*!< number of calls */
+  uint32_t totalUs; /*!< sum of the execution times */
+  uint32_t maxUs;   /*!< longest execution time */
+} TRG_CallbackStats;
+#endif
+
+#ifndef TRG_NOF_DYNAMIC_TRIGGERS
+  #define TRG_NOF_DYNAMIC_TRIGGERS  8
+  /*!< Size of the pool for TRG_AllocTrigger */
+#endif
+
+#ifndef TRG_NOF_DEFERRED_CALLS
+  #define TRG_NOF_DEFERRED_CALLS  8
+  /*!< Deferred callbacks which can wait for the daemon task, more are dropped */
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +78,58 @@ extern "C" {
  */
 uint8_t TRG_SetTrigger(TRG_TriggerKind trigger, TRG_TriggerTime ticks, TRG_Callback callback, TRG_CallBackDataPtr data);
 
+/*!
+ * \brief Takes a trigger from the static pool
+ * \return the handle, TRG_INVALID_HANDLE if all are in use
+ */
+TRG_Handle TRG_AllocTrigger(void);
+
+/*!
+ * \brief Cancels the trigger and gives it back to the pool
+ * \param handle Handle from TRG_AllocTrigger
+ */
+void TRG_FreeTrigger(TRG_Handle handle);
+
+/*!
+ * \brief Sets a trigger by handle, same as TRG_SetTrigger
+ * \param handle A TRG_TriggerKind or a handle from TRG_AllocTrigger
+ * \param ticks Trigger time in ticks. The time is relative from the current time.
+ * \param callback Callback to be called when the trigger fires
+ * \param data Optional pointer to data
+ * \return error code, ERR_OK if everything is fine
+ */
+uint8_t TRG_SetHandleTrigger(TRG_Handle handle, TRG_TriggerTime ticks, TRG_Callback callback, TRG_CallBackDataPtr data);
+
+/*!
+ * \brief Cancels a trigger, its callback won't be called
+ * \param handle A TRG_TriggerKind or a handle from TRG_AllocTrigger
+ */
+void TRG_CancelTrigger(TRG_Handle handle);
+
+/*!
+ * \brief Selects where the callback of a trigger runs, TRG_MODE_ISR after TRG_Init and TRG_AllocTrigger
+ * \param handle A TRG_TriggerKind or a handle from TRG_AllocTrigger
+ * \param mode TRG_MODE_DEFERRED needs the RTOS, otherwise the callback keeps running in the interrupt
+ */
+void TRG_SetMode(TRG_Handle handle, TRG_Mode mode);
+
+#if PL_HAS_TRIGGER_STATS
+/*!
+ * \brief Returns the execution times of the callbacks of a trigger since TRG_Init
+ * \param handle A TRG_TriggerKind or a handle from TRG_AllocTrigger
+ */
+TRG_CallbackStats TRG_GetStats(TRG_Handle handle);
+#endif
+
+/*!
+ * \brief Shell parser routine.
+ * \param cmd Pointer to command line string.
+ * \param handled Pointer to status if command has been handled. Set to TRUE if command was understood.
+ * \param io Pointer to stdio handle
+ * \return Error code, ERR_OK if everything was ok.
+ */
+uint8_t TRG_ParseCommand(const unsigned char *cmd, bool *handled, const CLS1_StdIOType *io);
+
 /*! \brief Called from interrupt service routine with a period of TRG_TICKS_MS. */
 void TRG_IncTick(void);
 
@@ -0,0 +1,191 @@
+#pragma once
+
+#ifndef __cplusplus
+#error sorry, this header is c++ only
+#endif
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "CommonTraits.h"
+
+enum class KeyEdge : uint8_t
+{
+	Pressed,		//!< debounced key down
+	LongPressed,	//!< held for the long press time
+	Released,		//!< released before the long press time
+	ReleasedLong,	//!< released after a long press
+	Chord			//!< all keys of the mask held, see KeyEventMapper
+};
+
+/**
+ * Result of one sample of VerticalCounterDebouncer, one bit per key
+ */
+struct KeyEdges
+{
+	uint8_t held = 0; //!< debounced state, not an edge
+	uint8_t pressed = 0;
+	uint8_t longPressed = 0;
+	uint8_t released = 0;
+	uint8_t releasedLong = 0;
+
+	uint8_t of(KeyEdge edge) const
+	{
+		switch (edge)
+		{
+		case KeyEdge::Pressed: return pressed;
+		case KeyEdge::LongPressed: return longPressed;
+		case KeyEdge::Released: return released;
+		case KeyEdge::ReleasedLong: return releasedLong;
+		case KeyEdge::Chord: return 0;
+		}
+		return 0;
+	}
+};
+
+namespace detail
+{
+	constexpr size_t bitWidth(size_t value)
+	{
+		return value == 0 ? 0 : 1 + bitWidth(value >> 1);
+	}
+}
+
+/**
+ * Debounces 8 keys at once with vertical counters: bit n of every counter plane belongs to key n,
+ * so a sample costs a handful of bitwise operations no matter how many keys bounce.
+ *
+ * A key changes its debounced state after 4 equal samples, which differ from the current state.
+ * While held, a second vertical counter counts the samples up to LongPressSamples.
+ * sample() has to be called periodically, the period defines the debounce and long press time.
+ */
+template <uint8_t LongPressSamples>
+class VerticalCounterDebouncer
+{
+	static_assert(LongPressSamples > 0, "a long press needs at least one sample");
+	static constexpr size_t NofHoldPlanes = detail::bitWidth(LongPressSamples);
+
+public:
+	/**
+	 * \param raw bit n is set if key n is pressed right now
+	 */
+	KeyEdges sample(uint8_t raw)
+	{
+		//2 bit counter per key, counting down the samples which differ from the state, reset by an equal one
+		uint8_t changed = raw ^ state;
+		count0 = ~(count0 & changed);
+		count1 = count0 ^ (count1 & changed);
+		uint8_t toggled = changed & count0 & count1;
+		state ^= toggled;
+
+		KeyEdges edges;
+		edges.held = state;
+		edges.pressed = toggled & state;
+		uint8_t released = toggled & ~state;
+		edges.released = released & ~longPressed;
+		edges.releasedLong = released & longPressed;
+		longPressed &= state;
+
+		//hold counter: increment the keys which are held and not long pressed yet, clear the others
+		uint8_t counting = state & ~longPressed;
+		uint8_t carry = counting;
+		uint8_t reached = counting;
+		for (auto plane = size_t{0}; plane < NofHoldPlanes; ++plane)
+		{
+			uint8_t bits = (holdCount[plane] ^ carry) & state;
+			carry &= holdCount[plane];
+			holdCount[plane] = bits;
+			reached &= ((LongPressSamples >> plane) & 0x1) ? bits : static_cast<uint8_t>(~bits);
+		}
+		edges.longPressed = reached;
+		longPressed |= reached;
+		return edges;
+	}
+
+	uint8_t held() const
+	{
+		return state;
+	}
+
+private:
+	uint8_t state = 0;
+	uint8_t count0 = 0xff;
+	uint8_t count1 = 0xff;
+	uint8_t longPressed = 0;
+	std::array<uint8_t, NofHoldPlanes> holdCount{};
+};
+
+/**
+ * Maps the edges of keys to an event. With KeyEdge::Chord the event is set when the last key of
+ * the mask goes down while the others are held.
+ */
+template <typename EventType>
+struct KeyEventMapping
+{
+	KeyEdge edge;
+	uint8_t keys;
+	EventType event;
+};
+
+namespace detail
+{
+	//! the 4 events of a key are in the order Pressed, LongPressed, Released, ReleasedLong
+	constexpr KeyEdge edgeOfKeyEvent(size_t eventOfKey)
+	{
+		return eventOfKey == 1 ? KeyEdge::LongPressed
+			: eventOfKey == 3 ? KeyEdge::ReleasedLong
+			: KeyEdge::Released; //Pressed is the short click, it is set on release like Released
+	}
+
+	template <typename EventType, EventType FirstEvent, size_t... Indices>
+	constexpr std::array<KeyEventMapping<EventType>, sizeof...(Indices)> makeKeyEventTable(IndexSequence<Indices...>)
+	{
+		using Underlying = typename std::underlying_type<EventType>::type;
+		return {{ KeyEventMapping<EventType>{ edgeOfKeyEvent(Indices % 4), static_cast<uint8_t>(1u << (Indices / 4)),
+			static_cast<EventType>(static_cast<Underlying>(FirstEvent) + Indices) }... }};
+	}
+}
+
+/**
+ * Generates the mapping for NofKeys keys with 4 consecutive events each, starting at FirstEvent:
+ * pressed (a short click, set on release), long pressed, released and released after a long press.
+ */
+template <typename EventType, EventType FirstEvent, size_t NofKeys>
+constexpr std::array<KeyEventMapping<EventType>, 4 * NofKeys> makeKeyEventTable()
+{
+	return detail::makeKeyEventTable<EventType, FirstEvent>(MakeIndexSequence<4 * NofKeys>{});
+}
+
+/**
+ * Sets the events of the mappings matching the edges. Once a chord was detected, its keys don't
+ * set any other event until they are released, a chord isn't a click of its keys.
+ */
+class KeyEventMapper
+{
+public:
+	template <typename EventType, size_t NofChords, size_t NofKeyEvents, typename SetEvent>
+	void map(const KeyEdges& edges, const std::array<KeyEventMapping<EventType>, NofChords>& chords,
+		const std::array<KeyEventMapping<EventType>, NofKeyEvents>& keyEvents, SetEvent setEvent)
+	{
+		for (const auto& chord : chords)
+		{
+			if ((edges.held & chord.keys) == chord.keys && (edges.pressed & chord.keys) != 0)
+			{
+				consumed |= chord.keys;
+				setEvent(chord.event);
+			}
+		}
+		for (const auto& keyEvent : keyEvents)
+		{
+			if ((edges.of(keyEvent.edge) & ~consumed & keyEvent.keys) == keyEvent.keys)
+			{
+				setEvent(keyEvent.event);
+			}
+		}
+		consumed &= edges.held;
+	}
+
+private:
+	uint8_t consumed = 0;
+};
@@ -0,0 +1,405 @@
+#include "ArenaSimulator.h"
+#include <TestAssert.h>
+#include "RobotIo.h"
+
+#include <BehaviourMachine.h>
+#include <Behaviours.h>
+#include <Reflectance.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	constexpr double Pi = 3.14159265358979323846;
+	constexpr uint32_t PushedOutContactMs = 500; //!< a fall this soon after a contact counts as pushed out
+
+	double length(const Vec2& v)
+	{
+		return std::sqrt(v.x * v.x + v.y * v.y);
+	}
+
+	//! angle in [-pi, pi)
+	double normalizedAngle(double angleRad)
+	{
+		return angleRad - 2 * Pi * std::floor((angleRad + Pi) / (2 * Pi));
+	}
+
+	bool isOutside(const ArenaConfig& arena, const Vec2& position)
+	{
+		return length(position) > arena.dohyoRadiusCm;
+	}
+
+	/**
+	 * wheel speeds of the opponent in ticks/s
+	 */
+	struct OpponentCommand
+	{
+		int32_t left;
+		int32_t right;
+	};
+
+	OpponentCommand controlOpponent(const MatchSetup& setup, const RobotPose& opponent, const Vec2& robot)
+	{
+		auto speed = static_cast<int32_t>(setup.opponentSpeed * MAX_SPEED);
+		switch (setup.opponent)
+		{
+		case OpponentKind::None:
+		case OpponentKind::Static:
+			return OpponentCommand{0, 0};
+		case OpponentKind::Spinner:
+			return OpponentCommand{-speed / 2, speed / 2};
+		case OpponentKind::Pusher:
+		{
+			const auto& position = opponent.position;
+			auto nearBorder = length(position) > setup.arena.dohyoRadiusCm - setup.arena.borderWidthCm - setup.arena.robotRadiusCm;
+			auto target = nearBorder ? Vec2{0.0, 0.0} : robot;
+			auto bearing = std::atan2(target.y - position.y, target.x - position.x);
+			auto error = normalizedAngle(bearing - opponent.headingRad);
+			if (std::fabs(error) < 0.3)
+			{
+				return OpponentCommand{speed, speed};
+			}
+			return error > 0 ? OpponentCommand{-speed / 2, speed / 2} : OpponentCommand{speed / 2, -speed / 2};
+		}
+		}
+		return OpponentCommand{0, 0};
+	}
+
+	using RobotArbitrator = decltype(makeArbitrator(makeBehaviours()));
+
+	/**
+	 * one match of a batch: the robot of the lane in the BodyBatch, everything else here
+	 */
+	struct Lane
+	{
+		const MatchSetup* pSetup = nullptr;	//!< nullptr while idle
+		size_t match = 0;
+		uint32_t startMs = 0;
+
+		RobotIo io;
+		RobotArbitrator arbitrator = makeArbitrator(makeBehaviours());
+		OpponentCommand opponentCommand{0, 0};
+		uint32_t lastContactMs = 0;
+		bool hadContact = false;
+		bool edgeWasDetected = false;
+		MatchResult result;
+	};
+
+	/**
+	 * Steps all lanes of a batch in lock step. A lane which finished its match gets the next one,
+	 * but only at a multiple of the sensor and control periods: then all lanes poll the sensors and
+	 * run the behaviours in the same ms, like runMatch() would for each of them.
+	 */
+	class BatchRunner
+	{
+	public:
+		BatchRunner(const std::vector<MatchSetup>& setups, size_t batchSize, SimdLevel level, std::vector<MatchResult>& results)
+			: arena(setups.front().arena)
+			, setups(setups)
+			, level(level)
+			, results(results)
+			, lanes(std::min(batchSize, setups.size()))
+			, robots(lanes.size())
+			, opponents(lanes.size())
+			, startPeriodMs(lcm(arena.ultrasonicPeriodMs, arena.controlPeriodMs))
+		{
+		}
+
+		void run()
+		{
+			for (auto nowMs = uint32_t{0}; startMatches(nowMs); nowMs += arena.physicsStepMs)
+			{
+				step(nowMs);
+			}
+			pCurrentRobotIo = nullptr;
+		}
+
+	private:
+		static uint32_t lcm(uint32_t first, uint32_t second)
+		{
+			auto a = first;
+			auto b = second;
+			while (b != 0)
+			{
+				auto rest = a % b;
+				a = b;
+				b = rest;
+			}
+			return first / a * second;
+		}
+
+		//! \return false if all matches are done
+		bool startMatches(uint32_t nowMs)
+		{
+			auto isRunning = false;
+			for (auto index = size_t{0}; index < lanes.size(); ++index)
+			{
+				if (!lanes[index].pSetup && nextMatch < setups.size() && nowMs % startPeriodMs == 0)
+				{
+					start(index, nextMatch++, nowMs);
+				}
+				isRunning = isRunning || lanes[index].pSetup;
+			}
+			return isRunning || nextMatch < setups.size();
+		}
+
+		void start(size_t index, size_t match, uint32_t nowMs)
+		{
+			const auto& setup = setups[match];
+			ASSERT(setup.arena.physicsStepMs == arena.physicsStepMs
+				&& setup.arena.ultrasonicPeriodMs == arena.ultrasonicPeriodMs
+				&& setup.arena.controlPeriodMs == arena.controlPeriodMs);
+			auto& lane = lanes[index];
+			lane = Lane{};
+			lane.pSetup = &setup;
+			lane.match = match;
+			lane.startMs = nowMs;
+			lane.io.enemyDistance = arena.ultrasonicNoEchoCm;
+			lane.io.startMove = true;
+			lane.arbitrator = makeArbitrator(makeBehaviours(setup.strategy));
+
+			std::mt19937 random(setup.seed);
+			std::uniform_real_distribution<double> anyHeading(-Pi, Pi);
+			auto robotHeading = anyHeading(random);
+			auto opponentHeading = anyHeading(random);
+			startBody(robots, index, RobotPose{Vec2{-setup.startDistanceCm / 2, 0.0}, robotHeading});
+			startBody(opponents, index, RobotPose{Vec2{setup.startDistanceCm / 2, 0.0}, opponentHeading});
+		}
+
+		static void startBody(BodyBatch& bodies, size_t index, const RobotPose& pose)
+		{
+			bodies.setPose(index, pose);
+			bodies.leftCmPerS[index] = 0.0;
+			bodies.rightCmPerS[index] = 0.0;
+			bodies.commandedLeft[index] = 0.0;
+			bodies.commandedRight[index] = 0.0;
+		}
+
+		void finish(Lane& lane, MatchOutcome outcome, uint32_t durationMs)
+		{
+			lane.result.outcome = outcome;
+			lane.result.durationMs = durationMs;
+			results[lane.match] = lane.result;
+			lane.pSetup = nullptr;
+		}
+
+		void step(uint32_t nowMs)
+		{
+			detectLines(arena, robots, seesLine, level);
+			auto isUltrasonicDue = nowMs % arena.ultrasonicPeriodMs == 0;
+			if (isUltrasonicDue)
+			{
+				measureUltrasonic(arena, robots, opponents, enemyDistanceCm, level);
+			}
+			auto isControlDue = nowMs % arena.controlPeriodMs == 0;
+
+			for (auto index = size_t{0}; index < lanes.size(); ++index)
+			{
+				auto& lane = lanes[index];
+				if (!lane.pSetup)
+				{
+					continue;
+				}
+				lane.io.nowMs = nowMs - lane.startMs;
+				if (lane.io.nowMs >= lane.pSetup->timeLimitMs)
+				{
+					finish(lane, MatchOutcome::Draw, lane.pSetup->timeLimitMs);
+					continue;
+				}
+				sense(lane, index, isUltrasonicDue);
+				if (isControlDue)
+				{
+					control(lane, index);
+				}
+			}
+
+			advanceBodies(arena, robots, arena.physicsStepMs, level);
+			advanceBodies(arena, opponents, arena.physicsStepMs, level);
+
+			for (auto index = size_t{0}; index < lanes.size(); ++index)
+			{
+				if (lanes[index].pSetup)
+				{
+					judge(lanes[index], index);
+				}
+			}
+		}
+
+		void sense(Lane& lane, size_t index, bool isUltrasonicDue)
+		{
+			pCurrentRobotIo = &lane.io;
+			lane.io.seesLine = seesLine[index] != 0;
+			if (isUltrasonicDue)
+			{
+				MainControl::notifyEnemyDetected(lane.pSetup->opponent != OpponentKind::None
+					? static_cast<uint16_t>(std::lround(enemyDistanceCm[index]))
+					: arena.ultrasonicNoEchoCm);
+			}
+		}
+
+		void control(Lane& lane, size_t index)
+		{
+			MainControl::notifyEdgeDetected(REF_SeesLine());
+			if (MainControl::hasEdgeDetected() && !lane.edgeWasDetected)
+			{
+				++lane.result.edgeDetections;
+			}
+			lane.edgeWasDetected = MainControl::hasEdgeDetected();
+			lane.arbitrator.step();
+			robots.commandedLeft[index] = lane.io.commandedLeft;
+			robots.commandedRight[index] = lane.io.commandedRight;
+
+			lane.opponentCommand = controlOpponent(*lane.pSetup, opponents.getPose(index), robots.getPosition(index));
+			opponents.commandedLeft[index] = lane.opponentCommand.left;
+			opponents.commandedRight[index] = lane.opponentCommand.right;
+		}
+
+		//! contacts and the end of the match
+		void judge(Lane& lane, size_t index)
+		{
+			auto hasOpponent = lane.pSetup->opponent != OpponentKind::None;
+			auto robot = robots.getPosition(index);
+			auto opponent = opponents.getPosition(index);
+			if (hasOpponent && resolveContact(arena, robot, robots.getVelocity(index), opponent, opponents.getVelocity(index), arena.physicsStepMs))
+			{
+				robots.setPosition(index, robot);
+				opponents.setPosition(index, opponent);
+				lane.hadContact = true;
+				lane.lastContactMs = lane.io.nowMs;
+			}
+
+			if (isOutside(arena, robot))
+			{
+				lane.result.pushedOut = lane.hadContact && lane.io.nowMs - lane.lastContactMs <= PushedOutContactMs;
+				finish(lane, MatchOutcome::Lost, lane.io.nowMs);
+			}
+			else if (hasOpponent && isOutside(arena, opponent))
+			{
+				finish(lane, MatchOutcome::Won, lane.io.nowMs);
+			}
+		}
+
+		const ArenaConfig& arena;
+		const std::vector<MatchSetup>& setups;
+		SimdLevel level;
+		std::vector<MatchResult>& results;
+
+		std::vector<Lane> lanes;
+		BodyBatch robots;
+		BodyBatch opponents;
+		std::vector<uint8_t> seesLine;
+		std::vector<double> enemyDistanceCm;
+		uint32_t startPeriodMs;
+		size_t nextMatch = 0;
+	};
+}
+
+const int32_t MaxSpeedTicks = MAX_SPEED;
+
+const char* toString(OpponentKind opponent)
+{
+	switch (opponent)
+	{
+	case OpponentKind::None: return "none";
+	case OpponentKind::Static: return "static";
+	case OpponentKind::Spinner: return "spinner";
+	case OpponentKind::Pusher: return "pusher";
+	}
+	return "?";
+}
+
+void SimulatedBody::advance(const ArenaConfig& arena, int32_t commandedLeft, int32_t commandedRight, uint32_t dtMs)
+{
+	auto cmPerTick = arena.maxSpeedCmPerS / MAX_SPEED;
+	auto follow = std::min(1.0, dtMs / arena.motorTimeConstantMs);
+	leftCmPerS += (commandedLeft * cmPerTick - leftCmPerS) * follow;
+	rightCmPerS += (commandedRight * cmPerTick - rightCmPerS) * follow;
+
+	auto dt = dtMs / 1000.0;
+	auto forward = (leftCmPerS + rightCmPerS) / 2 * dt;
+	auto turn = (rightCmPerS - leftCmPerS) / arena.wheelBaseCm * dt;
+	auto midHeading = pose.headingRad + turn / 2;
+	pose.position.x += forward * std::cos(midHeading);
+	pose.position.y += forward * std::sin(midHeading);
+	pose.headingRad = normalizedAngle(pose.headingRad + turn);
+}
+
+Vec2 SimulatedBody::velocity() const
+{
+	auto forward = (leftCmPerS + rightCmPerS) / 2;
+	return Vec2{forward * std::cos(pose.headingRad), forward * std::sin(pose.headingRad)};
+}
+
+bool resolveContact(const ArenaConfig& arena, Vec2& firstPosition, const Vec2& firstVelocity,
+	Vec2& secondPosition, const Vec2& secondVelocity, uint32_t dtMs)
+{
+	Vec2 between{secondPosition.x - firstPosition.x, secondPosition.y - firstPosition.y};
+	auto distance = length(between);
+	auto overlap = 2 * arena.robotRadiusCm - distance;
+	if (overlap <= 0)
+	{
+		return false;
+	}
+	Vec2 normal = distance > 0 ? Vec2{between.x / distance, between.y / distance} : Vec2{1.0, 0.0};
+
+	//how hard each one pushes towards the other, the one pushing less gives way
+	constexpr double MinPushCmPerS = 1.0;
+	auto firstPush = std::max(MinPushCmPerS, firstVelocity.x * normal.x + firstVelocity.y * normal.y);
+	auto secondPush = std::max(MinPushCmPerS, -(secondVelocity.x * normal.x + secondVelocity.y * normal.y));
+	auto firstShare = secondPush / (firstPush + secondPush);
+	firstPosition.x -= normal.x * overlap * firstShare;
+	firstPosition.y -= normal.y * overlap * firstShare;
+	secondPosition.x += normal.x * overlap * (1 - firstShare);
+	secondPosition.y += normal.y * overlap * (1 - firstShare);
+
+	//friction: the one giving way is dragged along with the sideways motion of the pusher
+	Vec2 tangent{-normal.y, normal.x};
+	auto dt = dtMs / 1000.0;
+	const auto& pusherVelocity = firstShare < 0.5 ? firstVelocity : secondVelocity;
+	auto& pushedPosition = firstShare < 0.5 ? secondPosition : firstPosition;
+	auto drag = (pusherVelocity.x * tangent.x + pusherVelocity.y * tangent.y) * arena.contactFriction * dt;
+	pushedPosition.x += tangent.x * drag;
+	pushedPosition.y += tangent.y * drag;
+	return true;
+}
+
+bool resolveContact(const ArenaConfig& arena, SimulatedBody& first, SimulatedBody& second, uint32_t dtMs)
+{
+	return resolveContact(arena, first.pose.position, first.velocity(), second.pose.position, second.velocity(), dtMs);
+}
+
+bool seesLine(const ArenaConfig& arena, const RobotPose& pose)
+{
+	BodyBatch body(1);
+	body.setPose(0, pose);
+	std::vector<uint8_t> seesLine;
+	detectLines(arena, body, seesLine, SimdLevel::Scalar);
+	return seesLine[0] != 0;
+}
+
+uint16_t ultrasonicDistanceCm(const ArenaConfig& arena, const RobotPose& pose, const Vec2& target)
+{
+	BodyBatch body(1);
+	body.setPose(0, pose);
+	BodyBatch targetBody(1);
+	targetBody.setPosition(0, target);
+	std::vector<double> distanceCm;
+	measureUltrasonic(arena, body, targetBody, distanceCm, SimdLevel::Scalar);
+	return static_cast<uint16_t>(std::lround(distanceCm[0]));
+}
+
+MatchResult runMatch(const MatchSetup& setup)
+{
+	return runMatchBatch({setup}, 1, SimdLevel::Scalar).front();
+}
+
+std::vector<MatchResult> runMatchBatch(const std::vector<MatchSetup>& setups, size_t batchSize, SimdLevel level)
+{
+	std::vector<MatchResult> results(setups.size());
+	if (!setups.empty())
+	{
+		BatchRunner(setups, std::max(batchSize, size_t{1}), level, results).run();
+	}
+	return results;
+}
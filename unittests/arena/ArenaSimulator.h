@@ -0,0 +1,137 @@
+#pragma once
+
+#include "BatchPhysics.h"
+
+#include <Strategy.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Host simulation of a sumo match: our robot runs the real behaviours of robo/Sources/Behaviours.h
+ * with the Arbitrator, against an opponent model on a circular dohyo. Distances are in cm,
+ * angles in rad, times in ms.
+ */
+
+//! MAX_SPEED of the behaviours in ticks/s, it drives at ArenaConfig::maxSpeedCmPerS
+extern const int32_t MaxSpeedTicks;
+
+struct Vec2
+{
+	double x;
+	double y;
+};
+
+struct RobotPose
+{
+	Vec2 position;
+	double headingRad; //!< 0 is along x, counter clockwise
+};
+
+struct ArenaConfig
+{
+	double dohyoRadiusCm = 77.0;
+	double borderWidthCm = 5.0;		//!< white border at the edge of the dohyo
+
+	double robotRadiusCm = 5.0;		//!< both robots are circles of this radius
+	double wheelBaseCm = 9.0;
+	double maxSpeedCmPerS = 60.0;	//!< at MAX_SPEED ticks/s
+	double motorTimeConstantMs = 50.0;
+	double contactFriction = 0.8;	//!< how much of the sideways motion of a pusher drags the pushed one along
+
+	double lineSensorOffsetCm = 4.0;	//!< from the center to the front row of line sensors
+	double lineSensorHalfWidthCm = 3.5;
+
+	double ultrasonicHalfAngleRad = 0.26;
+	double ultrasonicRangeCm = 200.0;
+	uint16_t ultrasonicNoEchoCm = 952;	//!< what the sensor reports without an echo (0xffff us)
+	uint32_t ultrasonicPeriodMs = 35;
+
+	uint32_t controlPeriodMs = 5;		//!< MainControl::DefaultPeriodMs
+	uint32_t physicsStepMs = 1;
+};
+
+enum class OpponentKind : uint8_t
+{
+	None,		//!< empty dohyo
+	Static,		//!< stands still
+	Spinner,	//!< turns on the spot
+	Pusher		//!< turns towards us and drives straight at us, avoids the border
+};
+
+const char* toString(OpponentKind opponent);
+
+struct MatchSetup
+{
+	ArenaConfig arena;
+	OpponentKind opponent = OpponentKind::Pusher;
+	double opponentSpeed = 0.5;		//!< fraction of the max speed
+	double startDistanceCm = 50.0;	//!< between the centers of the robots
+	uint32_t seed = 0;				//!< start headings
+	StrategyParameters strategy;	//!< of our robot
+	uint32_t timeLimitMs = 30000;
+};
+
+enum class MatchOutcome : uint8_t
+{
+	Won,	//!< the opponent left the dohyo
+	Lost,	//!< we left the dohyo
+	Draw	//!< the time limit was reached
+};
+
+struct MatchResult
+{
+	MatchOutcome outcome = MatchOutcome::Draw;
+	uint32_t durationMs = 0;
+	uint32_t edgeDetections = 0;	//!< rising edges of REF_SeesLine()
+	bool pushedOut = false;			//!< lost while in contact with the opponent, else we drove off
+};
+
+/**
+ * plays one match, matches of different threads run independently
+ */
+MatchResult runMatch(const MatchSetup& setup);
+
+/**
+ * plays the matches batchSize at a time with the physics and sensors of the batch computed by
+ * the kernels of BatchPhysics.h, the results are the same as with runMatch() for every batch
+ * size and level. All setups must have the same arena.
+ */
+std::vector<MatchResult> runMatchBatch(const std::vector<MatchSetup>& setups, size_t batchSize,
+	SimdLevel level = bestSimdLevel());
+
+//! true if one of the line sensors of a robot at pose is over the white border
+bool seesLine(const ArenaConfig& arena, const RobotPose& pose);
+
+/**
+ * what the ultrasonic sensor at the front of a robot at pose measures with the opponent at target:
+ * the distance to the surface of the opponent if it is within the cone and the range,
+ * else ArenaConfig::ultrasonicNoEchoCm
+ */
+uint16_t ultrasonicDistanceCm(const ArenaConfig& arena, const RobotPose& pose, const Vec2& target);
+
+/**
+ * robot with its wheel speeds, which follow the commanded ones with the motor time constant.
+ * The matches use the same model in advanceBodies().
+ */
+struct SimulatedBody
+{
+	RobotPose pose;
+	double leftCmPerS = 0.0;
+	double rightCmPerS = 0.0;
+
+	//! advances by dtMs with the commanded speeds in ticks/s (see DRV_SetSpeed)
+	void advance(const ArenaConfig& arena, int32_t commandedLeft, int32_t commandedRight, uint32_t dtMs);
+
+	//! velocity of the center in cm/s
+	Vec2 velocity() const;
+};
+
+/**
+ * separates the bodies if they overlap: the one pushing less along the line between them
+ * gives way and is dragged along by the sideways motion of the other during dtMs.
+ * \return true if they touched
+ */
+bool resolveContact(const ArenaConfig& arena, Vec2& firstPosition, const Vec2& firstVelocity,
+	Vec2& secondPosition, const Vec2& secondVelocity, uint32_t dtMs);
+
+bool resolveContact(const ArenaConfig& arena, SimulatedBody& first, SimulatedBody& second, uint32_t dtMs);
@@ -0,0 +1,328 @@
+#include "BatchPhysics.h"
+#include "ArenaSimulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	constexpr int NofLineSensors = 6;
+
+	/*
+	 * The kernels are written once against these lane types: Real holds Width doubles, Mask the
+	 * result of a comparison per lane. The arithmetic uses the operators, which GCC and Clang
+	 * provide for the SSE and AVX types as well.
+	 */
+	struct ScalarLanes
+	{
+		static constexpr size_t Width = 1;
+		using Real = double;
+		using Mask = bool;
+
+		static Real load(const double* pValues) { return *pValues; }
+		static void store(double* pValues, Real value) { *pValues = value; }
+		static Real set(double value) { return value; }
+		static Real sqrt(Real value) { return std::sqrt(value); }
+		static Real max(Real first, Real second) { return first > second ? first : second; }
+		static Mask lessEqual(Real first, Real second) { return first <= second; }
+		static Mask greaterEqual(Real first, Real second) { return first >= second; }
+		static Mask both(Mask first, Mask second) { return first && second; }
+		static Mask either(Mask first, Mask second) { return first || second; }
+		static Mask none() { return false; }
+		static Real select(Mask mask, Real ifSet, Real ifClear) { return mask ? ifSet : ifClear; }
+		static unsigned bits(Mask mask) { return mask ? 1 : 0; }
+	};
+
+#if defined(__SSE2__)
+	struct Sse2Lanes
+	{
+		static constexpr size_t Width = 2;
+		using Real = __m128d;
+		using Mask = __m128d;
+
+		static Real load(const double* pValues) { return _mm_loadu_pd(pValues); }
+		static void store(double* pValues, Real value) { _mm_storeu_pd(pValues, value); }
+		static Real set(double value) { return _mm_set1_pd(value); }
+		static Real sqrt(Real value) { return _mm_sqrt_pd(value); }
+		static Real max(Real first, Real second) { return _mm_max_pd(first, second); }
+		static Mask lessEqual(Real first, Real second) { return _mm_cmple_pd(first, second); }
+		static Mask greaterEqual(Real first, Real second) { return _mm_cmpge_pd(first, second); }
+		static Mask both(Mask first, Mask second) { return _mm_and_pd(first, second); }
+		static Mask either(Mask first, Mask second) { return _mm_or_pd(first, second); }
+		static Mask none() { return _mm_setzero_pd(); }
+		static Real select(Mask mask, Real ifSet, Real ifClear) { return _mm_or_pd(_mm_and_pd(mask, ifSet), _mm_andnot_pd(mask, ifClear)); }
+		static unsigned bits(Mask mask) { return static_cast<unsigned>(_mm_movemask_pd(mask)); }
+	};
+#endif
+
+#if defined(__AVX__)
+	struct AvxLanes
+	{
+		static constexpr size_t Width = 4;
+		using Real = __m256d;
+		using Mask = __m256d;
+
+		static Real load(const double* pValues) { return _mm256_loadu_pd(pValues); }
+		static void store(double* pValues, Real value) { _mm256_storeu_pd(pValues, value); }
+		static Real set(double value) { return _mm256_set1_pd(value); }
+		static Real sqrt(Real value) { return _mm256_sqrt_pd(value); }
+		static Real max(Real first, Real second) { return _mm256_max_pd(first, second); }
+		static Mask lessEqual(Real first, Real second) { return _mm256_cmp_pd(first, second, _CMP_LE_OQ); }
+		static Mask greaterEqual(Real first, Real second) { return _mm256_cmp_pd(first, second, _CMP_GE_OQ); }
+		static Mask both(Mask first, Mask second) { return _mm256_and_pd(first, second); }
+		static Mask either(Mask first, Mask second) { return _mm256_or_pd(first, second); }
+		static Mask none() { return _mm256_setzero_pd(); }
+		static Real select(Mask mask, Real ifSet, Real ifClear) { return _mm256_blendv_pd(ifClear, ifSet, mask); }
+		static unsigned bits(Mask mask) { return static_cast<unsigned>(_mm256_movemask_pd(mask)); }
+	};
+#endif
+
+	template <typename Lanes>
+	struct AdvanceKernel
+	{
+		static void run(const ArenaConfig& arena, BodyBatch& bodies, uint32_t dtMs)
+		{
+			using Real = typename Lanes::Real;
+			const auto cmPerTick = Lanes::set(arena.maxSpeedCmPerS / MaxSpeedTicks);
+			const auto follow = Lanes::set(std::min(1.0, dtMs / arena.motorTimeConstantMs));
+			const auto halfStep = Lanes::set(dtMs / 1000.0 / 2);
+			const auto halfTurnPerCmPerS = Lanes::set(dtMs / 1000.0 / arena.wheelBaseCm / 2);
+			const auto one = Lanes::set(1.0);
+			const auto half = Lanes::set(0.5);
+			const auto oneAndHalf = Lanes::set(1.5);
+
+			for (auto lane = size_t{0}; lane < bodies.size(); lane += Lanes::Width)
+			{
+				Real left = Lanes::load(&bodies.leftCmPerS[lane]);
+				Real right = Lanes::load(&bodies.rightCmPerS[lane]);
+				left = left + (Lanes::load(&bodies.commandedLeft[lane]) * cmPerTick - left) * follow;
+				right = right + (Lanes::load(&bodies.commandedRight[lane]) * cmPerTick - right) * follow;
+				Lanes::store(&bodies.leftCmPerS[lane], left);
+				Lanes::store(&bodies.rightCmPerS[lane], right);
+
+				//cosine and sine of half the turn of this step by their series
+				Real halfTurn = (right - left) * halfTurnPerCmPerS;
+				Real square = halfTurn * halfTurn;
+				Real sinHalf = halfTurn * (one - square * (Lanes::set(1.0 / 6) - square * (Lanes::set(1.0 / 120) - square * Lanes::set(1.0 / 5040))));
+				Real cosHalf = one - square * (half - square * (Lanes::set(1.0 / 24) - square * Lanes::set(1.0 / 720)));
+
+				//drive along the heading in the middle of the step
+				Real cosHeading = Lanes::load(&bodies.cosHeading[lane]);
+				Real sinHeading = Lanes::load(&bodies.sinHeading[lane]);
+				Real cosMid = cosHeading * cosHalf - sinHeading * sinHalf;
+				Real sinMid = sinHeading * cosHalf + cosHeading * sinHalf;
+				Real forward = (left + right) * halfStep;
+				Lanes::store(&bodies.x[lane], Lanes::load(&bodies.x[lane]) + forward * cosMid);
+				Lanes::store(&bodies.y[lane], Lanes::load(&bodies.y[lane]) + forward * sinMid);
+
+				//the second half of the turn, renormalized against the drift of the rounding
+				cosHeading = cosMid * cosHalf - sinMid * sinHalf;
+				sinHeading = sinMid * cosHalf + cosMid * sinHalf;
+				Real correction = oneAndHalf - half * (cosHeading * cosHeading + sinHeading * sinHeading);
+				Lanes::store(&bodies.cosHeading[lane], cosHeading * correction);
+				Lanes::store(&bodies.sinHeading[lane], sinHeading * correction);
+			}
+		}
+	};
+
+	template <typename Lanes>
+	struct DetectLinesKernel
+	{
+		static void run(const ArenaConfig& arena, const BodyBatch& bodies, std::vector<uint8_t>& seesLine)
+		{
+			using Real = typename Lanes::Real;
+			using Mask = typename Lanes::Mask;
+			const auto offset = Lanes::set(arena.lineSensorOffsetCm);
+			const auto inner = Lanes::set(arena.dohyoRadiusCm - arena.borderWidthCm);
+			const auto outer = Lanes::set(arena.dohyoRadiusCm);
+
+			for (auto lane = size_t{0}; lane < bodies.size(); lane += Lanes::Width)
+			{
+				Real x = Lanes::load(&bodies.x[lane]);
+				Real y = Lanes::load(&bodies.y[lane]);
+				Real cosHeading = Lanes::load(&bodies.cosHeading[lane]);
+				Real sinHeading = Lanes::load(&bodies.sinHeading[lane]);
+				Mask sees = Lanes::none();
+				for (auto sensor = 0; sensor < NofLineSensors; ++sensor)
+				{
+					auto lateral = Lanes::set(arena.lineSensorHalfWidthCm * (2.0 * sensor / (NofLineSensors - 1) - 1));
+					Real sensorX = x + offset * cosHeading - lateral * sinHeading;
+					Real sensorY = y + offset * sinHeading + lateral * cosHeading;
+					Real radius = Lanes::sqrt(sensorX * sensorX + sensorY * sensorY);
+					sees = Lanes::either(sees, Lanes::both(Lanes::greaterEqual(radius, inner), Lanes::lessEqual(radius, outer)));
+				}
+				auto bits = Lanes::bits(sees);
+				for (auto index = size_t{0}; index < Lanes::Width; ++index)
+				{
+					seesLine[lane + index] = (bits >> index) & 1;
+				}
+			}
+		}
+	};
+
+	/*
+	 * The opponent, a circle of the robot radius, is seen if it reaches into the cone: the bearing
+	 * to its center is at most the half angle of the cone plus asin(radius / center distance). As
+	 * cosines, multiplied by the center distance:
+	 * dot(heading, to center) >= cos(half angle) * sqrt(distance^2 - radius^2) - sin(half angle) * radius
+	 */
+	template <typename Lanes>
+	struct MeasureUltrasonicKernel
+	{
+		static void run(const ArenaConfig& arena, const BodyBatch& bodies, const BodyBatch& targets,
+			std::vector<double>& distanceCm)
+		{
+			using Real = typename Lanes::Real;
+			using Mask = typename Lanes::Mask;
+			const auto radius = Lanes::set(arena.robotRadiusCm);
+			const auto radiusSquare = Lanes::set(arena.robotRadiusCm * arena.robotRadiusCm);
+			const auto range = Lanes::set(arena.ultrasonicRangeCm);
+			const auto cosHalfAngle = Lanes::set(std::cos(arena.ultrasonicHalfAngleRad));
+			const auto sinHalfAngleRadius = Lanes::set(std::sin(arena.ultrasonicHalfAngleRad) * arena.robotRadiusCm);
+			const auto noEcho = Lanes::set(arena.ultrasonicNoEchoCm);
+			const auto zero = Lanes::set(0.0);
+
+			for (auto lane = size_t{0}; lane < bodies.size(); lane += Lanes::Width)
+			{
+				Real cosHeading = Lanes::load(&bodies.cosHeading[lane]);
+				Real sinHeading = Lanes::load(&bodies.sinHeading[lane]);
+				Real toTargetX = Lanes::load(&targets.x[lane]) - (Lanes::load(&bodies.x[lane]) + radius * cosHeading);
+				Real toTargetY = Lanes::load(&targets.y[lane]) - (Lanes::load(&bodies.y[lane]) + radius * sinHeading);
+				Real centerSquare = toTargetX * toTargetX + toTargetY * toTargetY;
+				Real surfaceDistance = Lanes::max(zero, Lanes::sqrt(centerSquare) - radius);
+
+				Real alongHeading = cosHeading * toTargetX + sinHeading * toTargetY;
+				Real tangent = Lanes::sqrt(Lanes::max(zero, centerSquare - radiusSquare));
+				Mask inCone = Lanes::either(Lanes::lessEqual(centerSquare, radiusSquare),
+					Lanes::greaterEqual(alongHeading, cosHalfAngle * tangent - sinHalfAngleRadius));
+				Mask echo = Lanes::both(inCone, Lanes::lessEqual(surfaceDistance, range));
+				Lanes::store(&distanceCm[lane], Lanes::select(echo, surfaceDistance, noEcho));
+			}
+		}
+	};
+
+	//! runs Kernel<Lanes>::run(args...) with the lanes of the level, the scalar ones if it isn't available
+	template <template <typename> class Kernel, typename... Args>
+	void dispatch(SimdLevel level, Args&&... args)
+	{
+		switch (level)
+		{
+#if defined(__AVX__)
+		case SimdLevel::Avx:
+			Kernel<AvxLanes>::run(args...);
+			return;
+#endif
+#if defined(__SSE2__)
+		case SimdLevel::Sse2:
+			Kernel<Sse2Lanes>::run(args...);
+			return;
+#endif
+		default:
+			Kernel<ScalarLanes>::run(args...);
+			return;
+		}
+	}
+}
+
+const char* toString(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::Scalar: return "scalar";
+	case SimdLevel::Sse2: return "sse2";
+	case SimdLevel::Avx: return "avx";
+	}
+	return "?";
+}
+
+SimdLevel bestSimdLevel()
+{
+#if defined(__AVX__)
+	return SimdLevel::Avx;
+#elif defined(__SSE2__)
+	return SimdLevel::Sse2;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+bool isSimdLevelAvailable(SimdLevel level)
+{
+	return level <= bestSimdLevel();
+}
+
+BodyBatch::BodyBatch(size_t size)
+{
+	resize(size);
+}
+
+void BodyBatch::resize(size_t size)
+{
+	nofLanes = size;
+	auto padded = (size + LanePadding - 1) / LanePadding * LanePadding;
+	for (auto pArray : {&x, &y, &sinHeading, &leftCmPerS, &rightCmPerS, &commandedLeft, &commandedRight})
+	{
+		pArray->resize(padded, 0.0);
+	}
+	cosHeading.resize(padded, 1.0);
+}
+
+size_t BodyBatch::size() const
+{
+	return nofLanes;
+}
+
+void BodyBatch::setPose(size_t lane, const RobotPose& pose)
+{
+	x[lane] = pose.position.x;
+	y[lane] = pose.position.y;
+	cosHeading[lane] = std::cos(pose.headingRad);
+	sinHeading[lane] = std::sin(pose.headingRad);
+}
+
+RobotPose BodyBatch::getPose(size_t lane) const
+{
+	return RobotPose{getPosition(lane), std::atan2(sinHeading[lane], cosHeading[lane])};
+}
+
+Vec2 BodyBatch::getPosition(size_t lane) const
+{
+	return Vec2{x[lane], y[lane]};
+}
+
+void BodyBatch::setPosition(size_t lane, const Vec2& position)
+{
+	x[lane] = position.x;
+	y[lane] = position.y;
+}
+
+Vec2 BodyBatch::getVelocity(size_t lane) const
+{
+	auto forward = (leftCmPerS[lane] + rightCmPerS[lane]) / 2;
+	return Vec2{forward * cosHeading[lane], forward * sinHeading[lane]};
+}
+
+void advanceBodies(const ArenaConfig& arena, BodyBatch& bodies, uint32_t dtMs, SimdLevel level)
+{
+	dispatch<AdvanceKernel>(level, arena, bodies, dtMs);
+}
+
+void detectLines(const ArenaConfig& arena, const BodyBatch& bodies, std::vector<uint8_t>& seesLine, SimdLevel level)
+{
+	seesLine.resize(bodies.x.size());
+	dispatch<DetectLinesKernel>(level, arena, bodies, seesLine);
+}
+
+void measureUltrasonic(const ArenaConfig& arena, const BodyBatch& bodies, const BodyBatch& targets,
+	std::vector<double>& distanceCm, SimdLevel level)
+{
+	distanceCm.resize(bodies.x.size());
+	dispatch<MeasureUltrasonicKernel>(level, arena, bodies, targets, distanceCm);
+}
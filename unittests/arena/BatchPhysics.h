@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ArenaConfig;
+struct RobotPose;
+struct Vec2;
+
+/**
+ * Structure of arrays kernels of the arena simulator: they advance and sense many robots of
+ * independent matches at once, with SIMD where available. Every SimdLevel gives bit for bit the
+ * same results as the scalar one (the arena library is built without fused multiply-add).
+ */
+
+enum class SimdLevel : uint8_t
+{
+	Scalar,
+	Sse2,	//!< 2 lanes
+	Avx		//!< 4 lanes, only if the arena library is built with AVX (ARENA_NATIVE)
+};
+
+const char* toString(SimdLevel level);
+
+//! the widest level the arena library was built with
+SimdLevel bestSimdLevel();
+
+bool isSimdLevelAvailable(SimdLevel level);
+
+/**
+ * Robots of a batch, one lane each. The heading is kept as its cosine and sine, the kernels
+ * rotate them instead of calling trigonometric functions. The arrays are padded to a multiple
+ * of the widest SIMD width, the kernels simulate the padding lanes up to their width as well.
+ */
+struct BodyBatch
+{
+	static constexpr size_t LanePadding = 4;
+
+	explicit BodyBatch(size_t size = 0);
+
+	void resize(size_t size);
+	size_t size() const;
+
+	void setPose(size_t lane, const RobotPose& pose);
+	RobotPose getPose(size_t lane) const;
+	Vec2 getPosition(size_t lane) const;
+	void setPosition(size_t lane, const Vec2& position);
+	//! velocity of the center in cm/s
+	Vec2 getVelocity(size_t lane) const;
+
+	std::vector<double> x;
+	std::vector<double> y;
+	std::vector<double> cosHeading;
+	std::vector<double> sinHeading;
+	std::vector<double> leftCmPerS;
+	std::vector<double> rightCmPerS;
+
+	//! commanded wheel speeds in ticks/s, see DRV_SetSpeed()
+	std::vector<double> commandedLeft;
+	std::vector<double> commandedRight;
+
+private:
+	size_t nofLanes = 0;
+};
+
+/**
+ * advances all bodies by dtMs like SimulatedBody::advance(), the rotation by the small angle of
+ * a step uses a series, which is exact to double precision for steps of a few ms
+ */
+void advanceBodies(const ArenaConfig& arena, BodyBatch& bodies, uint32_t dtMs, SimdLevel level);
+
+//! like seesLine(), one result per lane
+void detectLines(const ArenaConfig& arena, const BodyBatch& bodies, std::vector<uint8_t>& seesLine, SimdLevel level);
+
+/**
+ * like ultrasonicDistanceCm() with the target of each lane at the position of the lane in targets,
+ * as unrounded distance (ArenaConfig::ultrasonicNoEchoCm without an echo)
+ */
+void measureUltrasonic(const ArenaConfig& arena, const BodyBatch& bodies, const BodyBatch& targets,
+	std::vector<double>& distanceCm, SimdLevel level);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Drive.h>
+#include <array>
+#include <cstdint>
+
+/**
+ * Everything the stand-ins of the robot headers read and write, one per simulated robot
+ */
+struct RobotIo
+{
+	uint32_t nowMs = 0;
+	bool seesLine = false;
+
+	int32_t commandedLeft = 0;
+	int32_t commandedRight = 0;
+	std::array<SpeedState, HistorySize> lastSpeeds{}; //!< oldest first, like DRV_GetLastSpeeds()
+
+	//MainControl
+	bool edgeDetected = false;
+	bool startMove = false;
+	bool stopMotors = false;
+	bool turnRequested = false;
+	uint16_t enemyDistance = 0;
+	int8_t speed = 0;
+};
+
+//! the robot the stand-ins talk to, set by runMatch() for the calling thread
+extern thread_local RobotIo* pCurrentRobotIo;
@@ -0,0 +1,121 @@
+#include <TestAssert.h>
+#include "RobotIo.h"
+
+#include <Drive.h>
+#include <IOStream.h>
+#include <MainControl.h>
+#include <Reflectance.h>
+#include <Remote.h>
+#include <RoboConsole.h>
+#include <Timer.h>
+#include <algorithm>
+
+thread_local RobotIo* pCurrentRobotIo = nullptr;
+
+namespace
+{
+	RobotIo& io()
+	{
+		return *pCurrentRobotIo;
+	}
+}
+
+void DRV_SetSpeed(int32_t left, int32_t right)
+{
+	io().commandedLeft = left;
+	io().commandedRight = right;
+	std::rotate(io().lastSpeeds.begin(), io().lastSpeeds.begin() + 1, io().lastSpeeds.end());
+	io().lastSpeeds.back() = SpeedState{left, right};
+}
+
+std::array<SpeedState, HistorySize> DRV_GetLastSpeeds()
+{
+	return io().lastSpeeds;
+}
+
+uint32_t TMR_ValueMs()
+{
+	return io().nowMs;
+}
+
+bool REF_SeesLine(void)
+{
+	return io().seesLine;
+}
+
+bool REMOTE_GetOnOff(void)
+{
+	return false;
+}
+
+IOStream* SimConsole::getUnderlyingIoStream()
+{
+	static auto nullStream = makeFnIoStream([](char){}, []{ return optional<char>{}; });
+	return &nullStream;
+}
+
+SimConsole& getConsole()
+{
+	static SimConsole console;
+	return console;
+}
+
+void MainControl::notifyEdgeDetected(bool detected)
+{
+	io().edgeDetected = detected;
+}
+
+void MainControl::notifyStartMove(bool start)
+{
+	io().startMove = start;
+}
+
+void MainControl::notifyEnemyDetected(uint16_t cm)
+{
+	io().enemyDistance = cm;
+}
+
+void MainControl::notifyStopMotors(bool stop)
+{
+	io().stopMotors = stop;
+}
+
+void MainControl::notifyTurnRequested(bool requested)
+{
+	io().turnRequested = requested;
+}
+
+void MainControl::setSpeed(int8_t wantedSpeed)
+{
+	io().speed = wantedSpeed;
+}
+
+bool MainControl::hasEdgeDetected()
+{
+	return io().edgeDetected;
+}
+
+int16_t MainControl::getSpeed()
+{
+	return io().speed*74;
+}
+
+bool MainControl::hasStartMove()
+{
+	return io().startMove;
+}
+
+bool MainControl::hasStopMotors()
+{
+	return io().stopMotors;
+}
+
+bool MainControl::hasTurnRequested()
+{
+	return io().turnRequested;
+}
+
+uint16_t MainControl::getEnemyDistance()
+{
+	return io().enemyDistance;
+}
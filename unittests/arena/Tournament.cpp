@@ -0,0 +1,174 @@
+#include "Tournament.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+std::vector<StrategyParameters> expandSweep(const StrategySweep& sweep)
+{
+	std::vector<StrategyParameters> candidates;
+	for (const auto& scanVariants : sweep.scanVariantTables)
+	{
+		for (auto enemyDistanceLimitCm : sweep.enemyDistanceLimitsCm)
+		{
+			for (auto reversingTimeMs : sweep.reversingTimesMs)
+			{
+				for (auto turningTimeMs : sweep.turningTimesMs)
+				{
+					StrategyParameters strategy;
+					strategy.scanVariants = scanVariants;
+					strategy.enemyDistanceLimitCm = enemyDistanceLimitCm;
+					strategy.reversingTimeMs = reversingTimeMs;
+					strategy.turningTimeMs = turningTimeMs;
+					candidates.push_back(strategy);
+				}
+			}
+		}
+	}
+	return candidates;
+}
+
+void StrategyStats::add(const MatchResult& result)
+{
+	++matches;
+	switch (result.outcome)
+	{
+	case MatchOutcome::Won:
+		++won;
+		break;
+	case MatchOutcome::Lost:
+		++lost;
+		if (result.pushedOut)
+		{
+			++pushedOut;
+		}
+		else
+		{
+			++edgeFalls;
+		}
+		break;
+	case MatchOutcome::Draw:
+		++draws;
+		break;
+	}
+	edgeDetections += result.edgeDetections;
+	durationMs += result.durationMs;
+}
+
+void StrategyStats::merge(const StrategyStats& other)
+{
+	matches += other.matches;
+	won += other.won;
+	lost += other.lost;
+	draws += other.draws;
+	pushedOut += other.pushedOut;
+	edgeFalls += other.edgeFalls;
+	edgeDetections += other.edgeDetections;
+	durationMs += other.durationMs;
+}
+
+double StrategyStats::winRate() const
+{
+	return matches == 0 ? 0.0 : static_cast<double>(won) / matches;
+}
+
+double StrategyStats::edgeFallRate() const
+{
+	return matches == 0 ? 0.0 : static_cast<double>(edgeFalls) / matches;
+}
+
+std::vector<TournamentEntry> runTournament(const TournamentSetup& setup,
+	const std::vector<StrategyParameters>& candidates, WorkStealingPool& pool)
+{
+	//one slot per match, filled by the tasks and summed up afterwards in a fixed order
+	auto matchesPerCandidate = setup.opponents.size() * setup.matchesPerOpponent;
+	std::vector<MatchSetup> matchSetups;
+	matchSetups.reserve(candidates.size() * matchesPerCandidate);
+	for (auto candidate = size_t{0}; candidate < candidates.size(); ++candidate)
+	{
+		for (auto opponent = size_t{0}; opponent < setup.opponents.size(); ++opponent)
+		{
+			for (auto match = uint32_t{0}; match < setup.matchesPerOpponent; ++match)
+			{
+				auto matchSetup = setup.match;
+				matchSetup.opponent = setup.opponents[opponent];
+				matchSetup.seed = setup.firstSeed + match;
+				matchSetup.strategy = candidates[candidate];
+				//the scan variants are picked at random as well, but alike for all candidates
+				matchSetup.strategy.scanSeed += matchSetup.seed;
+				matchSetups.push_back(matchSetup);
+			}
+		}
+	}
+
+	std::vector<MatchResult> results(matchSetups.size());
+	auto batchSize = std::max(setup.batchSize, size_t{1});
+	for (auto first = size_t{0}; first < matchSetups.size(); first += batchSize)
+	{
+		auto last = std::min(first + batchSize, matchSetups.size());
+		pool.submit([&matchSetups, &results, first, last]
+		{
+			auto batch = runMatchBatch(std::vector<MatchSetup>(matchSetups.begin() + first, matchSetups.begin() + last), last - first);
+			std::copy(batch.begin(), batch.end(), results.begin() + first);
+		});
+	}
+	pool.wait();
+
+	std::vector<TournamentEntry> entries;
+	for (auto candidate = size_t{0}; candidate < candidates.size(); ++candidate)
+	{
+		TournamentEntry entry;
+		entry.strategy = candidates[candidate];
+		entry.perOpponent.resize(setup.opponents.size());
+		for (auto opponent = size_t{0}; opponent < setup.opponents.size(); ++opponent)
+		{
+			for (auto match = uint32_t{0}; match < setup.matchesPerOpponent; ++match)
+			{
+				entry.perOpponent[opponent].add(results[candidate * matchesPerCandidate + opponent * setup.matchesPerOpponent + match]);
+			}
+			entry.total.merge(entry.perOpponent[opponent]);
+		}
+		entries.push_back(std::move(entry));
+	}
+	return entries;
+}
+
+std::string describe(const StrategyParameters& strategy)
+{
+	std::ostringstream text;
+	text << "limit " << strategy.enemyDistanceLimitCm << "cm, reverse " << strategy.reversingTimeMs
+		<< "ms, turn " << strategy.turningTimeMs << "ms, scan";
+	for (const auto& variant : strategy.scanVariants)
+	{
+		text << " " << variant.timeoutMs << "ms:" << variant.left << "/" << variant.right;
+	}
+	return text.str();
+}
+
+void writeTournamentReport(std::ostream& out, const TournamentSetup& setup,
+	std::vector<TournamentEntry> entries, size_t nofBest)
+{
+	std::stable_sort(entries.begin(), entries.end(), [](const TournamentEntry& first, const TournamentEntry& second)
+	{
+		if (first.total.winRate() != second.total.winRate())
+		{
+			return first.total.winRate() > second.total.winRate();
+		}
+		return first.total.edgeFallRate() < second.total.edgeFallRate();
+	});
+	entries.resize(std::min(nofBest, entries.size()));
+
+	out << std::fixed << std::setprecision(1);
+	for (const auto& entry : entries)
+	{
+		out << describe(entry.strategy) << "\n";
+		out << "  total: won " << 100 * entry.total.winRate() << "%, edge falls " << 100 * entry.total.edgeFallRate()
+			<< "%, pushed out " << entry.total.pushedOut << ", draws " << entry.total.draws << "\n";
+		for (auto opponent = size_t{0}; opponent < setup.opponents.size(); ++opponent)
+		{
+			const auto& stats = entry.perOpponent[opponent];
+			out << "  " << toString(setup.opponents[opponent]) << ": won " << stats.won << ", lost " << stats.lost
+				<< " (" << stats.edgeFalls << " edge falls), draws " << stats.draws << "\n";
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ArenaSimulator.h"
+#include "WorkStealingPool.h"
+
+#include <Strategy.h>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Monte Carlo search for the StrategyParameters: every candidate plays the same matches (same
+ * seeds, so the same start headings) against every opponent, the matches run in batches in
+ * parallel on a WorkStealingPool.
+ */
+
+//! the values to try per parameter, the candidates are all combinations of them
+struct StrategySweep
+{
+	std::vector<ScanVariants> scanVariantTables{StrategyParameters{}.scanVariants};
+	std::vector<uint16_t> enemyDistanceLimitsCm{StrategyParameters{}.enemyDistanceLimitCm};
+	std::vector<uint32_t> reversingTimesMs{StrategyParameters{}.reversingTimeMs};
+	std::vector<uint32_t> turningTimesMs{StrategyParameters{}.turningTimeMs};
+};
+
+std::vector<StrategyParameters> expandSweep(const StrategySweep& sweep);
+
+struct StrategyStats
+{
+	uint32_t matches = 0;
+	uint32_t won = 0;
+	uint32_t lost = 0;
+	uint32_t draws = 0;
+	uint32_t pushedOut = 0;	//!< lost ones where the opponent pushed us out
+	uint32_t edgeFalls = 0;	//!< lost ones where we drove off on our own
+	uint64_t edgeDetections = 0;
+	uint64_t durationMs = 0;
+
+	void add(const MatchResult& result);
+	void merge(const StrategyStats& other);
+
+	double winRate() const;
+	double edgeFallRate() const;
+};
+
+struct TournamentSetup
+{
+	MatchSetup match;	//!< arena and opponent settings, the opponent, seed and strategy are set per match
+	std::vector<OpponentKind> opponents{OpponentKind::Static, OpponentKind::Spinner, OpponentKind::Pusher};
+	uint32_t matchesPerOpponent = 20;
+	uint32_t firstSeed = 0;
+	size_t batchSize = 8;	//!< matches per task of the pool, played together by runMatchBatch()
+};
+
+struct TournamentEntry
+{
+	StrategyParameters strategy;
+	StrategyStats total;
+	std::vector<StrategyStats> perOpponent;	//!< in the order of TournamentSetup::opponents
+};
+
+/**
+ * plays all matches of all candidates, the result doesn't depend on the number of threads or the
+ * batch size
+ * \return an entry per candidate, in their order
+ */
+std::vector<TournamentEntry> runTournament(const TournamentSetup& setup,
+	const std::vector<StrategyParameters>& candidates, WorkStealingPool& pool);
+
+std::string describe(const StrategyParameters& strategy);
+
+//! writes the best nofBest entries, highest win rate first, fewer edge falls first among equal ones
+void writeTournamentReport(std::ostream& out, const TournamentSetup& setup,
+	std::vector<TournamentEntry> entries, size_t nofBest);
@@ -0,0 +1,146 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(size_t nofThreads)
+{
+	if (nofThreads == 0)
+	{
+		nofThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (auto index = size_t{0}; index < nofThreads; ++index)
+	{
+		queues.emplace_back(new Queue);
+	}
+	for (auto index = size_t{0}; index < nofThreads; ++index)
+	{
+		threads.emplace_back([this, index]{ work(index); });
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(stateMutex);
+		waitUntilDone(lock);
+		stopping = true;
+	}
+	taskQueued.notify_all();
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkStealingPool::submit(Task task)
+{
+	{
+		//the queue is filled while holding the state, so a worker never takes a task which isn't counted yet
+		std::lock_guard<std::mutex> lock(stateMutex);
+		auto& queue = *queues[nextQueue];
+		nextQueue = (nextQueue + 1) % queues.size();
+		{
+			std::lock_guard<std::mutex> queueLock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		++nofQueued;
+		++nofPending;
+	}
+	taskQueued.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+	std::unique_lock<std::mutex> lock(stateMutex);
+	waitUntilDone(lock);
+	if (firstError)
+	{
+		auto error = firstError;
+		firstError = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+void WorkStealingPool::waitUntilDone(std::unique_lock<std::mutex>& lock)
+{
+	allDone.wait(lock, [this]{ return nofPending == 0; });
+}
+
+size_t WorkStealingPool::getNofThreads() const
+{
+	return threads.size();
+}
+
+uint64_t WorkStealingPool::getNofStolen() const
+{
+	return nofStolen.load();
+}
+
+bool WorkStealingPool::tryTake(size_t index, Task& task)
+{
+	{
+		auto& own = *queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+	for (auto offset = size_t{1}; offset < queues.size(); ++offset)
+	{
+		auto& victim = *queues[(index + offset) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			++nofStolen;
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingPool::work(size_t index)
+{
+	for (;;)
+	{
+		Task task;
+		if (tryTake(index, task))
+		{
+			{
+				std::lock_guard<std::mutex> lock(stateMutex);
+				--nofQueued;
+			}
+			std::exception_ptr error;
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				//leaving the thread would call std::terminate
+				error = std::current_exception();
+			}
+			std::lock_guard<std::mutex> lock(stateMutex);
+			if (error && !firstError)
+			{
+				firstError = error;
+			}
+			if (--nofPending == 0)
+			{
+				allDone.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(stateMutex);
+		taskQueued.wait(lock, [this]{ return stopping || nofQueued != 0; });
+		if (stopping && nofQueued == 0)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Thread pool with a task queue per worker. Tasks are spread round robin over the queues, a worker
+ * takes the newest task of its own queue and, when that is empty, steals the oldest one of another
+ * queue, so workers which got quick tasks help the ones which got slow ones.
+ *
+ * An exception of a task, e.g. a failed ASSERT, doesn't leave the worker: wait() rethrows it.
+ */
+class WorkStealingPool
+{
+public:
+	using Task = std::function<void()>;
+
+	//! with 0 threads it takes one per hardware thread
+	explicit WorkStealingPool(size_t nofThreads = 0);
+
+	//! finishes the submitted tasks, an exception of them which wait() didn't rethrow is dropped
+	~WorkStealingPool();
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	void submit(Task task);
+
+	//! blocks until all submitted tasks ran, then rethrows the first exception a task threw since the last wait()
+	void wait();
+
+	size_t getNofThreads() const;
+
+	//! how many tasks ran on another worker than the one they were queued for
+	uint64_t getNofStolen() const;
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void waitUntilDone(std::unique_lock<std::mutex>& lock);
+	void work(size_t index);
+	bool tryTake(size_t index, Task& task);
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> threads;
+
+	//protects the counters, always taken before the mutex of a queue
+	std::mutex stateMutex;
+	std::condition_variable taskQueued;
+	std::condition_variable allDone;
+	size_t nofQueued = 0;	//!< in the queues
+	size_t nofPending = 0;	//!< in the queues or running
+	bool stopping = false;
+	std::exception_ptr firstError;
+
+	size_t nextQueue = 0;
+	std::atomic<uint64_t> nofStolen{0};
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+/*
+ * stand-in for robocommon/Assert.h: a failed assertion throws like in the unittests
+ */
+#include <TestAssert.h>
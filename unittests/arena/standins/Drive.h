@@ -0,0 +1,18 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/*
+ * stand-in for robocommon/Drive.h: the speeds go to the simulated robot of the calling thread
+ */
+
+void DRV_SetSpeed(int32_t left, int32_t right);
+
+constexpr auto HistorySize = 4;
+struct SpeedState
+{
+	int32_t left;
+	int32_t right;
+};
+std::array<SpeedState, HistorySize> DRV_GetLastSpeeds();
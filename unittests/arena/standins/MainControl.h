@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * stand-in for robo/Sources/MainControl.h: the inputs of the behaviours, kept per simulated robot
+ * (per thread) instead of globally
+ */
+class MainControl
+{
+public:
+	static void notifyEdgeDetected(bool detected);
+	static void notifyStartMove(bool start);
+	static void notifyEnemyDetected(uint16_t cm);
+	static void notifyStopMotors(bool stop);
+	static void notifyTurnRequested(bool requested);
+
+	static void setSpeed(int8_t wantedSpeed);
+
+	static bool hasEdgeDetected();
+	static int16_t getSpeed();
+	static bool hasStartMove();
+	static bool hasStopMotors();
+	static bool hasTurnRequested();
+	static uint16_t getEnemyDistance();
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ * stand-in for robocommon/Reflectance.h: true if a line sensor of the simulated robot is over the
+ * border of the dohyo
+ */
+
+bool REF_SeesLine(void);
@@ -0,0 +1,7 @@
+#pragma once
+
+/*
+ * stand-in for robocommon/Remote.h: there is no remote in the arena
+ */
+
+bool REMOTE_GetOnOff(void);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <IOStream.h>
+
+/*
+ * stand-in for robo/Sources/RoboConsole.h: everything written is dropped
+ */
+class SimConsole
+{
+public:
+	IOStream* getUnderlyingIoStream();
+};
+
+SimConsole& getConsole();
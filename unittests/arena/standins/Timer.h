@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * stand-in for robocommon/Timer.h: the simulated time of the match of the calling thread
+ */
+
+uint32_t TMR_ValueMs();
@@ -0,0 +1,67 @@
+#include "HostLink.h"
+
+#include <utility>
+
+void HostReceiver::receive(const std::vector<uint8_t>& bytes)
+{
+	for (auto byte : bytes)
+	{
+		receive(byte);
+	}
+}
+
+void HostReceiver::receive(uint8_t byte)
+{
+	if (!isInFrame)
+	{
+		if (byte == 0)
+		{
+			isInFrame = true;
+			encodedFrame.clear();
+		}
+		else
+		{
+			text.push_back(static_cast<char>(byte));
+		}
+	}
+	else if (byte != 0)
+	{
+		encodedFrame.push_back(byte);
+	}
+	else if (!encodedFrame.empty())
+	{ //a zero right after the leading one starts the frame anew
+		frameCompleted();
+		isInFrame = false;
+	}
+}
+
+void HostReceiver::frameCompleted()
+{
+	auto decoded = decodeFrame(encodedFrame.data(), encodedFrame.size());
+	if (!decoded)
+	{
+		++nofBadFrames;
+		return;
+	}
+	const auto& frame = *decoded;
+	frames.push_back(HostFrame{frame.id, std::vector<uint8_t>(frame.pPayload, frame.pPayload + frame.payloadSize)});
+}
+
+std::vector<HostFrame> HostReceiver::takeFrames()
+{
+	std::vector<HostFrame> taken;
+	std::swap(taken, frames);
+	return taken;
+}
+
+std::string HostReceiver::takeText()
+{
+	std::string taken;
+	std::swap(taken, text);
+	return taken;
+}
+
+uint32_t HostReceiver::getNofBadFrames() const
+{
+	return nofBadFrames;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <BinaryProtocol.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * The host side of the binary protocol of BinaryProtocol.h, for tools which talk to the robot
+ * over its console port: encodes the messages for the robot and separates the frames it sends
+ * from its console text.
+ */
+
+//! a frame the robot sent, with a valid CRC
+struct HostFrame
+{
+	MessageId id;
+	std::vector<uint8_t> payload;
+};
+
+//! the bytes to send for message, with both delimiters
+template <typename Message>
+std::vector<uint8_t> encodeForRobot(const Message& message)
+{
+	std::array<uint8_t, MaxEncodedFrameSize> encoded;
+	auto size = encodeFrame(message, encoded.data());
+	std::vector<uint8_t> bytes;
+	bytes.reserve(size + 2);
+	bytes.push_back(0);
+	bytes.insert(bytes.end(), encoded.begin(), encoded.begin() + size);
+	bytes.push_back(0);
+	return bytes;
+}
+
+//! \return false if the frame has another message or a payload of the wrong size
+template <typename Message>
+bool decodeHostFrame(const HostFrame& frame, Message& message)
+{
+	return decodeMessage(BinaryFrame{frame.id, frame.payload.data(), frame.payload.size()}, message);
+}
+
+//! splits what the robot sends into frames and console text
+class HostReceiver
+{
+public:
+	void receive(const std::vector<uint8_t>& bytes);
+	void receive(uint8_t byte);
+
+	//! the frames received so far, oldest first, they are removed
+	std::vector<HostFrame> takeFrames();
+	//! the console text received so far, it is removed
+	std::string takeText();
+
+	uint32_t getNofBadFrames() const;
+
+private:
+	void frameCompleted();
+
+	std::vector<HostFrame> frames;
+	std::string text;
+	std::vector<uint8_t> encodedFrame;
+	bool isInFrame = false;
+	uint32_t nofBadFrames = 0;
+};
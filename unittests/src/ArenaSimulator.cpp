@@ -0,0 +1,126 @@
+#include <gmock/gmock.h>
+#include "Benchmark.h"
+
+#include <ArenaSimulator.h>
+#include <cmath>
+
+using namespace testing;
+
+namespace
+{
+	constexpr double Pi = 3.14159265358979323846;
+
+	MatchSetup setupAgainst(OpponentKind opponent, uint32_t seed)
+	{
+		MatchSetup setup;
+		setup.opponent = opponent;
+		setup.seed = seed;
+		return setup;
+	}
+}
+
+TEST(ArenaSimulator, the_line_is_seen_only_over_the_border)
+{
+	ArenaConfig arena;
+	ASSERT_FALSE(seesLine(arena, RobotPose{Vec2{0.0, 0.0}, 0.0}));
+	ASSERT_TRUE(seesLine(arena, RobotPose{Vec2{70.0, 0.0}, 0.0}));
+	ASSERT_FALSE(seesLine(arena, RobotPose{Vec2{70.0, 0.0}, Pi})); //sensors in front, facing the center
+	ASSERT_FALSE(seesLine(arena, RobotPose{Vec2{0.0, 90.0}, 0.0})); //beyond the edge
+}
+
+TEST(ArenaSimulator, the_ultrasonic_measures_the_distance_to_the_surface_in_its_cone)
+{
+	ArenaConfig arena;
+	RobotPose pose{Vec2{0.0, 0.0}, 0.0};
+	ASSERT_THAT(ultrasonicDistanceCm(arena, pose, Vec2{50.0, 0.0}), Eq(40));
+	ASSERT_THAT(ultrasonicDistanceCm(arena, pose, Vec2{50.0, 10.0}), Lt(arena.ultrasonicNoEchoCm));
+	ASSERT_THAT(ultrasonicDistanceCm(arena, pose, Vec2{0.0, 50.0}), Eq(arena.ultrasonicNoEchoCm));
+	ASSERT_THAT(ultrasonicDistanceCm(arena, pose, Vec2{-50.0, 0.0}), Eq(arena.ultrasonicNoEchoCm));
+	ASSERT_THAT(ultrasonicDistanceCm(arena, pose, Vec2{300.0, 0.0}), Eq(arena.ultrasonicNoEchoCm));
+}
+
+TEST(ArenaSimulator, equal_wheel_speeds_drive_straight_and_opposite_ones_turn_on_the_spot)
+{
+	ArenaConfig arena;
+	SimulatedBody body;
+	body.pose = RobotPose{Vec2{0.0, 0.0}, 0.0};
+	for (auto ms = 0; ms < 1000; ++ms)
+	{
+		body.advance(arena, MaxSpeedTicks, MaxSpeedTicks, 1);
+	}
+	//the wheels need some time constants to reach the speed
+	ASSERT_THAT(body.pose.position.x, AllOf(Gt(55.0), Lt(60.0)));
+	ASSERT_THAT(body.pose.position.y, DoubleNear(0.0, 1e-9));
+	ASSERT_THAT(body.pose.headingRad, DoubleNear(0.0, 1e-9));
+
+	auto position = body.pose.position;
+	body = SimulatedBody{};
+	body.pose = RobotPose{position, 0.0};
+	for (auto ms = 0; ms < 100; ++ms)
+	{
+		body.advance(arena, -MaxSpeedTicks / 4, MaxSpeedTicks / 4, 1);
+	}
+	ASSERT_THAT(body.pose.position.x, DoubleNear(position.x, 1e-9));
+	ASSERT_THAT(body.pose.headingRad, Gt(0.1));
+}
+
+TEST(ArenaSimulator, the_body_pushing_less_gives_way)
+{
+	ArenaConfig arena;
+	SimulatedBody pusher;
+	pusher.pose = RobotPose{Vec2{0.0, 0.0}, 0.0};
+	pusher.leftCmPerS = pusher.rightCmPerS = 30.0;
+	SimulatedBody standing;
+	standing.pose = RobotPose{Vec2{9.0, 0.0}, Pi / 2};
+
+	ASSERT_TRUE(resolveContact(arena, pusher, standing, 1));
+	ASSERT_THAT(standing.pose.position.x, DoubleNear(10.0, 0.1));
+	ASSERT_THAT(pusher.pose.position.x, DoubleNear(0.0, 0.1));
+
+	standing.pose.position.x = 20.0;
+	ASSERT_FALSE(resolveContact(arena, pusher, standing, 1));
+}
+
+TEST(ArenaSimulator, a_match_is_reproducible_with_the_same_seed)
+{
+	auto first = runMatch(setupAgainst(OpponentKind::Pusher, 7));
+	auto second = runMatch(setupAgainst(OpponentKind::Pusher, 7));
+	ASSERT_THAT(second.outcome, Eq(first.outcome));
+	ASSERT_THAT(second.durationMs, Eq(first.durationMs));
+	ASSERT_THAT(second.edgeDetections, Eq(first.edgeDetections));
+}
+
+TEST(ArenaSimulator, the_robot_stays_on_an_empty_dohyo)
+{
+	for (auto seed = 0u; seed < 10; ++seed)
+	{
+		auto result = runMatch(setupAgainst(OpponentKind::None, seed));
+		ASSERT_THAT(result.outcome, Eq(MatchOutcome::Draw)) << "seed " << seed;
+		ASSERT_THAT(result.edgeDetections, Gt(0u)) << "seed " << seed;
+	}
+}
+
+TEST(ArenaSimulator, the_robot_pushes_a_static_opponent_out)
+{
+	auto nofWon = 0;
+	for (auto seed = 0u; seed < 20; ++seed)
+	{
+		auto result = runMatch(setupAgainst(OpponentKind::Static, seed));
+		ASSERT_THAT(result.outcome, Ne(MatchOutcome::Lost)) << "seed " << seed;
+		nofWon += result.outcome == MatchOutcome::Won;
+	}
+	ASSERT_THAT(nofWon, Gt(0));
+}
+
+TEST(ArenaSimulator, benchmark_simulated_time_per_wall_clock_time)
+{
+	constexpr auto NofMatches = 20u;
+	auto simulatedMs = uint64_t{0};
+	auto seed = 0u;
+	auto nsPerMatch = measureNsPerRun(NofMatches, [&]{
+		simulatedMs += runMatch(setupAgainst(OpponentKind::Pusher, seed++)).durationMs;
+	});
+	auto nsPerSimulatedMs = nsPerMatch * NofMatches / simulatedMs;
+	reportBenchmark("arena, simulated time per wall clock time", 1e6 / nsPerSimulatedMs, "x");
+	reportBenchmark("arena, matches per second", 1e9 / nsPerMatch, "matches/s");
+}
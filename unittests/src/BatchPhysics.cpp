@@ -0,0 +1,179 @@
+#include <gmock/gmock.h>
+#include "Benchmark.h"
+
+#include <ArenaSimulator.h>
+#include <BatchPhysics.h>
+#include <cmath>
+#include <random>
+
+using namespace testing;
+
+namespace
+{
+	constexpr double Pi = 3.14159265358979323846;
+
+	std::vector<SimdLevel> availableLevels()
+	{
+		std::vector<SimdLevel> levels;
+		for (auto level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx})
+		{
+			if (isSimdLevelAvailable(level))
+			{
+				levels.push_back(level);
+			}
+		}
+		return levels;
+	}
+
+	//! bodies all over the dohyo and a bit beyond, driving at random
+	BodyBatch randomBodies(size_t size, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<double> position(-85.0, 85.0);
+		std::uniform_real_distribution<double> heading(-Pi, Pi);
+		std::uniform_int_distribution<int32_t> speed(-MaxSpeedTicks, MaxSpeedTicks);
+		BodyBatch bodies(size);
+		for (auto lane = size_t{0}; lane < size; ++lane)
+		{
+			bodies.setPose(lane, RobotPose{Vec2{position(random), position(random)}, heading(random)});
+			bodies.commandedLeft[lane] = speed(random);
+			bodies.commandedRight[lane] = speed(random);
+		}
+		return bodies;
+	}
+
+	std::vector<MatchSetup> someMatches(size_t count)
+	{
+		std::vector<MatchSetup> setups(count);
+		for (auto match = size_t{0}; match < count; ++match)
+		{
+			setups[match].opponent = static_cast<OpponentKind>(match % 4);
+			setups[match].seed = match;
+			setups[match].strategy.turningTimeMs = 300 + 100 * (match % 7);
+			setups[match].timeLimitMs = 5000;
+		}
+		return setups;
+	}
+}
+
+TEST(BatchPhysics, the_kernel_follows_the_continuous_model)
+{
+	ArenaConfig arena;
+	SimulatedBody body;
+	body.pose = RobotPose{Vec2{-20.0, 10.0}, 1.0};
+	BodyBatch batch(1);
+	batch.setPose(0, body.pose);
+	//a curve, then turning on the spot
+	for (auto ms = 0; ms < 3000; ++ms)
+	{
+		auto left = ms < 2000 ? MaxSpeedTicks / 2 : -MaxSpeedTicks / 4;
+		auto right = ms < 2000 ? MaxSpeedTicks / 3 : MaxSpeedTicks / 4;
+		body.advance(arena, left, right, 1);
+		batch.commandedLeft[0] = left;
+		batch.commandedRight[0] = right;
+		advanceBodies(arena, batch, 1, SimdLevel::Scalar);
+	}
+	auto pose = batch.getPose(0);
+	ASSERT_THAT(pose.position.x, DoubleNear(body.pose.position.x, 1e-6));
+	ASSERT_THAT(pose.position.y, DoubleNear(body.pose.position.y, 1e-6));
+	ASSERT_THAT(pose.headingRad, DoubleNear(body.pose.headingRad, 1e-9));
+	ASSERT_THAT(batch.getVelocity(0).x, DoubleNear(body.velocity().x, 1e-9));
+}
+
+TEST(BatchPhysics, every_simd_level_gives_the_scalar_results)
+{
+	ArenaConfig arena;
+	constexpr size_t NofBodies = 37; //not a multiple of any width
+	auto reference = randomBodies(NofBodies, 1);
+	auto targets = randomBodies(NofBodies, 2);
+	for (auto ms = 0; ms < 100; ++ms)
+	{
+		advanceBodies(arena, reference, 1, SimdLevel::Scalar);
+	}
+	std::vector<uint8_t> referenceLines;
+	detectLines(arena, reference, referenceLines, SimdLevel::Scalar);
+	std::vector<double> referenceDistances;
+	measureUltrasonic(arena, reference, targets, referenceDistances, SimdLevel::Scalar);
+	ASSERT_THAT(std::count(referenceLines.begin(), referenceLines.begin() + NofBodies, 1), Gt(0));
+	ASSERT_THAT(std::count(referenceDistances.begin(), referenceDistances.begin() + NofBodies, arena.ultrasonicNoEchoCm), Lt(NofBodies));
+
+	for (auto level : availableLevels())
+	{
+		auto bodies = randomBodies(NofBodies, 1);
+		for (auto ms = 0; ms < 100; ++ms)
+		{
+			advanceBodies(arena, bodies, 1, level);
+		}
+		std::vector<uint8_t> lines;
+		detectLines(arena, bodies, lines, level);
+		std::vector<double> distances;
+		measureUltrasonic(arena, bodies, targets, distances, level);
+		for (auto lane = size_t{0}; lane < NofBodies; ++lane)
+		{
+			ASSERT_THAT(bodies.x[lane], Eq(reference.x[lane])) << toString(level) << " lane " << lane;
+			ASSERT_THAT(bodies.y[lane], Eq(reference.y[lane])) << toString(level) << " lane " << lane;
+			ASSERT_THAT(bodies.cosHeading[lane], Eq(reference.cosHeading[lane])) << toString(level) << " lane " << lane;
+			ASSERT_THAT(lines[lane], Eq(referenceLines[lane])) << toString(level) << " lane " << lane;
+			ASSERT_THAT(distances[lane], Eq(referenceDistances[lane])) << toString(level) << " lane " << lane;
+		}
+	}
+}
+
+TEST(BatchPhysics, the_kernels_sense_like_the_single_robot_functions)
+{
+	ArenaConfig arena;
+	constexpr size_t NofBodies = 200;
+	auto bodies = randomBodies(NofBodies, 3);
+	auto targets = randomBodies(NofBodies, 4);
+	std::vector<uint8_t> lines;
+	detectLines(arena, bodies, lines, bestSimdLevel());
+	std::vector<double> distances;
+	measureUltrasonic(arena, bodies, targets, distances, bestSimdLevel());
+	for (auto lane = size_t{0}; lane < NofBodies; ++lane)
+	{
+		auto pose = RobotPose{bodies.getPosition(lane), std::atan2(bodies.sinHeading[lane], bodies.cosHeading[lane])};
+		ASSERT_THAT(lines[lane] != 0, Eq(seesLine(arena, pose))) << "lane " << lane;
+		ASSERT_THAT(std::lround(distances[lane]), Eq(ultrasonicDistanceCm(arena, pose, targets.getPosition(lane)))) << "lane " << lane;
+	}
+}
+
+TEST(BatchPhysics, a_batch_plays_every_match_like_a_single_one)
+{
+	auto setups = someMatches(13);
+	std::vector<MatchResult> singles;
+	for (const auto& setup : setups)
+	{
+		singles.push_back(runMatch(setup));
+	}
+
+	for (auto level : availableLevels())
+	{
+		for (auto batchSize : {size_t{1}, size_t{4}, size_t{5}, size_t{64}})
+		{
+			auto batch = runMatchBatch(setups, batchSize, level);
+			ASSERT_THAT(batch.size(), Eq(setups.size()));
+			for (auto match = size_t{0}; match < setups.size(); ++match)
+			{
+				ASSERT_THAT(batch[match].outcome, Eq(singles[match].outcome)) << toString(level) << " batch " << batchSize << " match " << match;
+				ASSERT_THAT(batch[match].durationMs, Eq(singles[match].durationMs)) << toString(level) << " batch " << batchSize << " match " << match;
+				ASSERT_THAT(batch[match].edgeDetections, Eq(singles[match].edgeDetections)) << toString(level) << " batch " << batchSize << " match " << match;
+				ASSERT_THAT(batch[match].pushedOut, Eq(singles[match].pushedOut)) << toString(level) << " batch " << batchSize << " match " << match;
+			}
+		}
+	}
+	ASSERT_THAT(runMatchBatch({}, 8), IsEmpty());
+}
+
+TEST(BatchPhysics, benchmark_matches_per_second)
+{
+	auto setups = someMatches(64);
+	for (auto level : availableLevels())
+	{
+		for (auto batchSize : {size_t{1}, size_t{8}, size_t{32}})
+		{
+			auto nsPerRun = measureNsPerRun(1, [&]{ runMatchBatch(setups, batchSize, level); });
+			reportBenchmark(std::string("arena batch of ") + std::to_string(batchSize) + ", " + toString(level),
+				setups.size() * 1e9 / nsPerRun, "matches/s");
+		}
+	}
+}
@@ -1,7 +1,12 @@
 #include <gmock/gmock.h>
 #include "TestAssert.h"
+#include "Benchmark.h"
 
 #include <BehaviourMachine.h>
+#include <CommonTraits.h>
+#include <array>
+#include <limits>
+#include <string>
 #include <tuple>
 
 using namespace testing;
@@ -95,3 +100,228 @@ TEST(BehaviourMachineTest, when_loosing_prio_then_step_without_suppress_will_not
 	arbitrator.step();
 	ASSERT_THAT(lowPrioCounter, Eq(1));
 }
+
+namespace
+{
+	class CountingBehaviour
+	{
+	public:
+		CountingBehaviour(uint32_t& askedCounter, bool& takeControl)
+			: askedCounter(askedCounter)
+			, takeControl(takeControl)
+		{
+		}
+
+		bool wantsToTakeControl() const
+		{
+			++askedCounter;
+			return takeControl;
+		}
+
+		void step(bool /*suppress*/)
+		{
+		}
+
+	private:
+		uint32_t& askedCounter;
+		bool& takeControl;
+	};
+}
+
+TEST(BehaviourMachineTest, lower_priorities_are_not_asked_once_a_higher_one_takes_control)
+{
+	std::array<uint32_t, 3> asked{};
+	bool lowPrioControl = true;
+	bool midPrioControl = true;
+	bool highPrioControl = false;
+
+	auto arbitrator = makeArbitrator(std::make_tuple(
+		CountingBehaviour(asked[0], lowPrioControl),
+		CountingBehaviour(asked[1], midPrioControl),
+		CountingBehaviour(asked[2], highPrioControl)
+	));
+
+	arbitrator.step();
+	ASSERT_THAT(asked, ElementsAre(0, 1, 1));
+
+	midPrioControl = false;
+	arbitrator.step();
+	ASSERT_THAT(asked, ElementsAre(1, 2, 2));
+}
+
+TEST(BehaviourMachineTest, the_suppressed_behaviour_is_stepped_once_when_losing_control)
+{
+	uint32_t lowPrioCounter = 0;
+	uint32_t lowPrioSuppressCounter = 0;
+	bool lowPrioControl = true;
+	uint32_t highPrioCounter = 0;
+	uint32_t highPrioSuppressCounter = 0;
+	bool highPrioControl = false;
+
+	auto arbitrator = makeArbitrator(std::make_tuple(
+		TestBehaviour(lowPrioCounter, lowPrioSuppressCounter, lowPrioControl),
+		TestBehaviour(highPrioCounter, highPrioSuppressCounter, highPrioControl)
+	));
+
+	arbitrator.step();
+	highPrioControl = true;
+	arbitrator.step();
+	arbitrator.step();
+	ASSERT_THAT(lowPrioCounter, Eq(1));
+	ASSERT_THAT(lowPrioSuppressCounter, Eq(1));
+	ASSERT_THAT(highPrioCounter, Eq(2));
+	ASSERT_THAT(highPrioSuppressCounter, Eq(0));
+}
+
+TEST(BehaviourMachineTest, decide_does_not_step_until_act)
+{
+	uint32_t lowPrioCounter = 0;
+	uint32_t lowPrioSuppressCounter = 0;
+	bool lowPrioControl = true;
+	uint32_t highPrioCounter = 0;
+	uint32_t dummy;
+	bool highPrioControl = false;
+
+	auto arbitrator = makeArbitrator(std::make_tuple(
+		TestBehaviour(lowPrioCounter, lowPrioSuppressCounter, lowPrioControl),
+		TestBehaviour(highPrioCounter, dummy, highPrioControl)
+	));
+
+	ASSERT_THAT(arbitrator.decide(), Eq(0));
+	ASSERT_THAT(lowPrioCounter, Eq(0));
+	arbitrator.act();
+	ASSERT_THAT(lowPrioCounter, Eq(1));
+
+	highPrioControl = true;
+	ASSERT_THAT(arbitrator.decide(), Eq(1));
+	ASSERT_THAT(lowPrioSuppressCounter, Eq(0));
+	arbitrator.act();
+	ASSERT_THAT(lowPrioSuppressCounter, Eq(1));
+	ASSERT_THAT(highPrioCounter, Eq(1));
+
+	highPrioControl = false;
+	lowPrioControl = false;
+	ASSERT_THAT(arbitrator.decide(), Eq(std::numeric_limits<uint8_t>::max()));
+}
+
+namespace
+{
+	/**
+	 * the Arbitrator before it stopped at the first claimant: asks every behaviour, then searches
+	 * the one to step linearly
+	 */
+	template <typename... Behaviours>
+	class AskAllArbitrator
+	{
+	public:
+		explicit AskAllArbitrator(std::tuple<Behaviours...> behaviours)
+			: behaviours(std::move(behaviours))
+		{
+		}
+
+		void step()
+		{
+			uint8_t newIndex = std::numeric_limits<uint8_t>::max();
+			findBehaviourThatWantsToTakeControl(newIndex);
+			if (currentBehaviour != newIndex)
+			{
+				stepBehaviour(currentBehaviour, true);
+				currentBehaviour = newIndex;
+			}
+			stepBehaviour(currentBehaviour, false);
+		}
+
+	private:
+		template <std::size_t I = 0>
+		typename std::enable_if<(I == sizeof...(Behaviours))>::type findBehaviourThatWantsToTakeControl(uint8_t& /*index*/) {}
+
+		template <std::size_t I = 0>
+		typename std::enable_if<(I < sizeof...(Behaviours))>::type findBehaviourThatWantsToTakeControl(uint8_t& index)
+		{
+			if (std::get<I>(behaviours).wantsToTakeControl())
+			{
+				index = I;
+			}
+			findBehaviourThatWantsToTakeControl<I + 1>(index);
+		}
+
+		template <std::size_t I = 0>
+		typename std::enable_if<(I == sizeof...(Behaviours))>::type stepBehaviour(uint8_t /*index*/, bool /*suppress*/) {}
+
+		template <std::size_t I = 0>
+		typename std::enable_if<(I < sizeof...(Behaviours))>::type stepBehaviour(uint8_t index, bool suppress)
+		{
+			if (index == I)
+			{
+				std::get<I>(behaviours).step(suppress);
+				return;
+			}
+			stepBehaviour<I + 1>(index, suppress);
+		}
+
+		uint8_t currentBehaviour = 0;
+		std::tuple<Behaviours...> behaviours;
+	};
+
+	/**
+	 * distinct type per priority like the behaviours of MainControl, which claims control when
+	 * its sensor value is above its threshold
+	 */
+	template <std::size_t Priority>
+	class BenchmarkBehaviour
+	{
+	public:
+		explicit BenchmarkBehaviour(const volatile uint32_t& sensorValue)
+			: sensorValue(sensorValue)
+		{
+		}
+
+		bool wantsToTakeControl() const
+		{
+			return sensorValue > Priority * 16 + 8;
+		}
+
+		void step(bool suppress)
+		{
+			steps += suppress ? 0 : 1;
+		}
+
+		uint32_t steps = 0;
+
+	private:
+		const volatile uint32_t& sensorValue;
+	};
+
+	template <template <typename...> class ArbitratorType, std::size_t... Priorities>
+	ArbitratorType<BenchmarkBehaviour<Priorities>...> makeBenchmarkArbitrator(const volatile uint32_t& sensorValue, IndexSequence<Priorities...>)
+	{
+		return ArbitratorType<BenchmarkBehaviour<Priorities>...>(std::make_tuple(BenchmarkBehaviour<Priorities>(sensorValue)...));
+	}
+
+	template <template <typename...> class ArbitratorType, std::size_t NofBehaviours>
+	double measureStep(uint32_t claimingPriority)
+	{
+		volatile uint32_t sensorValue = claimingPriority * 16 + 9; //claimingPriority and all below claim control
+		auto arbitrator = makeBenchmarkArbitrator<ArbitratorType>(sensorValue, MakeIndexSequence<NofBehaviours>{});
+		return measureCyclesPerRun(1000000, [&] { arbitrator.step(); });
+	}
+
+	template <std::size_t NofBehaviours>
+	void benchmarkArbitrator()
+	{
+		auto name = std::to_string(NofBehaviours) + " behaviours, ";
+		for (auto claimingPriority : {uint32_t{NofBehaviours - 1}, uint32_t{NofBehaviours / 2}, uint32_t{0}})
+		{
+			auto claimant = "priority " + std::to_string(claimingPriority) + " in control";
+			reportBenchmark("ask all, " + name + claimant, measureStep<AskAllArbitrator, NofBehaviours>(claimingPriority), "cycles/step");
+			reportBenchmark("Arbitrator, " + name + claimant, measureStep<Arbitrator, NofBehaviours>(claimingPriority), "cycles/step");
+		}
+	}
+}
+
+TEST(BehaviourMachineTest, benchmark_step)
+{
+	benchmarkArbitrator<5>();
+	benchmarkArbitrator<10>();
+	benchmarkArbitrator<20>();
+}
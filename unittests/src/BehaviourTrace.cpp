@@ -0,0 +1,230 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+#include "BehaviourTraceDecoder.h"
+
+#include <BehaviourMachine.h>
+#include <BehaviourTrace.h>
+#include <limits>
+
+using namespace testing;
+
+namespace
+{
+	struct EmptyLock
+	{
+	};
+
+	uint32_t fakeTimeUs = 0;
+	uint32_t nofActuations = 0;
+
+	struct FakeClock
+	{
+		static uint32_t nowUs()
+		{
+			return fakeTimeUs;
+		}
+	};
+
+	using Trace = BehaviourTrace<2, 8, FakeClock, EmptyLock>;
+
+	//! like MainControl: forwards to a global trace and takes the inputs and actuations from globals
+	Trace* pTrace = nullptr;
+	uint8_t inputFlags = 0;
+
+	struct TestTracer
+	{
+		void switched(uint8_t from, uint8_t to)
+		{
+			BehaviourInputs inputs;
+			inputs.flags = inputFlags;
+			inputs.value = 42;
+			pTrace->switched(from, to, inputs);
+		}
+
+		void stepped(uint8_t behaviour, bool suppressed)
+		{
+			pTrace->stepped(behaviour, suppressed, nofActuations);
+		}
+	};
+
+	/**
+	 * takes control while its flag is set, actuates at the stepsUntilActuation-th step, and
+	 * on suppression
+	 */
+	class ActuatingBehaviour
+	{
+	public:
+		ActuatingBehaviour(bool& takeControl, uint32_t stepsUntilActuation)
+			: takeControl(takeControl)
+			, stepsUntilActuation(stepsUntilActuation)
+		{
+		}
+
+		bool wantsToTakeControl() const
+		{
+			return takeControl;
+		}
+
+		void step(bool suppress)
+		{
+			if (suppress)
+			{
+				steps = 0;
+				++nofActuations;
+			}
+			else if (++steps >= stepsUntilActuation)
+			{
+				++nofActuations;
+			}
+		}
+
+	private:
+		bool& takeControl;
+		uint32_t stepsUntilActuation;
+		uint32_t steps = 0;
+	};
+
+	struct TraceTest : public Test
+	{
+		TraceTest()
+		{
+			fakeTimeUs = 0;
+			nofActuations = 0;
+			inputFlags = 0;
+			pTrace = &trace;
+		}
+
+		std::string dump() const
+		{
+			std::array<BehaviourTransitionRecord, 8> records;
+			auto count = trace.copyTransitions(records);
+			std::array<LatencyHistogram, 2> latencies{{ trace.getLatencies(0), trace.getLatencies(1) }};
+			std::string text;
+			auto ioStream = makeFnIoStream([&](char c){ text.push_back(c); }, []{ return optional<char>{}; });
+			writeBehaviourTrace(ioStream, records.data(), count, latencies);
+			return text;
+		}
+
+		Trace trace;
+	};
+}
+
+TEST(BehaviourTrace, a_record_survives_encoding_and_decoding)
+{
+	BehaviourTransitionRecord record;
+	record.timestampUs = 0x12345678;
+	record.from = 3;
+	record.to = std::numeric_limits<uint8_t>::max();
+	record.inputs.flags = 0x5;
+	record.inputs.value = 0x1234;
+
+	uint8_t encoded[BehaviourTransitionRecord::EncodedSize];
+	record.encode(encoded);
+	ASSERT_THAT(encoded, ElementsAre(0x78, 0x56, 0x34, 0x12, 3, 0xff, 0x5, 0, 0x34, 0x12));
+
+	auto decoded = BehaviourTransitionRecord::decode(encoded);
+	ASSERT_THAT(decoded.timestampUs, Eq(0x12345678u));
+	ASSERT_THAT(decoded.from, Eq(3));
+	ASSERT_THAT(decoded.to, Eq(0xff));
+	ASSERT_THAT(decoded.inputs.flags, Eq(0x5));
+	ASSERT_THAT(decoded.inputs.value, Eq(0x1234));
+}
+
+TEST_F(TraceTest, every_switch_is_recorded_with_the_inputs)
+{
+	bool lowControl = true;
+	bool highControl = false;
+	auto arbitrator = makeTracedArbitrator<TestTracer>(std::make_tuple(
+		ActuatingBehaviour(lowControl, 1),
+		ActuatingBehaviour(highControl, 1)
+	));
+
+	fakeTimeUs = 100;
+	arbitrator.step();
+	arbitrator.step(); //no switch
+	highControl = true;
+	inputFlags = 0x1;
+	fakeTimeUs = 200;
+	arbitrator.step();
+
+	auto records = decodeBehaviourTransitions(dump());
+	ASSERT_THAT(records.size(), Eq(1));
+	ASSERT_THAT(records[0].timestampUs, Eq(200u));
+	ASSERT_THAT(records[0].from, Eq(0));
+	ASSERT_THAT(records[0].to, Eq(1));
+	ASSERT_THAT(records[0].inputs.flags, Eq(0x1));
+	ASSERT_THAT(records[0].inputs.value, Eq(42));
+}
+
+TEST_F(TraceTest, the_latency_is_measured_until_the_new_behaviour_actuates)
+{
+	bool lowControl = true;
+	bool highControl = false;
+	auto arbitrator = makeTracedArbitrator<TestTracer>(std::make_tuple(
+		ActuatingBehaviour(lowControl, 1),
+		ActuatingBehaviour(highControl, 2) //like StopBehaviour, which reverses in its second step
+	));
+	arbitrator.step();
+
+	fakeTimeUs = 1000;
+	trace.stimulus(fakeTimeUs);
+	highControl = true;
+	fakeTimeUs = 1100;
+	arbitrator.step(); //suppresses the low priority one, which stops the motors: not the reaction
+	ASSERT_THAT(trace.getLatencies(1).count, Eq(0));
+
+	trace.stimulus(1200); //doesn't replace the pending one
+	fakeTimeUs = 6100;
+	arbitrator.step();
+
+	auto latencies = trace.getLatencies(1);
+	ASSERT_THAT(latencies.count, Eq(1));
+	ASSERT_THAT(latencies.maxUs, Eq(5100u));
+	ASSERT_THAT(latencies.buckets[LatencyHistogram::bucketOf(5100)], Eq(1));
+	ASSERT_THAT(trace.getLatencies(0).count, Eq(0));
+
+	//without a stimulus, actuating is no reaction
+	fakeTimeUs = 7000;
+	arbitrator.step();
+	ASSERT_THAT(trace.getLatencies(1).count, Eq(1));
+}
+
+TEST_F(TraceTest, latencies_are_decoded_on_the_host)
+{
+	bool lowControl = true;
+	bool highControl = false;
+	auto arbitrator = makeTracedArbitrator<TestTracer>(std::make_tuple(
+		ActuatingBehaviour(lowControl, 1),
+		ActuatingBehaviour(highControl, 1)
+	));
+	for (auto latencyUs : {3u, 300u, 301u})
+	{
+		fakeTimeUs += 10000;
+		trace.stimulus(fakeTimeUs);
+		fakeTimeUs += latencyUs;
+		arbitrator.step();
+	}
+
+	auto text = dump();
+	ASSERT_THAT(text, HasSubstr("bhlatency 0 3 301 "));
+	auto latencies = decodeBehaviourLatencies("noise\r\n" + text);
+	ASSERT_THAT(latencies.size(), Eq(1));
+	ASSERT_THAT(latencies[0].count, Eq(3));
+	ASSERT_THAT(latencies[0].maxUs, Eq(301u));
+	ASSERT_THAT(toString(latencies[0]), Eq("<4us: 1\n<512us: 2\n"));
+}
+
+TEST_F(TraceTest, clear_removes_transitions_and_latencies)
+{
+	bool control = true;
+	auto arbitrator = makeTracedArbitrator<TestTracer>(std::make_tuple(ActuatingBehaviour(control, 1)));
+	trace.stimulus(0);
+	arbitrator.step();
+	control = false;
+	arbitrator.step();
+	ASSERT_THAT(decodeBehaviourTransitions(dump()).size(), Eq(1));
+
+	trace.clear();
+	ASSERT_THAT(decodeBehaviourTransitions(dump()), IsEmpty());
+	ASSERT_THAT(trace.getLatencies(0).count, Eq(0));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "EventTraceDecoder.h"
+
+#include <BehaviourTrace.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Host side decoder for the transitions written by writeBehaviourTrace() (console command bhdump).
+ */
+inline std::vector<BehaviourTransitionRecord> decodeBehaviourTransitions(const std::string& dump)
+{
+	return decodeTrace<BehaviourTransitionRecord>(dump);
+}
+
+/**
+ * Host side decoder for the "bhlatency" lines written by writeBehaviourTrace(), per behaviour.
+ */
+inline std::map<uint8_t, LatencyHistogram> decodeBehaviourLatencies(const std::string& dump)
+{
+	std::map<uint8_t, LatencyHistogram> histograms;
+	std::istringstream lines(dump);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		std::istringstream fields(line);
+		std::string name;
+		uint32_t behaviour;
+		LatencyHistogram histogram;
+		if (!(fields >> name >> behaviour >> histogram.count >> histogram.maxUs) || name != "bhlatency")
+		{
+			continue;
+		}
+		for (auto& bucket : histogram.buckets)
+		{
+			fields >> bucket;
+		}
+		if (fields)
+		{
+			histograms[static_cast<uint8_t>(behaviour)] = histogram;
+		}
+	}
+	return histograms;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * runs fn the given amount of times and returns the average duration of one run in nanoseconds
+ */
+template <typename Fn>
+double measureNsPerRun(size_t runs, Fn fn)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (auto i = size_t{0}; i < runs; ++i)
+	{
+		fn();
+	}
+	auto duration = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double, std::nano>(duration).count() / runs;
+}
+
+/**
+ * runs fn the given amount of times and returns the average amount of cpu cycles of one run
+ * (time stamp counter on x86, nanoseconds elsewhere)
+ */
+template <typename Fn>
+double measureCyclesPerRun(size_t runs, Fn fn)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	auto start = __rdtsc();
+	for (auto i = size_t{0}; i < runs; ++i)
+	{
+		fn();
+	}
+	return static_cast<double>(__rdtsc() - start) / runs;
+#else
+	return measureNsPerRun(runs, fn);
+#endif
+}
+
+/**
+ * prints a benchmark result in the same style as the gtest output
+ */
+inline void reportBenchmark(const std::string& name, double value, const std::string& unit)
+{
+	std::cout << "[ BENCH    ] " << name << ": " << value << " " << unit << std::endl;
+}
@@ -0,0 +1,419 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+#include "Benchmark.h"
+
+#include <BinaryProtocol.h>
+#include <AutoArgsCommand.h>
+#include <CommandParser.h>
+#include <Console.h>
+#include <HostLink.h>
+#include <LineEndingNormalizerIOStream.h>
+#include <LineInputStrategy.h>
+#include <deque>
+#include <numeric>
+#include <random>
+
+using namespace testing;
+
+namespace
+{
+	//! the serial line between the host and the robot
+	struct Wire
+	{
+		std::deque<char> toRobot;
+		std::vector<uint8_t> fromRobot;
+
+		void send(const std::vector<uint8_t>& bytes)
+		{
+			toRobot.insert(toRobot.end(), bytes.begin(), bytes.end());
+		}
+
+		void send(const std::string& text)
+		{
+			toRobot.insert(toRobot.end(), text.begin(), text.end());
+		}
+
+		std::vector<uint8_t> takeFromRobot()
+		{
+			std::vector<uint8_t> taken;
+			std::swap(taken, fromRobot);
+			return taken;
+		}
+	};
+
+	//! the end of the wire at the robot, like CdcStaticIOStream
+	class RobotWireEnd
+	{
+	public:
+		explicit RobotWireEnd(Wire* pWire = nullptr)
+			: pWire(pWire)
+		{
+		}
+
+		optional<char> readChar()
+		{
+			if (pWire->toRobot.empty())
+			{
+				return {};
+			}
+			auto c = pWire->toRobot.front();
+			pWire->toRobot.pop_front();
+			return c;
+		}
+
+		void writeChar(char c)
+		{
+			pWire->fromRobot.push_back(static_cast<uint8_t>(c));
+		}
+
+	private:
+		Wire* pWire;
+	};
+
+	struct TestHandler
+	{
+		void received(BinaryChannel& channel, const binmsg::Ping& ping)
+		{
+			channel.send(binmsg::Pong{ping.sequence});
+		}
+
+		void received(BinaryChannel& channel, const binmsg::SetSpeedPid& pid)
+		{
+			pids.push_back(pid);
+			channel.send(binmsg::Ack{static_cast<uint8_t>(MessageId::SetSpeedPid), 1});
+		}
+
+		template <typename Message>
+		void received(BinaryChannel& /*channel*/, const Message& /*message*/)
+		{
+			++nofOthers;
+		}
+
+		std::vector<binmsg::SetSpeedPid> pids;
+		uint32_t nofOthers = 0;
+	};
+
+	using RobotStream = BinaryFramingIOStream<RobotWireEnd, TestHandler>;
+
+	//! what the robot reads as text
+	std::string readText(IOStream& stream)
+	{
+		std::string text;
+		for (auto c = stream.readChar(); c; c = stream.readChar())
+		{
+			text.push_back(*c);
+		}
+		return text;
+	}
+
+	std::vector<uint8_t> cobs(const std::vector<uint8_t>& data)
+	{
+		std::vector<uint8_t> encoded(cobsMaxEncodedSize(data.size()));
+		encoded.resize(cobsEncode(data.data(), data.size(), encoded.data()));
+		return encoded;
+	}
+
+	//! the same bytes for every run of a benchmark
+	struct Replay
+	{
+		std::vector<uint8_t> bytes;
+		size_t pos = 0;
+		size_t nofWritten = 0;
+	};
+
+	class ReplayWireEnd
+	{
+	public:
+		explicit ReplayWireEnd(Replay* pReplay = nullptr)
+			: pReplay(pReplay)
+		{
+		}
+
+		optional<char> readChar()
+		{
+			if (pReplay->pos == pReplay->bytes.size())
+			{
+				return {};
+			}
+			return static_cast<char>(pReplay->bytes[pReplay->pos++]);
+		}
+
+		void writeChar(char /*c*/)
+		{
+			++pReplay->nofWritten;
+		}
+
+	private:
+		Replay* pReplay;
+	};
+
+	struct CountingHandler
+	{
+		void received(BinaryChannel& channel, const binmsg::SetSpeedPid& /*pid*/)
+		{
+			++nofCalls;
+			channel.send(binmsg::Ack{static_cast<uint8_t>(MessageId::SetSpeedPid), 1});
+		}
+
+		template <typename Message>
+		void received(BinaryChannel& /*channel*/, const Message& /*message*/)
+		{
+		}
+
+		uint32_t nofCalls = 0;
+	};
+
+	binmsg::SetSpeedPid somePid()
+	{
+		return binmsg::SetSpeedPid{1, 600, -40, 0, 120000};
+	}
+}
+
+TEST(Cobs, encodes_like_the_reference)
+{
+	ASSERT_THAT(cobs({0x00}), ElementsAre(0x01, 0x01));
+	ASSERT_THAT(cobs({0x00, 0x00}), ElementsAre(0x01, 0x01, 0x01));
+	ASSERT_THAT(cobs({0x11, 0x22, 0x00, 0x33}), ElementsAre(0x03, 0x11, 0x22, 0x02, 0x33));
+	ASSERT_THAT(cobs({0x11, 0x22, 0x33, 0x44}), ElementsAre(0x05, 0x11, 0x22, 0x33, 0x44));
+
+	std::vector<uint8_t> nonZero(254);
+	std::iota(nonZero.begin(), nonZero.end(), 1);
+	auto encoded = cobs(nonZero);
+	ASSERT_THAT(encoded.size(), Eq(255));
+	ASSERT_THAT(encoded[0], Eq(0xff));
+
+	nonZero.push_back(0xff);
+	encoded = cobs(nonZero);
+	ASSERT_THAT(encoded.size(), Eq(257));
+	ASSERT_THAT(encoded[255], Eq(0x02));
+}
+
+TEST(Cobs, decoding_gives_the_encoded_data)
+{
+	std::mt19937 random(5);
+	std::uniform_int_distribution<int> byte(0, 3); //many zeros
+	for (auto size : {0, 1, 2, 253, 254, 255, 600})
+	{
+		std::vector<uint8_t> data(size);
+		for (auto& value : data)
+		{
+			value = static_cast<uint8_t>(byte(random) == 0 ? 0 : random());
+		}
+		auto encoded = cobs(data);
+		ASSERT_THAT(std::count(encoded.begin(), encoded.end(), 0), Eq(0)) << size;
+		ASSERT_THAT(encoded.size(), Le(cobsMaxEncodedSize(data.size()))) << size;
+
+		auto decodedSize = cobsDecode(encoded.data(), encoded.size(), encoded.data());
+		ASSERT_TRUE(decodedSize.is_initialized()) << size;
+		encoded.resize(*decodedSize);
+		ASSERT_THAT(encoded, Eq(data)) << size;
+	}
+}
+
+TEST(Cobs, broken_encodings_are_rejected)
+{
+	std::vector<uint8_t> frame{0x05, 0x11, 0x22};
+	ASSERT_FALSE(cobsDecode(frame.data(), frame.size(), frame.data()).is_initialized());
+	frame = {0x03, 0x11, 0x00};
+	ASSERT_FALSE(cobsDecode(frame.data(), frame.size(), frame.data()).is_initialized());
+}
+
+TEST(Crc16, has_the_check_value_of_ccitt_false)
+{
+	const char check[] = "123456789";
+	ASSERT_THAT(crc16Ccitt(reinterpret_cast<const uint8_t*>(check), 9), Eq(0x29b1));
+}
+
+TEST(BinaryProtocol, messages_keep_their_fields)
+{
+	auto pid = binmsg::SetSpeedPid{1, -1, 0x7fffffff, static_cast<int32_t>(0x80000000), 0x01000000};
+	auto bytes = encodeForRobot(pid);
+	ASSERT_THAT(std::count(bytes.begin() + 1, bytes.end() - 1, 0), Eq(0));
+
+	HostReceiver receiver;
+	receiver.receive(bytes);
+	auto frames = receiver.takeFrames();
+	ASSERT_THAT(frames.size(), Eq(1));
+	ASSERT_THAT(frames[0].id, Eq(MessageId::SetSpeedPid));
+	ASSERT_THAT(frames[0].payload.size(), Eq(payloadSizeOf<binmsg::SetSpeedPid>()));
+
+	binmsg::SetSpeedPid decoded{};
+	ASSERT_TRUE(decodeHostFrame(frames[0], decoded));
+	ASSERT_THAT(decoded.isLeft, Eq(1));
+	ASSERT_THAT(decoded.pFactor100, Eq(-1));
+	ASSERT_THAT(decoded.iFactor100, Eq(0x7fffffff));
+	ASSERT_THAT(decoded.dFactor100, Eq(static_cast<int32_t>(0x80000000)));
+	ASSERT_THAT(decoded.iAntiWindup, Eq(0x01000000));
+
+	binmsg::Ping ping{};
+	ASSERT_FALSE(decodeHostFrame(frames[0], ping));
+}
+
+TEST(BinaryProtocol, text_passes_in_console_mode)
+{
+	Wire wire;
+	RobotStream robot{RobotWireEnd{&wire}};
+	wire.send(std::string{"help\n"});
+	ASSERT_THAT(readText(robot), Eq("help\n"));
+	robot.write("ok");
+	ASSERT_THAT(wire.takeFromRobot(), ElementsAre('o', 'k'));
+	ASSERT_FALSE(robot.isBinaryMode());
+}
+
+TEST(BinaryProtocol, a_frame_switches_to_binary_mode_and_is_answered)
+{
+	Wire wire;
+	RobotStream robot{RobotWireEnd{&wire}};
+	wire.send(std::string{"ab"});
+	wire.send(encodeForRobot(binmsg::Ping{0x12340000}));
+	wire.send(encodeForRobot(somePid()));
+	ASSERT_THAT(readText(robot), Eq("ab"));
+	ASSERT_TRUE(robot.isBinaryMode());
+	robot.write("dropped in binary mode");
+
+	HostReceiver host;
+	host.receive(wire.takeFromRobot());
+	ASSERT_THAT(host.takeText(), Eq(""));
+	auto frames = host.takeFrames();
+	ASSERT_THAT(frames.size(), Eq(2));
+	binmsg::Pong pong{};
+	ASSERT_TRUE(decodeHostFrame(frames[0], pong));
+	ASSERT_THAT(pong.sequence, Eq(0x12340000u));
+	binmsg::Ack ack{};
+	ASSERT_TRUE(decodeHostFrame(frames[1], ack));
+	ASSERT_THAT(ack.messageId, Eq(static_cast<uint8_t>(MessageId::SetSpeedPid)));
+
+	ASSERT_THAT(robot.getHandler().pids.size(), Eq(1));
+	ASSERT_THAT(robot.getHandler().pids[0].iFactor100, Eq(-40));
+	ASSERT_THAT(robot.getNofBadFrames(), Eq(0u));
+}
+
+TEST(BinaryProtocol, leave_binary_mode_switches_back_to_text)
+{
+	Wire wire;
+	RobotStream robot{RobotWireEnd{&wire}};
+	wire.send(encodeForRobot(binmsg::Ping{1}));
+	wire.send(encodeForRobot(binmsg::LeaveBinaryMode{}));
+	wire.send(std::string{"status\n"});
+	ASSERT_THAT(readText(robot), Eq("status\n"));
+	ASSERT_FALSE(robot.isBinaryMode());
+	robot.write("text");
+
+	HostReceiver host;
+	host.receive(wire.takeFromRobot());
+	ASSERT_THAT(host.takeFrames().size(), Eq(1));
+	ASSERT_THAT(host.takeText(), Eq("text"));
+}
+
+TEST(BinaryProtocol, a_broken_frame_switches_back_to_text)
+{
+	Wire wire;
+	RobotStream robot{RobotWireEnd{&wire}};
+	auto frame = encodeForRobot(somePid());
+	frame[4] = (frame[4] == 0x55) ? 0x56 : 0x55;
+	wire.send(frame);
+	wire.send(std::string{"x"});
+	ASSERT_THAT(readText(robot), Eq("x"));
+	ASSERT_FALSE(robot.isBinaryMode());
+	ASSERT_THAT(robot.getNofBadFrames(), Eq(1u));
+	ASSERT_THAT(robot.getHandler().pids, IsEmpty());
+}
+
+TEST(BinaryProtocol, unknown_messages_are_counted_and_stay_in_binary_mode)
+{
+	Wire wire;
+	RobotStream robot{RobotWireEnd{&wire}};
+	std::vector<uint8_t> unknown{0x7e, 1, 2};
+	auto crc = crc16Ccitt(unknown.data(), unknown.size());
+	unknown.push_back(static_cast<uint8_t>(crc));
+	unknown.push_back(static_cast<uint8_t>(crc >> 8));
+	auto encoded = cobs(unknown);
+	encoded.insert(encoded.begin(), 0);
+	encoded.push_back(0);
+	wire.send(encoded);
+	wire.send(encodeForRobot(binmsg::TachoSpeeds{1, 2, 3}));
+	readText(robot);
+	ASSERT_TRUE(robot.isBinaryMode());
+	ASSERT_THAT(robot.getNofBadFrames(), Eq(1u));
+	ASSERT_THAT(robot.getHandler().nofOthers, Eq(1u));
+}
+
+TEST(BinaryProtocol, an_overlong_frame_switches_back_to_text_without_its_delimiter)
+{
+	Wire wire;
+	RobotStream robot{RobotWireEnd{&wire}};
+	wire.send(std::vector<uint8_t>{0});
+	wire.send(std::vector<uint8_t>(MaxEncodedFrameSize, 'a'));
+	readText(robot);
+	ASSERT_TRUE(robot.isBinaryMode());
+
+	wire.send(std::string{"ay\n"}); //one byte too many, no delimiter follows
+	ASSERT_THAT(readText(robot), Eq("y\n"));
+	ASSERT_FALSE(robot.isBinaryMode());
+	ASSERT_THAT(robot.getNofBadFrames(), Eq(1u));
+	robot.write("ok");
+	ASSERT_THAT(wire.takeFromRobot(), ElementsAre('o', 'k'));
+}
+
+TEST(BinaryProtocol, frames_pass_below_the_console)
+{
+	Wire wire;
+	std::vector<std::string> executed;
+	auto parser = makeParser(cmd("go", [&](uint8_t speed){ executed.push_back("go " + std::to_string(speed)); }));
+	auto console = makeConsole(
+		LineEndingNormalizerIOStream<RobotStream>{RobotStream{RobotWireEnd{&wire}}},
+		makeLineInputStrategy<20>(CommandExecutorLineSink{&parser})
+	);
+
+	wire.send(std::string{"go 5\r"});
+	wire.send(encodeForRobot(binmsg::Ping{13}));	//has a '\r' in its CRC
+	wire.send(encodeForRobot(binmsg::LeaveBinaryMode{}));
+	wire.send(std::string{"go 7\r"});
+	while (!wire.toRobot.empty())
+	{
+		console.pollInput();
+	}
+
+	ASSERT_THAT(executed, ElementsAre("go 5", "go 7"));
+	HostReceiver host;
+	host.receive(wire.takeFromRobot());
+	auto frames = host.takeFrames();
+	ASSERT_THAT(frames.size(), Eq(1));
+	ASSERT_THAT(frames[0].id, Eq(MessageId::Pong));
+}
+
+TEST(BinaryProtocol, benchmark_binary_against_text_commands)
+{
+	//the whole way from the received bytes to the call, with the echo or the answer
+	Replay binary;
+	binary.bytes = encodeForRobot(somePid());
+	BinaryFramingIOStream<ReplayWireEnd, CountingHandler> robot{ReplayWireEnd{&binary}};
+	auto nsPerFrame = measureNsPerRun(100000, [&]
+	{
+		binary.pos = 0;
+		robot.readChar();
+	});
+
+	auto nofCalls = 0;
+	auto parser = makeParser(cmd("pidspeed", [&](uint8_t, int32_t, int32_t, int32_t, int32_t){ ++nofCalls; }));
+	auto nofEchoed = size_t{0};
+	auto ioStream = makeFnIoStream([&](char){ ++nofEchoed; }, []()->optional<char>{ return {}; });
+	auto lineInput = makeLineInputStrategy<40>(CommandExecutorLineSink{&parser}, SimpleEchoConsole{});
+	std::string line{"pidspeed 1 600 -40 0 120000\n"};
+	auto nsPerLine = measureNsPerRun(100000, [&]
+	{
+		for (auto c : line)
+		{
+			lineInput.rxChar(ioStream, c);
+		}
+	});
+
+	reportBenchmark("set the speed pid as binary frame", binary.bytes.size(), "bytes");
+	reportBenchmark("set the speed pid as text command", line.size(), "bytes");
+	reportBenchmark("set the speed pid as binary frame, answer", binary.nofWritten / 100000.0, "bytes");
+	reportBenchmark("set the speed pid as text command, echo", nofEchoed / 100000.0, "bytes");
+	reportBenchmark("set the speed pid as binary frame, from the bytes to the call", nsPerFrame, "ns");
+	reportBenchmark("set the speed pid as text command, from the bytes to the call", nsPerLine, "ns");
+	ASSERT_THAT(robot.getHandler().nofCalls, Eq(100000u));
+	ASSERT_THAT(nofCalls, Eq(100000));
+}
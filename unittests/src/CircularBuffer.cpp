@@ -1,7 +1,13 @@
 #include <gmock/gmock.h>
 #include "TestAssert.h"
+#include "Benchmark.h"
 
 #include <CircularBuffer.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace testing;
 
@@ -138,3 +144,554 @@ TEST(CircularBuffer, circular_buffer_is_iterable_using_foreach)
 		ASSERT_THAT(elem, Eq(i));
 	}
 }
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_when_an_element_is_pushed_back_then_the_element_can_be_popped_front)
+{
+	CircularBuffer<int, 2, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer> circularBuffer;
+
+	ASSERT_THAT(circularBuffer.pop_front().is_initialized(), Eq(false));
+	circularBuffer.push_back(5);
+	ASSERT_THAT(circularBuffer.size(), Eq(1));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(5));
+	ASSERT_THAT(circularBuffer.size(), Eq(0));
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_buffer_wraps_around_correctly)
+{
+	CircularBuffer<size_t, 3, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer> circularBuffer;
+
+	circularBuffer.push_back(0);
+	for (auto i = 1u; i <= 20; ++i)
+	{
+		circularBuffer.push_back(i);
+		ASSERT_THAT(circularBuffer.size(), Eq(2));
+		ASSERT_THAT(*circularBuffer.pop_front(), Eq(i - 1));
+	}
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_DiscardPushedElement_when_buffer_is_full_then_elements_are_being_discarded)
+{
+	CircularBuffer<size_t, 2, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer> circularBuffer;
+
+	circularBuffer.push_back(1);
+	circularBuffer.push_back(2);
+	circularBuffer.push_back(3);
+	ASSERT_THAT(circularBuffer.size(), Eq(2));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(1));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(2));
+	ASSERT_THAT(circularBuffer.pop_front().is_initialized(), Eq(false));
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_OverwriteOldest_when_buffer_is_full_then_the_oldest_elements_are_being_overwritten)
+{
+	CircularBuffer<size_t, 2, CircularBufferFullStrategy::OverwriteOldest, SingleProducerSingleConsumer> circularBuffer;
+
+	circularBuffer.push_back(1);
+	circularBuffer.push_back(2);
+	circularBuffer.push_back(3);
+	ASSERT_THAT(circularBuffer.size(), Eq(2));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(2));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(3));
+	ASSERT_THAT(circularBuffer.pop_front().is_initialized(), Eq(false));
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_OverwriteOldest_keeps_the_order_over_many_laps)
+{
+	CircularBuffer<uint32_t, 3, CircularBufferFullStrategy::OverwriteOldest, SingleProducerSingleConsumer> circularBuffer;
+
+	//the index counts the laps above its position, every 6 pushes add one
+	std::deque<uint32_t> reference;
+	for (auto i = uint32_t{0}; i < 1000; ++i)
+	{
+		for (auto element : {2 * i, 2 * i + 1})
+		{
+			circularBuffer.push_back(element);
+			reference.push_back(element);
+			if (reference.size() > 3)
+			{
+				reference.pop_front();
+			}
+		}
+		ASSERT_THAT(*circularBuffer.pop_front(), Eq(reference.front()));
+		reference.pop_front();
+	}
+	ASSERT_THAT(circularBuffer.size(), Eq(reference.size()));
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_DiscardPushedElement_stress_concurrent_producer_and_consumer)
+{
+	constexpr uint32_t AmountOfElements = 100000;
+	CircularBuffer<uint32_t, 16, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer> circularBuffer;
+
+	std::thread producer([&]
+	{
+		for (auto i = uint32_t{0}; i < AmountOfElements; ++i)
+		{
+			while (circularBuffer.size() == 16)
+			{
+				std::this_thread::yield();
+			}
+			circularBuffer.push_back(i);
+		}
+	});
+
+	//nothing may be lost or reordered, as the producer never pushes into a full buffer
+	auto expected = uint32_t{0};
+	while (expected < AmountOfElements)
+	{
+		auto element = circularBuffer.pop_front();
+		if (element)
+		{
+			ASSERT_THAT(*element, Eq(expected));
+			++expected;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	ASSERT_THAT(circularBuffer.size(), Eq(0));
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_OverwriteOldest_stress_concurrent_producer_and_consumer)
+{
+	constexpr uint32_t AmountOfElements = 100000;
+	CircularBuffer<uint32_t, 8, CircularBufferFullStrategy::OverwriteOldest, SingleProducerSingleConsumer> circularBuffer;
+
+	std::atomic_bool done{false};
+	std::thread producer([&]
+	{
+		for (auto i = uint32_t{1}; i <= AmountOfElements; ++i)
+		{
+			circularBuffer.push_back(i);
+		}
+		done.store(true);
+	});
+
+	//elements may be overwritten, but the ones we get must be strictly increasing
+	auto last = uint32_t{0};
+	auto received = uint32_t{0};
+	while (!done.load() || circularBuffer.size() > 0)
+	{
+		auto element = circularBuffer.pop_front();
+		if (element)
+		{
+			ASSERT_THAT(*element, Gt(last));
+			last = *element;
+			++received;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	ASSERT_THAT(last, Eq(AmountOfElements));
+	ASSERT_THAT(received, Le(AmountOfElements));
+}
+
+TEST(CircularBuffer, push_n_pushes_all_elements_in_order)
+{
+	CircularBuffer<int, 5> circularBuffer;
+	circularBuffer.push_back(0);
+	circularBuffer.pop_front(); //start in the middle to wrap around
+
+	std::array<int, 4> elements{{1, 2, 3, 4}};
+	ASSERT_THAT(circularBuffer.push_n(elements.data(), elements.size()), Eq(4));
+
+	ASSERT_THAT(circularBuffer.size(), Eq(4));
+	for (auto i = 1; i <= 4; ++i)
+	{
+		ASSERT_THAT(*circularBuffer.pop_front(), Eq(i));
+	}
+}
+
+TEST(CircularBuffer, DiscardPushedElement_push_n_only_pushes_what_fits)
+{
+	CircularBuffer<int, 3, CircularBufferFullStrategy::DiscardPushedElement> circularBuffer;
+	circularBuffer.push_back(1);
+
+	std::array<int, 4> elements{{2, 3, 4, 5}};
+	ASSERT_THAT(circularBuffer.push_n(elements.data(), elements.size()), Eq(2));
+
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(1));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(2));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(3));
+	ASSERT_THAT(circularBuffer.pop_front().is_initialized(), Eq(false));
+}
+
+TEST(CircularBuffer, OverwriteOldest_push_n_keeps_the_newest_elements)
+{
+	CircularBuffer<int, 3, CircularBufferFullStrategy::OverwriteOldest> circularBuffer;
+	circularBuffer.push_back(1);
+	circularBuffer.push_back(2);
+
+	std::array<int, 2> elements{{3, 4}};
+	circularBuffer.push_n(elements.data(), elements.size());
+	std::array<int, 5> moreElements{{5, 6, 7, 8, 9}};
+	circularBuffer.push_n(moreElements.data(), 2);
+
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(4));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(5));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(6));
+
+	circularBuffer.push_n(moreElements.data(), moreElements.size());
+	ASSERT_THAT(circularBuffer.size(), Eq(3));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(7));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(8));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(9));
+}
+
+TEST(CircularBuffer, pop_n_pops_the_oldest_elements_in_order)
+{
+	CircularBuffer<int, 4> circularBuffer;
+	for (auto i = 0; i < 3; ++i)
+	{
+		circularBuffer.push_back(i);
+	}
+	circularBuffer.pop_front();
+	circularBuffer.push_back(3);
+	circularBuffer.push_back(4); //wrapped around
+
+	std::array<int, 6> elements{};
+	ASSERT_THAT(circularBuffer.pop_n(elements.data(), 3), Eq(3));
+	ASSERT_THAT(elements, ElementsAre(1, 2, 3, 0, 0, 0));
+	ASSERT_THAT(circularBuffer.pop_n(elements.data(), elements.size()), Eq(1));
+	ASSERT_THAT(elements[0], Eq(4));
+	ASSERT_THAT(circularBuffer.pop_n(elements.data(), elements.size()), Eq(0));
+}
+
+TEST(CircularBuffer, readable_exposes_the_elements_as_two_regions_when_wrapped_around)
+{
+	CircularBuffer<int, 4> circularBuffer;
+	for (auto i = 0; i < 4; ++i)
+	{
+		circularBuffer.push_back(i);
+	}
+	circularBuffer.pop_front();
+	circularBuffer.pop_front();
+	circularBuffer.push_back(4);
+
+	auto spans = circularBuffer.readable();
+	ASSERT_THAT(spans.size(), Eq(3));
+	ASSERT_THAT(std::vector<int>(spans.first, spans.first + spans.firstSize), ElementsAre(2, 3));
+	ASSERT_THAT(std::vector<int>(spans.second, spans.second + spans.secondSize), ElementsAre(4));
+
+	circularBuffer.consume(2);
+	ASSERT_THAT(circularBuffer.size(), Eq(1));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(4));
+}
+
+TEST(CircularBuffer, writable_exposes_the_free_space_and_commit_makes_it_visible)
+{
+	CircularBuffer<int, 4> circularBuffer;
+	circularBuffer.push_back(0);
+	circularBuffer.push_back(1);
+	circularBuffer.push_back(2);
+	circularBuffer.pop_front();
+
+	auto spans = circularBuffer.writable();
+	ASSERT_THAT(spans.firstSize, Eq(1));
+	ASSERT_THAT(spans.secondSize, Eq(1));
+	spans.first[0] = 3;
+	spans.second[0] = 4;
+	circularBuffer.commit(2);
+
+	ASSERT_THAT(circularBuffer.size(), Eq(4));
+	ASSERT_THAT(std::vector<int>(circularBuffer.begin(), circularBuffer.end()), ElementsAre(1, 2, 3, 4));
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_bulk_operations_wrap_around_correctly)
+{
+	CircularBuffer<int, 5, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer> circularBuffer;
+
+	std::array<int, 3> in{};
+	std::array<int, 3> out{};
+	for (auto round = 0; round < 10; ++round)
+	{
+		in = {{round * 3, round * 3 + 1, round * 3 + 2}};
+		ASSERT_THAT(circularBuffer.push_n(in.data(), in.size()), Eq(3));
+		ASSERT_THAT(circularBuffer.pop_n(out.data(), out.size()), Eq(3));
+		ASSERT_THAT(out, Eq(in));
+	}
+
+	std::array<int, 7> many{{1, 2, 3, 4, 5, 6, 7}};
+	ASSERT_THAT(circularBuffer.push_n(many.data(), many.size()), Eq(5));
+	auto spans = circularBuffer.readable();
+	ASSERT_THAT(spans.size(), Eq(5));
+	ASSERT_THAT(spans.first[0], Eq(1));
+	circularBuffer.consume(5);
+	ASSERT_THAT(circularBuffer.writable().size(), Eq(5));
+}
+
+TEST(CircularBuffer, SingleProducerSingleConsumer_stress_concurrent_bulk_producer_and_consumer)
+{
+	constexpr uint32_t AmountOfElements = 100000;
+	CircularBuffer<uint32_t, 64, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer> circularBuffer;
+
+	std::thread producer([&]
+	{
+		std::array<uint32_t, 7> block;
+		auto next = uint32_t{0};
+		while (next < AmountOfElements)
+		{
+			for (auto& element : block)
+			{
+				element = next++;
+			}
+			auto pushed = size_t{0};
+			while (pushed < block.size())
+			{
+				pushed += circularBuffer.push_n(block.data() + pushed, block.size() - pushed);
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	std::array<uint32_t, 13> block;
+	auto expected = uint32_t{0};
+	while (expected < AmountOfElements)
+	{
+		auto popped = circularBuffer.pop_n(block.data(), block.size());
+		for (auto i = size_t{0}; i < popped; ++i)
+		{
+			ASSERT_THAT(block[i], Eq(expected));
+			++expected;
+		}
+		if (popped == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+}
+
+namespace
+{
+	class MutexLockingStrategy
+	{
+	public:
+		std::unique_lock<std::mutex> lock()
+		{
+			return std::unique_lock<std::mutex>(*pMutex);
+		}
+
+	private:
+		std::shared_ptr<std::mutex> pMutex = std::make_shared<std::mutex>();
+	};
+}
+
+TEST(CircularBuffer, benchmark_per_element_vs_bulk_throughput)
+{
+	constexpr size_t BlockSize = 64;
+	constexpr size_t Runs = 20000;
+	CircularBuffer<uint8_t, 256, CircularBufferFullStrategy::DiscardPushedElement, MutexLockingStrategy> circularBuffer;
+
+	std::array<uint8_t, BlockSize> block{};
+	auto perElementNs = measureNsPerRun(Runs, [&]
+	{
+		for (auto c : block)
+		{
+			circularBuffer.push_back(c);
+		}
+		for (auto& c : block)
+		{
+			c = *circularBuffer.pop_front();
+		}
+	});
+	auto bulkNs = measureNsPerRun(Runs, [&]
+	{
+		circularBuffer.push_n(block.data(), block.size());
+		circularBuffer.pop_n(block.data(), block.size());
+	});
+
+	reportBenchmark("CircularBuffer per element push_back/pop_front", perElementNs / BlockSize, "ns/element");
+	reportBenchmark("CircularBuffer bulk push_n/pop_n", bulkNs / BlockSize, "ns/element");
+	ASSERT_THAT(circularBuffer.size(), Eq(0));
+}
+
+TEST(CircularBuffer, WrapAround_power_of_two_and_other_sizes_give_the_same_results_as_modulo)
+{
+	for (auto pos = size_t{0}; pos < 8; ++pos)
+	{
+		for (auto count = size_t{0}; count <= 8; ++count)
+		{
+			ASSERT_THAT((detail::WrapAround<8>::add(pos, count)), Eq((pos + count) % 8));
+			ASSERT_THAT((detail::WrapAround<8>::subtract(pos, count)), Eq((pos + 8 - count) % 8));
+		}
+	}
+	for (auto pos = size_t{0}; pos < 7; ++pos)
+	{
+		for (auto count = size_t{0}; count <= 7; ++count)
+		{
+			ASSERT_THAT((detail::WrapAround<7>::add(pos, count)), Eq((pos + count) % 7));
+			ASSERT_THAT((detail::WrapAround<7>::subtract(pos, count)), Eq((pos + 7 - count) % 7));
+		}
+	}
+}
+
+TEST(CircularBuffer, power_of_two_sized_buffer_wraps_around_in_both_directions)
+{
+	CircularBuffer<size_t, 4, CircularBufferFullStrategy::OverwriteOldest> circularBuffer;
+
+	for (auto i = size_t{0}; i < 10; ++i)
+	{
+		circularBuffer.push_back(i);
+	}
+	ASSERT_THAT(std::vector<size_t>(circularBuffer.begin(), circularBuffer.end()), ElementsAre(6, 7, 8, 9));
+	ASSERT_THAT(*circularBuffer.pop_back(), Eq(9));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(6));
+	ASSERT_THAT(*circularBuffer.pop_back(), Eq(8));
+	ASSERT_THAT(*circularBuffer.pop_front(), Eq(7));
+	ASSERT_THAT(circularBuffer.size(), Eq(0));
+}
+
+namespace
+{
+	template <typename Buffer>
+	double measureCyclesPerPushAndPop()
+	{
+		constexpr size_t Runs = 200000;
+		Buffer circularBuffer;
+		circularBuffer.push_back(0);
+
+		auto value = uint32_t{0};
+		auto cycles = measureCyclesPerRun(Runs, [&]
+		{
+			circularBuffer.push_back(++value);
+			value += *circularBuffer.pop_front();
+		});
+		EXPECT_THAT(circularBuffer.size(), Eq(1));
+		return cycles / 2; //one push and one pop per run
+	}
+}
+
+TEST(CircularBuffer, benchmark_power_of_two_vs_other_size_index_arithmetic)
+{
+	reportBenchmark("CircularBuffer<64> (mask)", measureCyclesPerPushAndPop<CircularBuffer<uint32_t, 64>>(), "cycles/op");
+	reportBenchmark("CircularBuffer<63> (compare)", measureCyclesPerPushAndPop<CircularBuffer<uint32_t, 63>>(), "cycles/op");
+	reportBenchmark("SPSC CircularBuffer<64> (mask)",
+		measureCyclesPerPushAndPop<CircularBuffer<uint32_t, 64, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer>>(), "cycles/op");
+	reportBenchmark("SPSC CircularBuffer<63> (compare)",
+		measureCyclesPerPushAndPop<CircularBuffer<uint32_t, 63, CircularBufferFullStrategy::DiscardPushedElement, SingleProducerSingleConsumer>>(), "cycles/op");
+}
+
+TEST(CircularBuffer, copy_to_copies_the_newest_elements_oldest_first)
+{
+	CircularBuffer<size_t, 4, CircularBufferFullStrategy::OverwriteOldest> circularBuffer;
+	std::array<size_t, 3> elements{};
+	ASSERT_THAT(circularBuffer.copy_to(elements), Eq(0));
+
+	circularBuffer.push_back(1);
+	circularBuffer.push_back(2);
+	ASSERT_THAT(circularBuffer.copy_to(elements), Eq(2));
+	ASSERT_THAT(elements, ElementsAre(1, 2, 0));
+
+	for (auto i = size_t{3}; i < 10; ++i)
+	{
+		circularBuffer.push_back(i);
+	}
+	ASSERT_THAT(circularBuffer.copy_to(elements), Eq(3));
+	ASSERT_THAT(elements, ElementsAre(7, 8, 9));
+
+	std::array<size_t, 6> moreElementsThanStored{};
+	ASSERT_THAT(circularBuffer.copy_to(moreElementsThanStored), Eq(4));
+	ASSERT_THAT(moreElementsThanStored, ElementsAre(6, 7, 8, 9, 0, 0));
+	ASSERT_THAT(circularBuffer.size(), Eq(4));
+}
+
+TEST(CircularBuffer, snapshot_contains_all_elements_and_takes_the_lock_once)
+{
+	auto lockCount = std::make_shared<size_t>(0);
+	struct CountingLockingStrategy
+	{
+		std::shared_ptr<size_t> lockCount;
+		void* lock()
+		{
+			++*lockCount;
+			return nullptr;
+		}
+	};
+	CircularBuffer<size_t, 5, CircularBufferFullStrategy::DiscardPushedElement, CountingLockingStrategy> circularBuffer{CountingLockingStrategy{lockCount}};
+	for (auto i = size_t{0}; i < 4; ++i)
+	{
+		circularBuffer.push_back(i);
+	}
+	circularBuffer.pop_front();
+	*lockCount = 0;
+
+	auto snapshot = circularBuffer.snapshot();
+	ASSERT_THAT(*lockCount, Eq(1));
+	ASSERT_THAT(snapshot.size(), Eq(3));
+	ASSERT_THAT(std::vector<size_t>(snapshot.begin(), snapshot.end()), ElementsAre(1, 2, 3));
+	ASSERT_THAT(snapshot[2], Eq(3));
+}
+
+TEST(CircularBuffer, copy_to_without_lock_sees_consistent_elements_while_writer_pushes)
+{
+	struct Pair
+	{
+		size_t first;
+		size_t second;
+	};
+	constexpr size_t NofElements = 100000;
+	CircularBuffer<Pair, 8, CircularBufferFullStrategy::OverwriteOldest, SeqLockingStrategy<>> circularBuffer;
+
+	std::thread writer([&]
+	{
+		for (auto i = size_t{1}; i <= NofElements; ++i)
+		{
+			circularBuffer.push_back(Pair{i, i});
+			if (i % 64 == 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	auto newest = size_t{0};
+	while (newest < NofElements)
+	{
+		std::array<Pair, 4> elements{};
+		auto count = circularBuffer.copy_to_without_lock(elements);
+		for (auto i = size_t{0}; i < count; ++i)
+		{
+			ASSERT_THAT(elements[i].first, Eq(elements[i].second));
+			if (i > 0)
+			{
+				ASSERT_THAT(elements[i].first, Eq(elements[i - 1].first + 1));
+			}
+		}
+		if (count > 0)
+		{
+			ASSERT_THAT(elements[count - 1].first, Ge(newest));
+			newest = elements[count - 1].first;
+		}
+		std::this_thread::yield();
+	}
+	writer.join();
+}
+
+TEST(CircularBuffer, benchmark_iterator_copy_vs_single_lock_copy)
+{
+	constexpr size_t Runs = 20000;
+	CircularBuffer<uint32_t, 16, CircularBufferFullStrategy::OverwriteOldest, MutexLockingStrategy> circularBuffer;
+	for (auto i = uint32_t{0}; i < 16; ++i)
+	{
+		circularBuffer.push_back(i);
+	}
+	std::array<uint32_t, 16> elements{};
+
+	reportBenchmark("iterator copy (lock per element)", measureNsPerRun(Runs, [&]
+	{
+		std::copy(circularBuffer.begin(), circularBuffer.end(), elements.begin());
+	}), "ns/copy");
+	reportBenchmark("copy_to (single lock)", measureNsPerRun(Runs, [&]
+	{
+		circularBuffer.copy_to(elements);
+	}), "ns/copy");
+	ASSERT_THAT(elements[15], Eq(15));
+}
@@ -1,6 +1,9 @@
 #include <gmock/gmock.h>
 #include "TestAssert.h"
+#include "Benchmark.h"
 #include "StringStreamer.h"
+#include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include <CommandParser.h>
@@ -177,15 +180,15 @@ TEST(CommandParser, error_parameters_dont_match)
 TEST(CommandParser, get_available_commands)
 {
 	ParserTestData testParser;
-	std::vector<String<10>> commands;
-	commands.resize(10);
-	testParser.getCommandParser().getAvailableCommands(commands.data(), 10);
-
-	ASSERT_THAT(commands[0], Eq("cmd1"));
-	ASSERT_THAT(commands[1], Eq("cmd2"));
-	ASSERT_THAT(commands[2], Eq("cmd3"));
-	ASSERT_THAT(commands[3], Eq("cmd4"));
-	ASSERT_THAT(commands[4], Eq("cmd5"));
+	auto commands = testParser.getCommandParser().getCommands();
+
+	ASSERT_THAT(commands.size(), Eq(5));
+	ASSERT_THAT(commands[0].name, Eq("cmd1"));
+	ASSERT_THAT(commands[1].name, Eq("cmd2"));
+	ASSERT_THAT(commands[2].name, Eq("cmd3"));
+	ASSERT_THAT(commands[3].name, Eq("cmd4"));
+	ASSERT_THAT(commands[4].name, Eq("cmd5"));
+	ASSERT_THAT(testParser.getCommandParser().getCommands().begin(), Eq(commands.begin())); //the same table
 }
 
 TEST(CommandParser, when_multiple_spaces_come_after_another_then_they_will_be_ignored)
@@ -255,3 +258,243 @@ TEST(CommandParser, when_a_iostream_is_excepted_then_it_will_be_passed_through)
 	testParser.getCommandParser().executeCommand(ioStream, "cmd5 a b 1 2 3");
 	ASSERT_THAT(writtenChar, Eq('a'));
 }
+
+namespace
+{
+	uint32_t nofLegacyStatusCalls = 0;
+
+	//! like the ParseCommand functions of the legacy modules
+	uint8_t LEG_ParseCommand(const unsigned char* cmd, bool* handled, const CLS1_StdIOType* io)
+	{
+		auto command = reinterpret_cast<const char*>(cmd);
+		if (strcmp(command, CLS1_CMD_HELP) == 0 || strcmp(command, "leg help") == 0)
+		{
+			CLS1_SendHelpStr(reinterpret_cast<const unsigned char*>("leg"), reinterpret_cast<const unsigned char*>("legacy\n"), io->stdOut);
+			*handled = true;
+		}
+		else if (strcmp(command, CLS1_CMD_STATUS) == 0)
+		{
+			++nofLegacyStatusCalls;
+			*handled = true;
+		}
+		return 0;
+	}
+
+	void writeStatStatus(IOStream& ioStream)
+	{
+		ioStream << "stat " << 42 << "\n";
+	}
+
+	//! a legacy module whose commands moved to typed ones, it only keeps its part of "status"
+	uint8_t STAT_ParseCommand(const unsigned char* cmd, bool* handled, const CLS1_StdIOType* io)
+	{
+		auto command = reinterpret_cast<const char*>(cmd);
+		if (strcmp(command, CLS1_CMD_HELP) == 0)
+		{
+			CLS1_SendHelpStr(reinterpret_cast<const unsigned char*>("stat"), reinterpret_cast<const unsigned char*>("legacy\n"), io->stdOut);
+			*handled = true;
+		}
+		else if (strcmp(command, CLS1_CMD_STATUS) == 0)
+		{
+			LegacyIOStream ioStream(io->stdOut);
+			writeStatStatus(ioStream);
+			*handled = true;
+		}
+		return 0;
+	}
+
+	struct CountingCommand
+	{
+		void operator()() const
+		{
+			++pCalls[index];
+		}
+
+		size_t* pCalls;
+		size_t index;
+	};
+
+	String<10> commandName(size_t index)
+	{
+		char name[10];
+		snprintf(name, sizeof(name), "cmd%02u", static_cast<unsigned>(index));
+		return String<10>{name};
+	}
+
+	template <size_t... Indices>
+	std::unique_ptr<CommandParser> makeCountingParser(size_t* pCalls, IndexSequence<Indices...>)
+	{
+		return intoUniquePtr(makeParser(cmd(commandName(Indices), CountingCommand{pCalls, Indices})...));
+	}
+
+	//! address of a local of a new stack frame, the difference of two tells the stack used between them
+	__attribute__((noinline)) uintptr_t stackPosition()
+	{
+		volatile char marker = 0;
+		return reinterpret_cast<uintptr_t>(&marker);
+	}
+
+	std::string execute(CommandParser& parser, const String<detail::MaxCommandLength>& command)
+	{
+		std::stringstream output;
+		auto ioStream = makeFnIoStream([&](char c){ output << c; }, []()->optional<char>{ return {}; });
+		parser.executeCommand(ioStream, command);
+		return output.str();
+	}
+}
+
+TEST(CommandParser, the_first_of_commands_with_the_same_name_is_executed)
+{
+	auto first = 0;
+	auto second = 0;
+	auto parser = makeParser(cmd("same", [&]{ ++first; }), cmd("same", [&]{ ++second; }));
+	execute(parser, "same");
+	ASSERT_THAT(first, Eq(1));
+	ASSERT_THAT(second, Eq(0));
+}
+
+TEST(CommandParser, legacy_commands_get_the_lines_no_command_is_named_like)
+{
+	nofLegacyStatusCalls = 0;
+	auto nofA = 0;
+	auto parser = makeParser(cmd("a", [&]{ ++nofA; }), legacyCmd(LEG_ParseCommand));
+	ASSERT_THAT(parser.getCommands()[1].name, Eq("leg"));
+
+	ASSERT_THAT(execute(parser, "status"), Eq(""));
+	ASSERT_THAT(nofLegacyStatusCalls, Eq(1u));
+	ASSERT_THAT(execute(parser, "leg help"), Eq("leg\tlegacy\n"));
+	ASSERT_THAT(execute(parser, "leg unknown"), Eq("could not execute command:\nleg\tlegacy\n"));
+	ASSERT_THAT(execute(parser, "a"), Eq(""));
+	ASSERT_THAT(nofA, Eq(1));
+	ASSERT_THAT(execute(parser, "b"), Eq("b not found"));
+}
+
+TEST(CommandParser, a_legacy_status_can_use_the_printer_of_a_typed_command)
+{
+	auto parser = makeParser(cmd("statstat", writeStatStatus), legacyCmd(STAT_ParseCommand));
+	ASSERT_THAT(execute(parser, "statstat"), Eq("stat 42\n"));
+	ASSERT_THAT(execute(parser, "status"), Eq("stat 42\n"));
+}
+
+TEST(CommandParser, every_one_of_many_commands_is_found)
+{
+	constexpr size_t NofCommands = 64;
+	std::array<size_t, NofCommands> calls{};
+	auto parser = makeCountingParser(calls.data(), MakeIndexSequence<NofCommands>{});
+	for (auto index = size_t{0}; index < NofCommands; ++index)
+	{
+		ASSERT_THAT(execute(*parser, commandName(index).begin()), Eq("")) << index;
+	}
+	ASSERT_THAT(calls, Each(Eq(1u)));
+	ASSERT_THAT(execute(*parser, "cmd64"), Eq("cmd64 not found"));
+	ASSERT_THAT(execute(*parser, "cmd0"), Eq("cmd0 not found"));
+	ASSERT_THAT(execute(*parser, "cmd000"), Eq("cmd000 not found"));
+}
+
+TEST(CommandParser, benchmark_dispatch)
+{
+	std::array<size_t, 64> calls{};
+	auto fewCommands = makeCountingParser(calls.data(), MakeIndexSequence<4>{});
+	auto manyCommands = makeCountingParser(calls.data(), MakeIndexSequence<64>{});
+	auto ioStream = makeFnIoStream([](char){}, []()->optional<char>{ return {}; });
+
+	auto measure = [&](CommandParser& parser, const char* name, const char* command)
+	{
+		String<detail::MaxCommandLength> line{command};
+		reportBenchmark(std::string("dispatch ") + name, measureNsPerRun(100000, [&]{ parser.executeCommand(ioStream, line); }), "ns");
+	};
+	measure(*fewCommands, "first of 4 commands", "cmd00");
+	measure(*fewCommands, "last of 4 commands", "cmd03");
+	measure(*fewCommands, "unknown of 4 commands", "unknown");
+	measure(*manyCommands, "first of 64 commands", "cmd00");
+	measure(*manyCommands, "last of 64 commands", "cmd63");
+	measure(*manyCommands, "unknown of 64 commands", "unknown");
+}
+
+TEST(CommandParser, benchmark_parameter_parsing)
+{
+	uintptr_t commandStackPosition = 0;
+	auto sum = int32_t{0};
+	auto parser = makeParser(cmd("set", [&](uint16_t speed, int32_t offset, String<10> name)
+	{
+		commandStackPosition = stackPosition();
+		sum += speed + offset + name.size();
+	}));
+	auto ioStream = makeFnIoStream([](char){}, []()->optional<char>{ return {}; });
+	String<detail::MaxCommandLength> line{"set 1234 -56789 'left motor'"};
+
+	reportBenchmark("parse a command with 3 parameters", measureNsPerRun(100000, [&]{ parser.executeCommand(ioStream, line); }), "ns");
+	auto parserStackPosition = stackPosition();
+	parser.executeCommand(ioStream, line);
+	reportBenchmark("stack from executeCommand to a command with 3 parameters", parserStackPosition - commandStackPosition, "bytes");
+	ASSERT_THAT(sum, Ne(0));
+}
+
+TEST(CommandParser, the_help_of_a_command_has_its_syntax_and_text)
+{
+	auto parser = makeParser(
+		cmd("speed", [](uint8_t, String<5>){}, "sets the speed"),
+		cmd("stop", []{}),
+		legacyCmd(LEG_ParseCommand)
+	);
+	std::stringstream help;
+	auto ioStream = makeFnIoStream([&](char c){ help << c; }, []()->optional<char>{ return {}; });
+	for (const auto& command : parser.getCommands())
+	{
+		writeCommandHelp(ioStream, command);
+	}
+	ASSERT_THAT(help.str(), Eq("speed num str\tsets the speed\nstop\nleg\n"));
+}
+
+TEST(CommandParser, command_names_are_completed_as_far_as_they_are_unique)
+{
+	auto parser = makeParser(cmd("motstat", []{}), cmd("motstop", []{}), cmd("help", []{}), legacyCmd(LEG_ParseCommand));
+	ASSERT_TRUE(parser.completeCommand("mo") == "tst");
+	ASSERT_TRUE(parser.completeCommand("motsta") == "t");
+	ASSERT_TRUE(parser.completeCommand("h") == "elp");
+	ASSERT_TRUE(parser.completeCommand("le") == "g");
+	ASSERT_TRUE(parser.completeCommand("help") == "");
+	ASSERT_TRUE(parser.completeCommand("x") == "");
+	ASSERT_TRUE(parser.completeCommand("helpme") == "");
+
+	CommandNameCompleter completer{&parser};
+	ASSERT_TRUE(completer.complete(String<20>{"mo"}) == "tst");
+	ASSERT_TRUE(completer.complete(String<20>{"h mo"}) == "");
+}
+
+TEST(CommandParser, enum_decimal_and_fixed_point_params)
+{
+	auto side = Side::Left;
+	auto gain = Decimal<int32_t, 2>{0};
+	auto factor = Fixed<int16_t, 8>{0};
+	auto callCount = 0;
+	auto parser = makeParser(
+		cmd("gain", [&](Side s, const Decimal<int32_t, 2>& g, Fixed<int16_t, 8> f)
+		{
+			++callCount;
+			side = s;
+			gain = g;
+			factor = f;
+		}, "typed")
+	);
+	std::stringstream output;
+	auto ioStream = makeFnIoStream([&](char c){ output << c; }, []()->optional<char>{ return {}; });
+
+	parser.executeCommand(ioStream, "gain R -1.5 0.25");
+	ASSERT_THAT(callCount, Eq(1));
+	ASSERT_TRUE(side == Side::Right);
+	ASSERT_THAT(gain.scaled, Eq(-150));
+	ASSERT_THAT(factor.raw, Eq(0x40));
+	ASSERT_THAT(output.str(), Eq(""));
+
+	for (auto pLine : {"gain X 1 1", "gain L 1.255 1", "gain L 1 128", "gain L 1"})
+	{
+		parser.executeCommand(ioStream, pLine);
+	}
+	ASSERT_THAT(callCount, Eq(1));
+	ASSERT_THAT(output.str(), HasSubstr("error. syntax: gain L|R num.nn q7.8\n"));
+
+	output.str("");
+	writeCommandHelp(ioStream, parser.getCommands()[0]);
+	ASSERT_THAT(output.str(), Eq("gain L|R num.nn q7.8\ttyped\n"));
+}
@@ -0,0 +1,126 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+
+#include <EventDispatcher.h>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+	enum class Event : uint8_t
+	{
+		Startup,
+		Heartbeat,
+		Calibration,
+		AmountOfEvents //!< must be last
+	};
+
+	struct EmptyLock
+	{
+	};
+
+	uint32_t fakeTimeUs = 0;
+
+	struct FakeClock
+	{
+		static uint32_t nowUs()
+		{
+			return fakeTimeUs;
+		}
+	};
+
+	using Queue = EventQueue<Event, EmptyLock>;
+	using StatsQueue = EventQueue<Event, EmptyLock, NoNotifier, PendingTimeTracer<3, FakeClock>>;
+
+	template <typename Dispatcher>
+	void dispatchInto(Dispatcher& dispatcher, std::vector<int>& handled)
+	{
+		dispatcher.dispatch(
+			[&]{ handled.push_back(0); },
+			[&]{ handled.push_back(1); },
+			[&]{ handled.push_back(2); }
+		);
+	}
+}
+
+TEST(EventDispatcher, strict_priority_handles_the_event_with_the_highest_priority_first)
+{
+	Queue queue;
+	auto dispatcher = makeEventDispatcher<StrictPriority<1, 0, 5>>(queue);
+	queue.setEvent(Event::Startup);
+	queue.setEvent(Event::Heartbeat);
+	queue.setEvent(Event::Calibration);
+
+	std::vector<int> handled;
+	for (auto i = 0; i < 4; ++i)
+	{
+		dispatchInto(dispatcher, handled);
+	}
+	ASSERT_THAT(handled, ElementsAre(2, 0, 1));
+}
+
+TEST(EventDispatcher, strict_priority_handles_equal_priorities_lowest_event_first)
+{
+	Queue queue;
+	auto dispatcher = makeEventDispatcher<StrictPriority<1, 1, 1>>(queue);
+	queue.setEvent(Event::Calibration);
+	queue.setEvent(Event::Heartbeat);
+
+	std::vector<int> handled;
+	dispatchInto(dispatcher, handled);
+	ASSERT_THAT(handled, ElementsAre(1));
+}
+
+TEST(EventDispatcher, round_robin_does_not_starve_an_event_behind_a_steady_stream)
+{
+	Queue queue;
+	auto dispatcher = makeEventDispatcher<RoundRobin>(queue);
+	queue.setEvent(Event::Calibration);
+
+	std::vector<int> handled;
+	for (auto i = 0; i < 3; ++i)
+	{
+		queue.setEvent(Event::Startup);
+		queue.setEvent(Event::Heartbeat);
+		dispatchInto(dispatcher, handled);
+	}
+	ASSERT_THAT(handled, ElementsAre(0, 1, 2));
+}
+
+TEST(EventDispatcher, drain_all_handles_every_pending_event_in_one_call)
+{
+	Queue queue;
+	auto dispatcher = makeEventDispatcher<DrainAll>(queue);
+	queue.setEvent(Event::Calibration);
+	queue.setEvent(Event::Startup);
+
+	std::vector<int> handled;
+	dispatchInto(dispatcher, handled);
+	ASSERT_THAT(handled, ElementsAre(0, 2));
+	ASSERT_FALSE(queue.hasEvents());
+}
+
+TEST(EventDispatcher, pending_time_is_measured_from_the_first_set_until_dispatch)
+{
+	StatsQueue queue;
+	auto dispatcher = makeEventDispatcher<RoundRobin>(queue);
+	std::vector<int> handled;
+
+	fakeTimeUs = 100;
+	queue.setEvent(Event::Heartbeat);
+	fakeTimeUs = 150;
+	queue.setEvent(Event::Heartbeat); //still pending, keeps the first time
+	fakeTimeUs = 400;
+	dispatchInto(dispatcher, handled);
+
+	queue.setEvent(Event::Heartbeat);
+	fakeTimeUs = 500;
+	dispatchInto(dispatcher, handled);
+
+	auto& stats = queue.getTracer().getStats(static_cast<uint8_t>(Event::Heartbeat));
+	ASSERT_THAT(stats.count, Eq(2u));
+	ASSERT_THAT(stats.maxUs, Eq(300u));
+	ASSERT_THAT(stats.averageUs(), Eq(200u));
+	ASSERT_THAT(queue.getTracer().getStats(static_cast<uint8_t>(Event::Startup)).count, Eq(0u));
+}
@@ -2,6 +2,7 @@
 
 #include <EventQueue.h>
 #include <EventHandler.h>
+#include <vector>
 
 using namespace testing;
 
@@ -70,3 +71,77 @@ TEST(EventHandler, When_I_set_two_events_the_higher_priority_will_be_handled_fir
 	ASSERT_THAT(button1Events, Eq(1));
 	ASSERT_THAT(button2Events, Eq(1));
 }
+
+namespace
+{
+	enum class ThreeEvents : uint8_t
+	{
+		First,
+		Second,
+		Third,
+		AmountOfEvents //!< must be last
+	};
+	using ThreeEventsQueue = EventQueue<ThreeEvents, EmptyLock>;
+}
+
+TEST(EventHandler, When_I_handle_all_events_every_set_event_is_handled_in_priority_order) {
+	ThreeEventsQueue queue;
+
+	queue.setEvent(ThreeEvents::Third);
+	queue.setEvent(ThreeEvents::First);
+
+	std::vector<int> handled;
+	handleAllEvents(queue,
+		[&]{ handled.push_back(1); },
+		[&]{ handled.push_back(2); },
+		[&]{ handled.push_back(3); }
+	);
+	ASSERT_THAT(handled, ElementsAre(1, 3));
+	ASSERT_THAT(queue.getAndResetEvent(ThreeEvents::First), Eq(false));
+	ASSERT_THAT(queue.getAndResetEvent(ThreeEvents::Third), Eq(false));
+}
+
+TEST(EventHandler, When_a_handler_sets_an_event_it_is_handled_in_the_next_pass) {
+	ThreeEventsQueue queue;
+
+	queue.setEvent(ThreeEvents::Second);
+
+	auto firstEvents = size_t{};
+	auto doHandle = [&]{
+		handleAllEvents(queue,
+			[&]{ ++firstEvents; },
+			[&]{ queue.setEvent(ThreeEvents::First); },
+			[]{ }
+		);
+	};
+
+	doHandle();
+	ASSERT_THAT(firstEvents, Eq(0));
+	doHandle();
+	ASSERT_THAT(firstEvents, Eq(1));
+}
+
+namespace
+{
+	size_t nofLocks = 0;
+
+	struct CountingLock
+	{
+		CountingLock()
+		{
+			++nofLocks;
+		}
+	};
+}
+
+TEST(EventHandler, When_I_handle_all_events_without_a_tracer_the_queue_is_locked_once) {
+	EventQueue<ThreeEvents, CountingLock> queue;
+
+	queue.setEvent(ThreeEvents::First);
+	queue.setEvent(ThreeEvents::Second);
+	queue.setEvent(ThreeEvents::Third);
+
+	nofLocks = 0;
+	handleAllEvents(queue, []{ }, []{ }, []{ });
+	ASSERT_THAT(nofLocks, Eq(1u));
+}
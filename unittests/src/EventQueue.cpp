@@ -1,6 +1,14 @@
 #include <gmock/gmock.h>
+#include "Benchmark.h"
 
 #include <EventQueue.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace testing;
 
@@ -45,3 +53,107 @@ TEST(EventQueue, When_I_set_multiple_events_only_the_correct_one_is_reset) {
 	ASSERT_THAT(queue.getAndResetEvent(Event::Button1Pressed), Eq(true));
 	ASSERT_THAT(queue.getAndResetEvent(Event::Button2Pressed), Eq(true));
 }
+
+TEST(EventQueue, When_I_take_all_events_I_get_every_set_event_and_the_queue_is_empty_afterwards) {
+	EventQueue<Event, EmptyLock> queue;
+
+	queue.setEvent(Event::Button1Pressed);
+	queue.setEvent(Event::Button2Pressed);
+	auto events = queue.takeAll();
+	ASSERT_THAT(events, ElementsAre(0x1, 0x2));
+	ASSERT_THAT(queue.getAndResetEvent(Event::Button1Pressed), Eq(false));
+	ASSERT_THAT(queue.getAndResetEvent(Event::Button2Pressed), Eq(false));
+	ASSERT_THAT(queue.takeAll(), ElementsAre(0, 0));
+}
+
+namespace
+{
+	std::mutex eventQueueMutex;
+
+	struct MutexLock
+	{
+		MutexLock()
+		{
+			eventQueueMutex.lock();
+		}
+
+		~MutexLock()
+		{
+			eventQueueMutex.unlock();
+		}
+	};
+
+	//! host counterpart of TaskNotifier
+	class ConditionVariableNotifier
+	{
+	public:
+		void notify()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			condition.notify_one();
+		}
+
+		template <typename Predicate>
+		void waitUntil(Predicate ready)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, ready);
+		}
+
+	private:
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+
+	using NotifyingQueue = EventQueue<Event, MutexLock, ConditionVariableNotifier>;
+}
+
+TEST(EventQueue, When_an_event_is_already_set_waiting_returns_immediately) {
+	NotifyingQueue queue;
+
+	ASSERT_THAT(queue.hasEvents(), Eq(false));
+	queue.setEvent(Event::Button2Pressed);
+	ASSERT_THAT(queue.hasEvents(), Eq(true));
+	queue.waitForEvents();
+	ASSERT_THAT(queue.getAndResetEvent(Event::Button2Pressed), Eq(true));
+	ASSERT_THAT(queue.hasEvents(), Eq(false));
+}
+
+TEST(EventQueue, benchmark_set_to_dispatch_latency_of_a_waiting_consumer) {
+	constexpr size_t Runs = 1000;
+	using Clock = std::chrono::steady_clock;
+	NotifyingQueue queue;
+	std::atomic<Clock::time_point> setTime{Clock::time_point{}};
+	std::atomic<size_t> handled{0};
+	std::vector<double> latenciesUs;
+
+	std::thread consumer([&]
+	{
+		while (handled < Runs)
+		{
+			queue.waitForEvents();
+			if (queue.getAndResetEvent(Event::Button1Pressed))
+			{
+				latenciesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - setTime.load()).count());
+				++handled;
+			}
+		}
+	});
+
+	for (auto i = size_t{0}; i < Runs; ++i)
+	{
+		auto handledBefore = handled.load();
+		setTime = Clock::now();
+		queue.setEvent(Event::Button1Pressed);
+		while (handled == handledBefore)
+		{
+			std::this_thread::yield();
+		}
+	}
+	consumer.join();
+
+	ASSERT_THAT(latenciesUs.size(), Eq(Runs));
+	std::sort(latenciesUs.begin(), latenciesUs.end());
+	reportBenchmark("EventQueue set to dispatch latency, median", latenciesUs[Runs / 2], "us");
+	reportBenchmark("EventQueue set to dispatch latency, 99th percentile", latenciesUs[Runs * 99 / 100], "us");
+}
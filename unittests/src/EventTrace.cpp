@@ -0,0 +1,178 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+#include "EventTraceDecoder.h"
+
+#include <EventTraceBuffer.h>
+#include <EventQueue.h>
+#include <EventHandler.h>
+#include <thread>
+
+using namespace testing;
+
+namespace
+{
+	EventTraceRecord makeRecord(uint32_t timestampUs, uint8_t eventNo, EventTraceKind kind, uint8_t source = 0)
+	{
+		EventTraceRecord record;
+		record.timestampUs = timestampUs;
+		record.eventNo = eventNo;
+		record.kind = kind;
+		record.source = source;
+		return record;
+	}
+
+	template <size_t Capacity>
+	std::string dump(const EventTraceBuffer<Capacity>& buffer)
+	{
+		std::array<EventTraceRecord, Capacity> records;
+		auto count = buffer.copy_to(records);
+		std::string text;
+		auto ioStream = makeFnIoStream([&](char c){ text.push_back(c); }, []{ return optional<char>{}; });
+		writeEventTrace(ioStream, records.data(), count);
+		return text;
+	}
+}
+
+TEST(EventTrace, a_record_survives_encoding_and_decoding)
+{
+	uint8_t encoded[EventTraceRecord::EncodedSize];
+	makeRecord(0x12345678, 7, EventTraceKind::Handled, 15).encode(encoded);
+	ASSERT_THAT(encoded, ElementsAre(0x78, 0x56, 0x34, 0x12, 7, 1, 15, 0));
+
+	auto record = EventTraceRecord::decode(encoded);
+	ASSERT_THAT(record.timestampUs, Eq(0x12345678u));
+	ASSERT_THAT(record.eventNo, Eq(7));
+	ASSERT_THAT(record.kind, Eq(EventTraceKind::Handled));
+	ASSERT_THAT(record.source, Eq(15));
+}
+
+TEST(EventTrace, the_buffer_keeps_the_newest_records_oldest_first)
+{
+	EventTraceBuffer<4> buffer;
+	for (auto i = uint32_t{0}; i < 6; ++i)
+	{
+		buffer.record(makeRecord(i, 0, EventTraceKind::Set));
+	}
+
+	std::array<EventTraceRecord, 4> records;
+	ASSERT_THAT(buffer.copy_to(records), Eq(4));
+	ASSERT_THAT(records[0].timestampUs, Eq(2u));
+	ASSERT_THAT(records[3].timestampUs, Eq(5u));
+
+	buffer.clear();
+	ASSERT_THAT(buffer.copy_to(records), Eq(0));
+}
+
+TEST(EventTrace, a_dump_is_decoded_to_the_same_records)
+{
+	EventTraceBuffer<8> buffer;
+	buffer.record(makeRecord(100, 2, EventTraceKind::Set, 15));
+	buffer.record(makeRecord(350, 2, EventTraceKind::Handled));
+
+	auto text = dump(buffer);
+	ASSERT_THAT(text, StartsWith("evtrace 2\n"));
+	auto records = decodeEventTrace("garbage\r\n" + text);
+	ASSERT_THAT(records.size(), Eq(2));
+	ASSERT_THAT(records[0].timestampUs, Eq(100u));
+	ASSERT_THAT(records[0].source, Eq(15));
+	ASSERT_THAT(records[1].kind, Eq(EventTraceKind::Handled));
+}
+
+TEST(EventTrace, latencies_are_measured_from_the_first_set_to_the_handling)
+{
+	std::vector<EventTraceRecord> records{
+		makeRecord(0, 1, EventTraceKind::Set),
+		makeRecord(10, 1, EventTraceKind::Set), //coalesced with the first one
+		makeRecord(100, 1, EventTraceKind::Handled),
+		makeRecord(200, 3, EventTraceKind::Set),
+		makeRecord(201, 3, EventTraceKind::Handled),
+		makeRecord(300, 1, EventTraceKind::Set),
+		makeRecord(305, 1, EventTraceKind::Handled),
+		makeRecord(400, 3, EventTraceKind::Handled), //set before the trace started
+	};
+
+	auto histograms = eventLatencies(records);
+	ASSERT_THAT(histograms.size(), Eq(2));
+	ASSERT_THAT(histograms[1].count, Eq(2));
+	ASSERT_THAT(histograms[1].maxUs, Eq(100u));
+	ASSERT_THAT(histograms[1].buckets[2], Eq(1)); //5us
+	ASSERT_THAT(histograms[1].buckets[6], Eq(1)); //100us
+	ASSERT_THAT(histograms[3].count, Eq(1));
+	ASSERT_THAT(histograms[3].buckets[0], Eq(1));
+	ASSERT_THAT(toString(histograms[1]), Eq("<8us: 1\n<128us: 1\n"));
+}
+
+TEST(EventTrace, concurrent_writers_do_not_lose_records)
+{
+	constexpr size_t NofWriters = 4;
+	constexpr uint32_t NofRecords = 200;
+	EventTraceBuffer<1024> buffer;
+
+	std::vector<std::thread> writers;
+	for (auto writer = size_t{0}; writer < NofWriters; ++writer)
+	{
+		writers.emplace_back([&buffer, writer]
+		{
+			for (auto i = uint32_t{0}; i < NofRecords; ++i)
+			{
+				buffer.record(makeRecord(i, static_cast<uint8_t>(writer), EventTraceKind::Set));
+			}
+		});
+	}
+	for (auto& writer : writers)
+	{
+		writer.join();
+	}
+
+	std::array<EventTraceRecord, 1024> records;
+	ASSERT_THAT(buffer.copy_to(records), Eq(NofWriters * NofRecords));
+}
+
+namespace
+{
+	enum class TracedEvent : uint8_t
+	{
+		First,
+		Second,
+		AmountOfEvents //!< must be last
+	};
+
+	struct EmptyLock
+	{
+	};
+
+	EventTraceBuffer<16> traceBuffer;
+	uint32_t fakeTimeUs = 0;
+
+	struct TestTracer
+	{
+		void eventSet(uint8_t eventNo)
+		{
+			traceBuffer.record(makeRecord(fakeTimeUs, eventNo, EventTraceKind::Set));
+		}
+
+		void eventHandled(uint8_t eventNo)
+		{
+			traceBuffer.record(makeRecord(fakeTimeUs, eventNo, EventTraceKind::Handled));
+		}
+	};
+}
+
+TEST(EventTrace, the_event_queue_and_handlers_report_set_and_handled_events)
+{
+	traceBuffer.clear();
+	EventQueue<TracedEvent, EmptyLock, NoNotifier, TestTracer> queue;
+
+	fakeTimeUs = 10;
+	queue.setEvent(TracedEvent::Second);
+	fakeTimeUs = 50;
+	handleAllEvents(queue, []{}, []{});
+	fakeTimeUs = 60;
+	queue.setEvent(TracedEvent::First);
+	fakeTimeUs = 61;
+	handleOneEvent(queue, []{}, []{});
+
+	auto histograms = eventLatencies(decodeEventTrace(dump(traceBuffer)));
+	ASSERT_THAT(histograms[1].maxUs, Eq(40u));
+	ASSERT_THAT(histograms[0].maxUs, Eq(1u));
+}
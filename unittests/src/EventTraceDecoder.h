@@ -0,0 +1,85 @@
+#pragma once
+
+#include <EventTraceBuffer.h>
+#include <LatencyHistogram.h>
+#include <array>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Host side decoder for the text written by writeTrace(): every line of 2 * Record::EncodedSize
+ * hex digits is a record, everything else is ignored.
+ */
+template <typename Record>
+std::vector<Record> decodeTrace(const std::string& dump)
+{
+	std::vector<Record> records;
+	std::istringstream lines(dump);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		if (line.size() != 2 * Record::EncodedSize || line.find_first_not_of("0123456789abcdef") != std::string::npos)
+		{
+			continue; //header or console noise
+		}
+		uint8_t encoded[Record::EncodedSize];
+		for (auto i = size_t{0}; i < Record::EncodedSize; ++i)
+		{
+			encoded[i] = static_cast<uint8_t>(std::stoul(line.substr(2 * i, 2), nullptr, 16));
+		}
+		records.push_back(Record::decode(encoded));
+	}
+	return records;
+}
+
+//! decoder for the text written by writeEventTrace() (console command trcdump)
+inline std::vector<EventTraceRecord> decodeEventTrace(const std::string& dump)
+{
+	return decodeTrace<EventTraceRecord>(dump);
+}
+
+inline std::string toString(const LatencyHistogram& histogram)
+{
+	std::ostringstream out;
+	for (auto i = size_t{0}; i < LatencyHistogram::NofBuckets; ++i)
+	{
+		if (histogram.buckets[i] != 0)
+		{
+			out << "<" << (2u << i) << "us: " << histogram.buckets[i] << "\n";
+		}
+	}
+	return out.str();
+}
+
+/**
+ * Set to handled latency per event number. As the EventQueue only keeps one bit per event,
+ * a handled event belongs to the first set since the previous handled one.
+ */
+inline std::map<uint8_t, LatencyHistogram> eventLatencies(const std::vector<EventTraceRecord>& records)
+{
+	std::map<uint8_t, LatencyHistogram> histograms;
+	std::map<uint8_t, uint32_t> firstPendingSet;
+	for (const auto& record : records)
+	{
+		if (record.kind == EventTraceKind::Set)
+		{
+			firstPendingSet.insert(std::make_pair(record.eventNo, record.timestampUs));
+		}
+		else
+		{
+			auto pending = firstPendingSet.find(record.eventNo);
+			if (pending != firstPendingSet.end())
+			{
+				histograms[record.eventNo].add(record.timestampUs - pending->second);
+				firstPendingSet.erase(pending);
+			}
+		}
+	}
+	return histograms;
+}
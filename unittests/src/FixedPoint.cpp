@@ -0,0 +1,98 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+#include "StringStreamer.h"
+
+#include <FixedPoint.h>
+#include <EnumNames.h>
+
+using namespace testing;
+
+namespace
+{
+	constexpr int64_t Invalid = -999999999999;
+
+	template <typename T, unsigned Decimals>
+	int64_t scaledOf(const char* pStr)
+	{
+		auto decimal = stringToDecimal<T, Decimals>(pStr);
+		return decimal.is_initialized() ? (*decimal).scaled : Invalid;
+	}
+
+	template <typename T, unsigned FractionalBits>
+	int64_t rawOf(const char* pStr)
+	{
+		auto fixed = stringToFixed<T, FractionalBits>(pStr);
+		return fixed.is_initialized() ? (*fixed).raw : Invalid;
+	}
+}
+
+TEST(FixedPoint, decimals_are_scaled)
+{
+	ASSERT_THAT((scaledOf<int32_t, 2>("1.25")), Eq(125));
+	ASSERT_THAT((scaledOf<int32_t, 2>("1.5")), Eq(150));
+	ASSERT_THAT((scaledOf<int32_t, 2>("7")), Eq(700));
+	ASSERT_THAT((scaledOf<int32_t, 2>("-0.05")), Eq(-5));
+	ASSERT_THAT((scaledOf<int32_t, 2>("+.5")), Eq(50));
+	ASSERT_THAT((scaledOf<int32_t, 0>("-42")), Eq(-42));
+	ASSERT_THAT((scaledOf<uint16_t, 1>("6553.5")), Eq(65535));
+	ASSERT_THAT((scaledOf<int32_t, 2>("21474836.47")), Eq(2147483647));
+	ASSERT_THAT((scaledOf<int32_t, 2>("-21474836.47")), Eq(-2147483647));
+}
+
+TEST(FixedPoint, invalid_decimals_are_rejected)
+{
+	ASSERT_THAT((scaledOf<int32_t, 2>("1.255")), Eq(Invalid)); //more decimals than stored
+	ASSERT_THAT((scaledOf<int32_t, 2>("21474836.48")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<int32_t, 2>("99999999999999999999")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<uint16_t, 1>("-1")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<int32_t, 2>("1.")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<int32_t, 2>(".")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<int32_t, 2>("-")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<int32_t, 2>("")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<int32_t, 2>("1.2x")), Eq(Invalid));
+	ASSERT_THAT((scaledOf<int32_t, 2>("1,2")), Eq(Invalid));
+}
+
+TEST(FixedPoint, decimals_are_written_with_all_digits)
+{
+	ASSERT_THAT((decimalToString(Decimal<int32_t, 2>{125})), Eq("1.25"));
+	ASSERT_THAT((decimalToString(Decimal<int32_t, 2>{-5})), Eq("-0.05"));
+	ASSERT_THAT((decimalToString(Decimal<int32_t, 2>{700})), Eq("7.00"));
+	ASSERT_THAT((decimalToString(Decimal<int32_t, 0>{-42})), Eq("-42"));
+	ASSERT_THAT((decimalToString(Decimal<int32_t, 3>{-2147483647 - 1})), Eq("-2147483.648"));
+	ASSERT_THAT((decimalToString(Decimal<uint32_t, 9>{4294967295u})), Eq("4.294967295"));
+}
+
+TEST(FixedPoint, fixed_point_numbers_are_rounded_to_the_nearest_value)
+{
+	ASSERT_THAT((rawOf<int32_t, 16>("1.5")), Eq(0x18000));
+	ASSERT_THAT((rawOf<int32_t, 16>("-1.5")), Eq(-0x18000));
+	ASSERT_THAT((rawOf<int32_t, 16>("0.00001")), Eq(1)); //0.655 of the last bit
+	ASSERT_THAT((rawOf<int32_t, 16>("0.000007")), Eq(0)); //0.459 of it
+	ASSERT_THAT((rawOf<int16_t, 8>("127.99609375")), Eq(0x7fff));
+	ASSERT_THAT((rawOf<uint8_t, 8>("0.5")), Eq(0x80));
+	ASSERT_THAT((rawOf<int32_t, 31>("-0.999999999")), Eq(-2147483646));
+	ASSERT_THAT((Fixed<int32_t, 16>::one()), Eq(0x10000));
+}
+
+TEST(FixedPoint, fixed_point_numbers_out_of_range_are_rejected)
+{
+	ASSERT_THAT((rawOf<int16_t, 8>("128")), Eq(Invalid));
+	ASSERT_THAT((rawOf<int16_t, 8>("127.999")), Eq(Invalid)); //rounds up to 128
+	ASSERT_THAT((rawOf<uint8_t, 8>("1")), Eq(Invalid));
+	ASSERT_THAT((rawOf<uint8_t, 4>("-1")), Eq(Invalid));
+	ASSERT_THAT((rawOf<int32_t, 16>("1e3")), Eq(Invalid));
+	ASSERT_THAT((rawOf<int32_t, 16>("0.1234567890")), Eq(Invalid)); //more than 9 decimals
+}
+
+TEST(FixedPoint, enums_are_parsed_by_their_names)
+{
+	ASSERT_TRUE(*stringToEnum<OnOff>("on") == OnOff::On);
+	ASSERT_TRUE(*stringToEnum<OnOff>("off") == OnOff::Off);
+	ASSERT_FALSE(stringToEnum<OnOff>("On").is_initialized());
+	ASSERT_FALSE(stringToEnum<OnOff>("o").is_initialized());
+	ASSERT_FALSE(stringToEnum<OnOff>("onn").is_initialized());
+	ASSERT_TRUE(*stringToEnum<Side>("R") == Side::Right);
+	ASSERT_THAT(enumToString(Side::Left), StrEq("L"));
+	ASSERT_THAT(enumToString(static_cast<Side>(7)), StrEq(""));
+}
@@ -286,3 +286,29 @@ TEST(LineInputStrategy, HistoryController)
 		lineInputStrategy.rxChar(ioStream, c);
 	}
 }
+
+TEST(LineInputStrategy, tab_appends_the_completion)
+{
+	struct TestCompleter
+	{
+		StringSlice complete(const String<10>& line) const
+		{
+			return (line == "mo") ? StringSlice{"tstat"} : StringSlice{};
+		}
+	};
+
+	LineSinkMock lineSink;
+	IOStreamMock ioStream;
+	auto lineInputStrategy = makeLineInputStrategy<10>(
+		LineSinkForwarder{&lineSink},
+		DiscardingEchoConsole<10>{},
+		NoHistoryController<10>{},
+		TestCompleter{}
+	);
+
+	EXPECT_CALL(lineSink, lineCompleted(_, String<10>{"motstatx"}));
+	for (auto c : std::string{"mo\tx\t\n"})
+	{
+		lineInputStrategy.rxChar(ioStream, c);
+	}
+}
@@ -114,3 +114,20 @@ TEST(NumberConversion, numberToHex)
 	ASSERT_THAT(numberToHex<uint32_t>(0x1), Eq("00000001"));
 	ASSERT_THAT(numberToHex<uint64_t>(0x1), Eq("0000000000000001"));
 }
+
+TEST(NumberConversion, a_slice_is_parsed_up_to_its_end)
+{
+	const char digits[] = "12345";
+	ASSERT_THAT(*stringToNumber<uint16_t>(StringSlice{digits, digits + 3}), Eq(123));
+	ASSERT_THAT(*stringToNumber<int16_t>(StringSlice{"-42"}), Eq(-42));
+	ASSERT_FALSE(stringToNumber<uint8_t>(StringSlice{digits, digits}).is_initialized());
+	ASSERT_FALSE(stringToNumber<int8_t>(StringSlice{"-"}).is_initialized());
+}
+
+TEST(NumberConversion, a_string_is_parsed_up_to_its_size)
+{
+	String<10> str{"98765"};
+	str.erase();
+	str.append("1");
+	ASSERT_THAT(*stringToNumber<uint32_t>(str), Eq(1u));
+}
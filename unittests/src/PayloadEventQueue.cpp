@@ -0,0 +1,89 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+
+#include <PayloadEventQueue.h>
+#include <EventHandler.h>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+	enum class PayloadEvent : uint8_t
+	{
+		EnemyDistance,
+		RemoteCommand,
+		EdgeDetected,
+		AmountOfEvents //!< must be last
+	};
+
+	struct EmptyLock
+	{
+	};
+
+	struct RemoteCommand
+	{
+		int8_t speed;
+		int8_t direction;
+	};
+
+	using Queue = PayloadEventQueue<PayloadEvent, EmptyLock,
+		LatestWins<uint16_t>,
+		QueueAll<RemoteCommand, 3>,
+		LatestWins<bool>>;
+}
+
+TEST(PayloadEventQueue, When_I_do_nothing_no_event_is_pending) {
+	Queue queue;
+
+	ASSERT_THAT(queue.pendingEvents(), Eq(0u));
+	ASSERT_FALSE(queue.take<PayloadEvent::EnemyDistance>());
+}
+
+TEST(PayloadEventQueue, When_I_post_latest_wins_only_the_last_payload_is_kept) {
+	Queue queue;
+
+	queue.post<PayloadEvent::EnemyDistance>(80);
+	queue.post<PayloadEvent::EnemyDistance>(40);
+	ASSERT_THAT(queue.pendingEvents(), Eq(0x1u));
+	ASSERT_THAT(*queue.take<PayloadEvent::EnemyDistance>(), Eq(40));
+	ASSERT_FALSE(queue.take<PayloadEvent::EnemyDistance>());
+	ASSERT_THAT(queue.pendingEvents(), Eq(0u));
+}
+
+TEST(PayloadEventQueue, When_I_post_queue_all_every_payload_is_kept_in_order_until_the_channel_is_full) {
+	Queue queue;
+
+	ASSERT_TRUE(queue.post<PayloadEvent::RemoteCommand>(RemoteCommand{1, 0}));
+	ASSERT_TRUE(queue.post<PayloadEvent::RemoteCommand>(RemoteCommand{2, 0}));
+	ASSERT_TRUE(queue.post<PayloadEvent::RemoteCommand>(RemoteCommand{3, 0}));
+	ASSERT_FALSE(queue.post<PayloadEvent::RemoteCommand>(RemoteCommand{4, 0}));
+
+	ASSERT_THAT((*queue.take<PayloadEvent::RemoteCommand>()).speed, Eq(1));
+	ASSERT_THAT(queue.pendingEvents(), Eq(0x2u));
+	ASSERT_THAT((*queue.take<PayloadEvent::RemoteCommand>()).speed, Eq(2));
+	ASSERT_THAT((*queue.take<PayloadEvent::RemoteCommand>()).speed, Eq(3));
+	ASSERT_THAT(queue.pendingEvents(), Eq(0u));
+}
+
+TEST(PayloadEventQueue, When_I_handle_one_event_the_lowest_pending_event_gets_its_payload) {
+	Queue queue;
+
+	queue.post<PayloadEvent::EdgeDetected>(true);
+	queue.post<PayloadEvent::RemoteCommand>(RemoteCommand{5, -1});
+	queue.post<PayloadEvent::RemoteCommand>(RemoteCommand{6, 1});
+
+	std::vector<int> handled;
+	auto doHandle = [&]{
+		return handleOnePayloadEvent(queue,
+			[&](uint16_t cm){ handled.push_back(cm); },
+			[&](const RemoteCommand& command){ handled.push_back(command.speed); },
+			[&](bool edge){ handled.push_back(edge ? 100 : -100); }
+		);
+	};
+
+	while (doHandle())
+	{
+	}
+	ASSERT_THAT(handled, ElementsAre(5, 6, 100));
+}
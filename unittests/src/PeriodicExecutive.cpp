@@ -0,0 +1,124 @@
+#include <gmock/gmock.h>
+
+#include <PeriodicExecutive.h>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+	struct EmptyLock
+	{
+	};
+
+	uint32_t fakeTimeUs = 0;
+
+	struct FakeClock
+	{
+		static uint32_t nowUs()
+		{
+			return fakeTimeUs;
+		}
+	};
+
+	using Executive = PeriodicExecutive<FakeClock, EmptyLock>;
+
+	/**
+	 * starts a cycle at startUs, the phases take senseUs, decideUs and actUs
+	 */
+	bool runCycleAt(Executive& executive, uint32_t startUs, uint32_t senseUs, uint32_t decideUs, uint32_t actUs)
+	{
+		fakeTimeUs = startUs;
+		return executive.runCycle(
+			[&]{ fakeTimeUs += senseUs; },
+			[&]{ fakeTimeUs += decideUs; },
+			[&]{ fakeTimeUs += actUs; });
+	}
+}
+
+TEST(PeriodicExecutive, runs_the_phases_in_order)
+{
+	Executive executive(1000);
+	std::vector<ControlPhase> phases;
+	executive.runCycle(
+		[&]{ phases.push_back(ControlPhase::Sense); },
+		[&]{ phases.push_back(ControlPhase::Decide); },
+		[&]{ phases.push_back(ControlPhase::Act); });
+	ASSERT_THAT(phases, ElementsAre(ControlPhase::Sense, ControlPhase::Decide, ControlPhase::Act));
+	ASSERT_THAT(executive.getStats().cycles, Eq(1));
+}
+
+TEST(PeriodicExecutive, keeps_the_worst_case_execution_time_per_phase)
+{
+	Executive executive(1000);
+	runCycleAt(executive, 0, 10, 20, 30);
+	runCycleAt(executive, 1000, 40, 5, 30);
+	runCycleAt(executive, 2000, 10, 5, 5);
+
+	auto stats = executive.getStats();
+	ASSERT_THAT(stats.cycles, Eq(3));
+	ASSERT_THAT(stats.lastExecUs, Eq(20));
+	ASSERT_THAT(stats.wcetUs, Eq(75));
+	ASSERT_THAT(stats.phaseWcetUs, ElementsAre(40, 20, 30));
+	ASSERT_THAT(stats.overruns, Eq(0));
+}
+
+TEST(PeriodicExecutive, jitter_is_the_distance_from_the_release_time)
+{
+	Executive executive(1000);
+	runCycleAt(executive, 500, 1, 1, 1);
+	runCycleAt(executive, 1500, 1, 1, 1);
+	runCycleAt(executive, 2530, 1, 1, 1);
+	runCycleAt(executive, 3490, 1, 1, 1);
+
+	auto stats = executive.getStats();
+	ASSERT_THAT(stats.maxJitterUs, Eq(30));
+	ASSERT_THAT(stats.totalJitterUs, Eq(40));
+	ASSERT_THAT(stats.averageJitterUs(), Eq(10));
+}
+
+TEST(PeriodicExecutive, an_overrun_is_counted_and_realigns_the_release_times)
+{
+	Executive executive(1000);
+	ASSERT_FALSE(runCycleAt(executive, 0, 100, 100, 100));
+	ASSERT_TRUE(runCycleAt(executive, 1000, 100, 1000, 100));
+	ASSERT_THAT(executive.getStats().overruns, Eq(1));
+
+	//the late cycle starts the new release times, it isn't jitter
+	ASSERT_FALSE(runCycleAt(executive, 2200, 100, 100, 100));
+	ASSERT_FALSE(runCycleAt(executive, 3200, 100, 100, 100));
+	auto stats = executive.getStats();
+	ASSERT_THAT(stats.overruns, Eq(1));
+	ASSERT_THAT(stats.maxJitterUs, Eq(0));
+	ASSERT_THAT(stats.wcetUs, Eq(1200));
+}
+
+TEST(PeriodicExecutive, works_across_the_wrap_around_of_the_clock)
+{
+	Executive executive(1000);
+	runCycleAt(executive, UINT32_MAX - 1500, 10, 10, 10);
+	ASSERT_FALSE(runCycleAt(executive, UINT32_MAX - 495, 10, 10, 10));
+	ASSERT_FALSE(runCycleAt(executive, 500, 10, 10, 10));
+
+	auto stats = executive.getStats();
+	ASSERT_THAT(stats.maxJitterUs, Eq(5));
+	ASSERT_THAT(stats.wcetUs, Eq(30));
+	ASSERT_THAT(stats.overruns, Eq(0));
+}
+
+TEST(PeriodicExecutive, changing_the_period_clears_the_stats)
+{
+	Executive executive(1000);
+	runCycleAt(executive, 0, 10, 10, 10);
+	runCycleAt(executive, 1100, 10, 10, 10);
+	executive.setPeriodUs(5000);
+
+	auto stats = executive.getStats();
+	ASSERT_THAT(stats.periodUs, Eq(5000));
+	ASSERT_THAT(stats.cycles, Eq(0));
+	ASSERT_THAT(stats.maxJitterUs, Eq(0));
+
+	runCycleAt(executive, 7000, 10, 10, 10);
+	runCycleAt(executive, 12000, 10, 10, 10);
+	ASSERT_THAT(executive.getStats().maxJitterUs, Eq(0));
+}
@@ -0,0 +1,153 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+
+#include <PriorityMessageQueue.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+	struct EmptyLock
+	{
+	};
+
+	std::mutex queueMutex;
+
+	struct MutexLock
+	{
+		MutexLock()
+		{
+			queueMutex.lock();
+		}
+
+		~MutexLock()
+		{
+			queueMutex.unlock();
+		}
+	};
+
+	struct ProducerMessage
+	{
+		size_t producer;
+		size_t sequence;
+	};
+}
+
+TEST(PriorityMessageQueue, drain_returns_the_highest_priority_first_and_keeps_the_order_within_a_priority)
+{
+	PriorityMessageQueue<int, 3, 4, EmptyLock> queue;
+	queue.try_push(2, 20);
+	queue.try_push(0, 1);
+	queue.try_push(2, 21);
+	queue.try_push(1, 10);
+	queue.try_push(0, 2);
+	ASSERT_THAT(queue.size(), Eq(5));
+
+	std::array<int, 8> messages{};
+	ASSERT_THAT(queue.drain(messages), Eq(5));
+	ASSERT_THAT(std::vector<int>(messages.begin(), messages.begin() + 5), ElementsAre(1, 2, 10, 20, 21));
+	ASSERT_THAT(queue.size(), Eq(0));
+}
+
+TEST(PriorityMessageQueue, drain_stops_when_the_array_is_full_and_keeps_the_rest)
+{
+	PriorityMessageQueue<int, 2, 4, EmptyLock> queue;
+	queue.try_push(1, 10);
+	queue.try_push(0, 1);
+	queue.try_push(0, 2);
+
+	std::array<int, 2> messages{};
+	ASSERT_THAT(queue.drain(messages), Eq(2));
+	ASSERT_THAT(messages, ElementsAre(1, 2));
+	ASSERT_THAT(queue.drain(messages), Eq(1));
+	ASSERT_THAT(messages[0], Eq(10));
+}
+
+TEST(PriorityMessageQueue, try_pop_takes_one_message_in_the_order_of_drain)
+{
+	PriorityMessageQueue<int, 2, 4, EmptyLock> queue;
+	queue.try_push(1, 10);
+	queue.try_push(0, 1);
+	queue.try_push(1, 11);
+
+	std::vector<int> popped;
+	for (auto message = queue.try_pop(); message; message = queue.try_pop())
+	{
+		popped.push_back(*message);
+	}
+	ASSERT_THAT(popped, ElementsAre(1, 10, 11));
+	ASSERT_THAT(queue.size(), Eq(0));
+}
+
+TEST(PriorityMessageQueue, a_full_lane_drops_the_message_without_affecting_other_lanes)
+{
+	PriorityMessageQueue<int, 2, 2, EmptyLock> queue;
+	ASSERT_TRUE(queue.try_push(1, 10));
+	ASSERT_TRUE(queue.try_push(1, 11));
+	ASSERT_FALSE(queue.try_push(1, 12));
+	ASSERT_TRUE(queue.try_push(0, 1));
+	ASSERT_THAT(queue.dropped(), Eq(1));
+
+	std::array<int, 4> messages{};
+	ASSERT_THAT(queue.drain(messages), Eq(3));
+	ASSERT_THAT(std::vector<int>(messages.begin(), messages.begin() + 3), ElementsAre(1, 10, 11));
+}
+
+TEST(PriorityMessageQueue, assert_on_invalid_priority)
+{
+	PriorityMessageQueue<int, 2, 2, EmptyLock> queue;
+	ASSERT_THROW(queue.try_push(2, 0), AssertionFailedException);
+}
+
+TEST(PriorityMessageQueue, stress_multiple_producers_keep_their_order_per_priority)
+{
+	constexpr size_t NofProducers = 4;
+	constexpr size_t NofMessages = 20000;
+	PriorityMessageQueue<ProducerMessage, 2, 16, MutexLock> queue;
+
+	std::vector<std::thread> producers;
+	for (auto producer = size_t{0}; producer < NofProducers; ++producer)
+	{
+		producers.emplace_back([&queue, producer]
+		{
+			for (auto sequence = size_t{0}; sequence < NofMessages; ++sequence)
+			{
+				while (!queue.try_push(producer % 2, ProducerMessage{producer, sequence}))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::array<size_t, NofProducers> nextSequence{};
+	auto received = size_t{0};
+	while (received < NofProducers * NofMessages)
+	{
+		std::array<ProducerMessage, 32> messages;
+		auto count = queue.drain(messages);
+		auto lastPriority = size_t{0};
+		for (auto i = size_t{0}; i < count; ++i)
+		{
+			auto& message = messages[i];
+			ASSERT_THAT(message.sequence, Eq(nextSequence[message.producer]));
+			ASSERT_THAT(message.producer % 2, Ge(lastPriority));
+			lastPriority = message.producer % 2;
+			++nextSequence[message.producer];
+		}
+		received += count;
+		if (count == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	for (auto& producer : producers)
+	{
+		producer.join();
+	}
+	ASSERT_THAT(nextSequence, Each(Eq(NofMessages)));
+}
@@ -0,0 +1,157 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+#include "Benchmark.h"
+
+#include <SlidingWindow.h>
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+using namespace testing;
+
+TEST(SlidingWindow, newest_oldest_and_delta_follow_the_last_N_samples)
+{
+	SlidingWindow<int32_t, 3> window;
+	window.push(10);
+	ASSERT_THAT(window.size(), Eq(1));
+	ASSERT_THAT(window.delta(), Eq(0));
+
+	window.push(15);
+	window.push(17);
+	ASSERT_TRUE(window.full());
+	ASSERT_THAT(window.oldest(), Eq(10));
+	ASSERT_THAT(window.newest(), Eq(17));
+	ASSERT_THAT(window.delta(), Eq(7));
+
+	window.push(12);
+	ASSERT_THAT(window.size(), Eq(3));
+	ASSERT_THAT(window.oldest(), Eq(15));
+	ASSERT_THAT(window.delta(), Eq(-3));
+}
+
+TEST(SlidingWindow, sum_and_mean_only_contain_the_samples_in_the_window)
+{
+	SlidingWindow<int32_t, 4, WindowSum> window;
+	for (auto value : {1, 2, 3, 4})
+	{
+		window.push(value);
+	}
+	ASSERT_THAT(window.sum(), Eq(10));
+	ASSERT_THAT(window.mean(), Eq(2));
+
+	window.push(10);
+	ASSERT_THAT(window.sum(), Eq(19));
+	ASSERT_THAT(window.mean(), Eq(4));
+}
+
+TEST(SlidingWindow, sum_of_small_types_does_not_overflow)
+{
+	SlidingWindow<int16_t, 4, WindowSum> window;
+	for (auto i = 0; i < 4; ++i)
+	{
+		window.push(30000);
+	}
+	ASSERT_THAT(window.sum(), Eq(120000));
+}
+
+TEST(SlidingWindow, min_and_max_expire_when_they_leave_the_window)
+{
+	SlidingWindow<int32_t, 3, WindowMin, WindowMax> window;
+	window.push(5);
+	window.push(1);
+	window.push(9);
+	ASSERT_THAT(window.min(), Eq(1));
+	ASSERT_THAT(window.max(), Eq(9));
+	ASSERT_THAT(window.range(), Eq(8));
+
+	window.push(7); //5 leaves
+	ASSERT_THAT(window.min(), Eq(1));
+	window.push(8); //1 leaves
+	ASSERT_THAT(window.min(), Eq(7));
+	ASSERT_THAT(window.max(), Eq(9));
+	window.push(6); //9 leaves
+	ASSERT_THAT(window.min(), Eq(6));
+	ASSERT_THAT(window.max(), Eq(8));
+}
+
+TEST(SlidingWindow, equal_samples_are_kept_until_the_last_one_left_the_window)
+{
+	SlidingWindow<int32_t, 3, WindowMax> window;
+	window.push(4);
+	window.push(4);
+	window.push(1);
+	window.push(2); //first 4 leaves
+	ASSERT_THAT(window.max(), Eq(4));
+	window.push(3); //second 4 leaves
+	ASSERT_THAT(window.max(), Eq(3));
+}
+
+TEST(SlidingWindow, aggregates_match_a_rescan_of_the_window_for_random_samples)
+{
+	constexpr size_t N = 7;
+	SlidingWindow<int32_t, N, WindowSum, WindowMin, WindowMax> window;
+	std::vector<int32_t> samples;
+	std::srand(42);
+	for (auto i = 0; i < 1000; ++i)
+	{
+		auto value = std::rand() % 200 - 100;
+		window.push(value);
+		samples.push_back(value);
+
+		auto first = samples.size() > N ? samples.end() - N : samples.begin();
+		ASSERT_THAT(window.sum(), Eq(std::accumulate(first, samples.end(), 0)));
+		ASSERT_THAT(window.min(), Eq(*std::min_element(first, samples.end())));
+		ASSERT_THAT(window.max(), Eq(*std::max_element(first, samples.end())));
+	}
+}
+
+TEST(SlidingWindow, clear_removes_all_samples)
+{
+	SlidingWindow<int32_t, 3, WindowSum, WindowMin> window;
+	window.push(1);
+	window.push(2);
+	window.clear();
+	ASSERT_THAT(window.size(), Eq(0));
+	ASSERT_THAT(window.sum(), Eq(0));
+
+	window.push(5);
+	ASSERT_THAT(window.min(), Eq(5));
+	ASSERT_THAT(window.mean(), Eq(5));
+}
+
+TEST(SlidingWindow, benchmark_incremental_vs_rescan)
+{
+	constexpr size_t N = 64;
+	constexpr size_t Runs = 100000;
+	std::vector<int32_t> values(1024);
+	std::srand(1);
+	for (auto& value : values)
+	{
+		value = std::rand() % 1000;
+	}
+
+	auto check = int64_t{0};
+	SlidingWindow<int32_t, N, WindowSum, WindowMin, WindowMax> window;
+	auto i = size_t{0};
+	reportBenchmark("SlidingWindow<64> sum/min/max incremental", measureNsPerRun(Runs, [&]
+	{
+		window.push(values[i++ % values.size()]);
+		check += window.sum() + window.min() + window.max();
+	}), "ns/sample");
+
+	auto rescanCheck = int64_t{0};
+	CircularBuffer<int32_t, N, CircularBufferFullStrategy::OverwriteOldest> history;
+	std::array<int32_t, N> copy{};
+	i = 0;
+	reportBenchmark("CircularBuffer<64> sum/min/max rescan", measureNsPerRun(Runs, [&]
+	{
+		history.push_back(values[i++ % values.size()]);
+		auto count = history.copy_to(copy);
+		rescanCheck += std::accumulate(copy.begin(), copy.begin() + count, 0)
+			+ *std::min_element(copy.begin(), copy.begin() + count)
+			+ *std::max_element(copy.begin(), copy.begin() + count);
+	}), "ns/sample");
+
+	ASSERT_THAT(check, Eq(rescanCheck));
+}
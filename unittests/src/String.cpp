@@ -188,3 +188,15 @@ TEST(String, when_initialized_from_empty_string_then_character_is_an_empty_strin
 	String<5> str{""};
 	EXPECT_THAT(str, Eq(""));
 }
+
+TEST(String, a_slice_views_the_characters_of_a_string)
+{
+	String<10> str{"abcdef"};
+	StringSlice slice{str.begin() + 1, str.begin() + 3};
+	EXPECT_THAT(slice.size(), Eq(2));
+	EXPECT_THAT(slice.begin(), Eq(str.begin() + 1));
+	EXPECT_TRUE(slice == "bc");
+	EXPECT_TRUE(slice != "bcd");
+	EXPECT_TRUE(StringSlice{str} == "abcdef");
+	EXPECT_TRUE(StringSlice{}.empty());
+}
@@ -0,0 +1,329 @@
+#include <gmock/gmock.h>
+#include "TestAssert.h"
+#include "Benchmark.h"
+
+#include <TimerWheel.h>
+#include <algorithm>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+	struct EmptyLock
+	{
+	};
+
+	struct Firing
+	{
+		std::vector<uint32_t>* pFiredAt;
+		const uint32_t* pNow;
+		size_t index;
+	};
+
+	void recordFiring(void* pData)
+	{
+		auto& firing = *static_cast<Firing*>(pData);
+		(*firing.pFiredAt)[firing.index] = *firing.pNow;
+	}
+
+	/**
+	 * schedules one entry per delay after startTicks ticks and checks that every entry fires
+	 * exactly at its tick
+	 */
+	template <typename Wheel>
+	void expectEveryDelayFiresOnTime(Wheel& wheel, uint32_t startTicks, const std::vector<uint32_t>& delays)
+	{
+		for (auto i = uint32_t{0}; i < startTicks; ++i)
+		{
+			wheel.tick();
+		}
+
+		uint32_t now = 0;
+		std::vector<uint32_t> firedAt(delays.size(), 0);
+		std::vector<TimerWheelEntry> entries(delays.size());
+		std::vector<Firing> firings(delays.size());
+		uint32_t maxDelay = 0;
+		for (auto i = size_t{0}; i < delays.size(); ++i)
+		{
+			firings[i] = Firing{&firedAt, &now, i};
+			wheel.schedule(entries[i], delays[i], recordFiring, &firings[i]);
+			maxDelay = std::max(maxDelay, delays[i]);
+		}
+		for (now = 1; now <= maxDelay; ++now)
+		{
+			wheel.tick();
+		}
+
+		for (auto i = size_t{0}; i < delays.size(); ++i)
+		{
+			ASSERT_THAT(firedAt[i], Eq(delays[i])) << "delay " << delays[i] << " started after " << startTicks << " ticks";
+		}
+	}
+
+	/**
+	 * what TRG_IncTick did before the timer wheel: decrement every trigger, then rescan the table
+	 * until no callback fires anymore
+	 */
+	template <size_t NofTriggers>
+	class LinearTriggerTable
+	{
+	public:
+		void schedule(size_t index, uint16_t ticks, TimerWheelEntry::Callback callback, void* pData)
+		{
+			triggers[index] = Trigger{ticks, callback, pData};
+		}
+
+		void tick()
+		{
+			for (auto& trigger : triggers)
+			{
+				if (trigger.ticks != 0)
+				{
+					--trigger.ticks;
+				}
+			}
+			while (checkCallbacks())
+			{
+			}
+		}
+
+	private:
+		struct Trigger
+		{
+			uint16_t ticks;
+			TimerWheelEntry::Callback callback;
+			void* pData;
+		};
+
+		bool checkCallbacks()
+		{
+			auto calledCallback = false;
+			for (auto& trigger : triggers)
+			{
+				if (trigger.ticks == 0 && trigger.callback != nullptr)
+				{
+					auto callback = trigger.callback;
+					trigger.callback = nullptr;
+					callback(trigger.pData);
+					calledCallback = true;
+				}
+			}
+			return calledCallback;
+		}
+
+		std::array<Trigger, NofTriggers> triggers{};
+	};
+
+	void doNothing(void*)
+	{
+	}
+}
+
+TEST(TimerWheel, fires_after_the_delay)
+{
+	TimerWheel<4, 4, EmptyLock> wheel;
+	TimerWheelEntry entry;
+	auto calls = 0;
+	wheel.schedule(entry, 3, [](void* pData) { ++*static_cast<int*>(pData); }, &calls);
+	ASSERT_TRUE(wheel.isScheduled(entry));
+
+	wheel.tick();
+	wheel.tick();
+	ASSERT_THAT(calls, Eq(0));
+	wheel.tick();
+	ASSERT_THAT(calls, Eq(1));
+	ASSERT_FALSE(wheel.isScheduled(entry));
+	wheel.tick();
+	ASSERT_THAT(calls, Eq(1));
+}
+
+TEST(TimerWheel, a_delay_of_zero_fires_at_the_next_tick)
+{
+	TimerWheel<4, 4, EmptyLock> wheel;
+	TimerWheelEntry entry;
+	auto calls = 0;
+	wheel.schedule(entry, 0, [](void* pData) { ++*static_cast<int*>(pData); }, &calls);
+	ASSERT_THAT(calls, Eq(0));
+	wheel.tick();
+	ASSERT_THAT(calls, Eq(1));
+}
+
+TEST(TimerWheel, every_delay_fires_on_time_from_every_start)
+{
+	using Wheel = TimerWheel<2, 3, EmptyLock>;
+	std::vector<uint32_t> delays;
+	for (auto delay = uint32_t{1}; delay <= Wheel::MaxDelay; ++delay)
+	{
+		delays.push_back(delay);
+	}
+	for (auto start = uint32_t{0}; start < 3 * (Wheel::MaxDelay + 1); ++start)
+	{
+		Wheel wheel;
+		expectEveryDelayFiresOnTime(wheel, start, delays);
+	}
+}
+
+TEST(TimerWheel, long_delays_fire_on_time_across_all_levels)
+{
+	using Wheel = TimerWheel<4, 4, EmptyLock>;
+	std::vector<uint32_t> delays;
+	for (auto delay = uint32_t{1}; delay <= 300; ++delay)
+	{
+		delays.push_back(delay);
+	}
+	for (auto delay = uint32_t{301}; delay < Wheel::MaxDelay; delay += 97)
+	{
+		delays.push_back(delay);
+	}
+	delays.push_back(Wheel::MaxDelay);
+
+	for (auto start : {0u, 1u, 15u, 255u, 4095u, 12345u})
+	{
+		Wheel wheel;
+		expectEveryDelayFiresOnTime(wheel, start, delays);
+	}
+}
+
+TEST(TimerWheel, scheduling_again_moves_the_entry)
+{
+	TimerWheel<4, 4, EmptyLock> wheel;
+	TimerWheelEntry entry;
+	auto calls = 0;
+	auto count = [](void* pData) { ++*static_cast<int*>(pData); };
+	wheel.schedule(entry, 2, count, &calls);
+	wheel.schedule(entry, 40, count, &calls);
+	for (auto i = 0; i < 39; ++i)
+	{
+		wheel.tick();
+	}
+	ASSERT_THAT(calls, Eq(0));
+	wheel.tick();
+	ASSERT_THAT(calls, Eq(1));
+}
+
+TEST(TimerWheel, a_cancelled_entry_does_not_fire)
+{
+	TimerWheel<4, 4, EmptyLock> wheel;
+	std::array<TimerWheelEntry, 3> entries;
+	auto calls = 0;
+	auto count = [](void* pData) { ++*static_cast<int*>(pData); };
+	for (auto& entry : entries)
+	{
+		wheel.schedule(entry, 5, count, &calls);
+	}
+	wheel.cancel(entries[1]);
+	ASSERT_FALSE(wheel.isScheduled(entries[1]));
+	for (auto i = 0; i < 5; ++i)
+	{
+		wheel.tick();
+	}
+	ASSERT_THAT(calls, Eq(2));
+}
+
+TEST(TimerWheel, a_callback_may_schedule_again_for_the_current_tick)
+{
+	using Wheel = TimerWheel<4, 4, EmptyLock>;
+	struct Periodic
+	{
+		Wheel* pWheel;
+		TimerWheelEntry entry;
+		int calls;
+		uint32_t delay;
+
+		static void fire(void* pData)
+		{
+			auto& periodic = *static_cast<Periodic*>(pData);
+			++periodic.calls;
+			if (periodic.calls < 3)
+			{
+				periodic.pWheel->schedule(periodic.entry, periodic.delay, fire, &periodic);
+			}
+		}
+	};
+
+	Wheel wheel;
+	Periodic immediate{&wheel, {}, 0, 0};
+	Periodic everyTenTicks{&wheel, {}, 0, 10};
+	wheel.schedule(immediate.entry, 1, Periodic::fire, &immediate);
+	wheel.schedule(everyTenTicks.entry, 10, Periodic::fire, &everyTenTicks);
+
+	wheel.tick();
+	ASSERT_THAT(immediate.calls, Eq(3));
+	for (auto i = 0; i < 18; ++i)
+	{
+		wheel.tick();
+	}
+	ASSERT_THAT(everyTenTicks.calls, Eq(1));
+	wheel.tick();
+	ASSERT_THAT(everyTenTicks.calls, Eq(2));
+}
+
+TEST(TimerWheel, assert_on_too_long_delay)
+{
+	TimerWheel<2, 2, EmptyLock> wheel;
+	TimerWheelEntry entry;
+	ASSERT_THROW(wheel.schedule(entry, 16, doNothing, nullptr), AssertionFailedException);
+}
+
+namespace
+{
+	constexpr size_t BenchmarkTicks = 100000;
+
+	template <size_t NofTriggers>
+	void benchmarkIdleTriggers()
+	{
+		//all triggers wait for a long time, like a debounce trigger which is not pressed
+		LinearTriggerTable<NofTriggers> table;
+		TimerWheel<4, 4, EmptyLock> wheel;
+		std::array<TimerWheelEntry, NofTriggers> entries;
+		for (auto i = size_t{0}; i < NofTriggers; ++i)
+		{
+			table.schedule(i, UINT16_MAX, doNothing, nullptr);
+			wheel.schedule(entries[i], UINT16_MAX, doNothing, nullptr);
+		}
+
+		auto name = std::to_string(NofTriggers) + " idle triggers";
+		reportBenchmark("linear trigger table, " + name, measureCyclesPerRun(BenchmarkTicks, [&] { table.tick(); }), "cycles/tick");
+		reportBenchmark("timer wheel, " + name, measureCyclesPerRun(BenchmarkTicks, [&] { wheel.tick(); }), "cycles/tick");
+	}
+
+	template <size_t NofTriggers>
+	void benchmarkPeriodicTriggers()
+	{
+		//every trigger fires every NofTriggers ticks and is set again
+		struct Periodic
+		{
+			static void fire(void*)
+			{
+			}
+		};
+		LinearTriggerTable<NofTriggers> table;
+		TimerWheel<4, 4, EmptyLock> wheel;
+		std::array<TimerWheelEntry, NofTriggers> entries;
+		size_t tableTick = 0;
+		size_t wheelTick = 0;
+
+		auto name = std::to_string(NofTriggers) + " periodic triggers";
+		reportBenchmark("linear trigger table, " + name, measureCyclesPerRun(BenchmarkTicks, [&]
+		{
+			table.schedule(tableTick++ % NofTriggers, NofTriggers, Periodic::fire, nullptr);
+			table.tick();
+		}), "cycles/tick");
+		reportBenchmark("timer wheel, " + name, measureCyclesPerRun(BenchmarkTicks, [&]
+		{
+			wheel.schedule(entries[wheelTick++ % NofTriggers], NofTriggers, Periodic::fire, nullptr);
+			wheel.tick();
+		}), "cycles/tick");
+	}
+}
+
+TEST(TimerWheel, benchmark_tick_compared_to_linear_table)
+{
+	benchmarkIdleTriggers<2>();
+	benchmarkIdleTriggers<16>();
+	benchmarkIdleTriggers<128>();
+	benchmarkPeriodicTriggers<2>();
+	benchmarkPeriodicTriggers<16>();
+	benchmarkPeriodicTriggers<128>();
+}
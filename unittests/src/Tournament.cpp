@@ -0,0 +1,246 @@
+#include <gmock/gmock.h>
+#include "Benchmark.h"
+#include "TestAssert.h"
+
+#include <Tournament.h>
+#include <WorkStealingPool.h>
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace testing;
+
+namespace
+{
+	std::vector<uint32_t> statsOf(const StrategyStats& stats)
+	{
+		return {stats.matches, stats.won, stats.lost, stats.draws, stats.pushedOut, stats.edgeFalls,
+			static_cast<uint32_t>(stats.edgeDetections), static_cast<uint32_t>(stats.durationMs)};
+	}
+
+	StrategyStats statsOf(std::initializer_list<MatchResult> results)
+	{
+		StrategyStats stats;
+		for (const auto& result : results)
+		{
+			stats.add(result);
+		}
+		return stats;
+	}
+
+	MatchResult resultOf(MatchOutcome outcome, bool pushedOut = false)
+	{
+		MatchResult result;
+		result.outcome = outcome;
+		result.durationMs = 1000;
+		result.edgeDetections = 2;
+		result.pushedOut = pushedOut;
+		return result;
+	}
+}
+
+TEST(WorkStealingPool, runs_every_task_once)
+{
+	constexpr size_t NofTasks = 1000;
+	std::vector<std::atomic<uint32_t>> runs(NofTasks);
+	WorkStealingPool pool(4);
+	for (auto task = size_t{0}; task < NofTasks; ++task)
+	{
+		pool.submit([&runs, task]{ ++runs[task]; });
+	}
+	pool.wait();
+	for (auto task = size_t{0}; task < NofTasks; ++task)
+	{
+		ASSERT_THAT(runs[task].load(), Eq(1u)) << "task " << task;
+	}
+	pool.wait(); //nothing pending
+}
+
+TEST(WorkStealingPool, an_idle_worker_steals_the_tasks_of_a_busy_one)
+{
+	constexpr uint32_t NofTasks = 10;
+	std::atomic<uint32_t> nofDone{0};
+	std::atomic_bool isBlocking{false};
+	WorkStealingPool pool(2);
+	//the first task blocks its worker until all others ran, half of them are queued for that worker
+	pool.submit([&]{
+		isBlocking = true;
+		while (nofDone.load() != NofTasks - 1)
+		{
+			std::this_thread::yield();
+		}
+	});
+	while (!isBlocking)
+	{
+		std::this_thread::yield();
+	}
+	for (auto task = uint32_t{1}; task < NofTasks; ++task)
+	{
+		pool.submit([&]{ ++nofDone; });
+	}
+	pool.wait();
+	ASSERT_THAT(pool.getNofStolen(), Gt(0u));
+}
+
+TEST(WorkStealingPool, the_destructor_finishes_the_submitted_tasks)
+{
+	std::atomic<uint32_t> nofDone{0};
+	{
+		WorkStealingPool pool(3);
+		for (auto task = 0; task < 100; ++task)
+		{
+			pool.submit([&]{ ++nofDone; });
+		}
+	}
+	ASSERT_THAT(nofDone.load(), Eq(100u));
+}
+
+TEST(WorkStealingPool, wait_rethrows_a_failed_assert_of_a_task)
+{
+	std::atomic<uint32_t> nofDone{0};
+	WorkStealingPool pool(4);
+	for (auto task = 0; task < 100; ++task)
+	{
+		pool.submit([&, task]{
+			ASSERT(task != 42);
+			++nofDone;
+		});
+	}
+	ASSERT_THROW(pool.wait(), AssertionFailedException);
+	ASSERT_THAT(nofDone.load(), Eq(99u)); //the other tasks still ran
+	pool.wait(); //rethrown once only
+
+	pool.submit([]{ ASSERT(false); }); //dropped by the destructor
+}
+
+TEST(Tournament, a_sweep_tries_all_combinations)
+{
+	StrategySweep sweep;
+	sweep.enemyDistanceLimitsCm = {30, 50, 70};
+	sweep.reversingTimesMs = {200, 300};
+	auto candidates = expandSweep(sweep);
+	ASSERT_THAT(candidates.size(), Eq(6));
+	ASSERT_THAT(candidates[0].enemyDistanceLimitCm, Eq(30));
+	ASSERT_THAT(candidates[0].reversingTimeMs, Eq(200u));
+	ASSERT_THAT(candidates[5].enemyDistanceLimitCm, Eq(70));
+	ASSERT_THAT(candidates[5].reversingTimeMs, Eq(300u));
+	ASSERT_THAT(candidates[5].turningTimeMs, Eq(StrategyParameters{}.turningTimeMs));
+}
+
+TEST(Tournament, stats_tell_pushed_out_from_edge_falls)
+{
+	auto stats = statsOf({
+		resultOf(MatchOutcome::Won),
+		resultOf(MatchOutcome::Lost, true),
+		resultOf(MatchOutcome::Lost, false),
+		resultOf(MatchOutcome::Draw),
+	});
+	ASSERT_THAT(statsOf(stats), ElementsAre(4, 1, 2, 1, 1, 1, 8, 4000));
+	ASSERT_THAT(stats.winRate(), DoubleEq(0.25));
+	ASSERT_THAT(stats.edgeFallRate(), DoubleEq(0.25));
+
+	stats.merge(statsOf({resultOf(MatchOutcome::Won)}));
+	ASSERT_THAT(statsOf(stats), ElementsAre(5, 2, 2, 1, 1, 1, 10, 5000));
+	ASSERT_THAT(StrategyStats{}.winRate(), DoubleEq(0.0));
+}
+
+TEST(Tournament, the_results_dont_depend_on_the_number_of_threads_or_the_batch_size)
+{
+	StrategySweep sweep;
+	sweep.turningTimesMs = {300, 900};
+	auto candidates = expandSweep(sweep);
+	TournamentSetup setup;
+	setup.opponents = {OpponentKind::Static, OpponentKind::Pusher};
+	setup.matchesPerOpponent = 4;
+	setup.match.timeLimitMs = 10000;
+
+	WorkStealingPool onePool(1);
+	setup.batchSize = 1;
+	auto single = runTournament(setup, candidates, onePool);
+	WorkStealingPool manyPool(4);
+	setup.batchSize = 3;
+	auto many = runTournament(setup, candidates, manyPool);
+
+	ASSERT_THAT(single.size(), Eq(2));
+	ASSERT_THAT(many.size(), Eq(2));
+	for (auto candidate = size_t{0}; candidate < candidates.size(); ++candidate)
+	{
+		ASSERT_THAT(single[candidate].strategy.turningTimeMs, Eq(candidates[candidate].turningTimeMs));
+		ASSERT_THAT(statsOf(many[candidate].total), Eq(statsOf(single[candidate].total)));
+		ASSERT_THAT(single[candidate].total.matches, Eq(8u));
+		ASSERT_THAT(single[candidate].perOpponent.size(), Eq(2));
+		ASSERT_THAT(single[candidate].perOpponent[1].matches, Eq(4u));
+	}
+}
+
+TEST(Tournament, the_report_lists_the_best_first)
+{
+	TournamentSetup setup;
+	setup.opponents = {OpponentKind::Static};
+	std::vector<TournamentEntry> entries(2);
+	entries[0].strategy.reversingTimeMs = 111;
+	entries[0].perOpponent = {statsOf({resultOf(MatchOutcome::Lost)})};
+	entries[0].total = entries[0].perOpponent[0];
+	entries[1].strategy.reversingTimeMs = 222;
+	entries[1].perOpponent = {statsOf({resultOf(MatchOutcome::Won)})};
+	entries[1].total = entries[1].perOpponent[0];
+
+	std::ostringstream report;
+	writeTournamentReport(report, setup, entries, 1);
+	ASSERT_THAT(report.str(), HasSubstr("reverse 222ms"));
+	ASSERT_THAT(report.str(), HasSubstr("total: won 100.0%, edge falls 0.0%"));
+	ASSERT_THAT(report.str(), HasSubstr("static: won 1, lost 0"));
+	ASSERT_THAT(report.str(), Not(HasSubstr("reverse 111ms")));
+}
+
+TEST(Tournament, benchmark_matches_per_second)
+{
+	TournamentSetup setup;
+	setup.opponents = {OpponentKind::Pusher};
+	setup.matchesPerOpponent = 64;
+	std::vector<StrategyParameters> candidates(1);
+
+	for (auto nofThreads : {size_t{1}, size_t{0}})
+	{
+		WorkStealingPool pool(nofThreads);
+		auto nsPerTournament = measureNsPerRun(1, [&]{ runTournament(setup, candidates, pool); });
+		reportBenchmark("tournament on " + std::to_string(pool.getNofThreads()) + " threads",
+			setup.matchesPerOpponent * 1e9 / nsPerTournament, "matches/s");
+	}
+}
+
+/**
+ * the actual parameter search, takes minutes: run with --gtest_also_run_disabled_tests
+ * --gtest_filter=Tournament.DISABLED_sweep_the_strategy_parameters
+ */
+TEST(Tournament, DISABLED_sweep_the_strategy_parameters)
+{
+	auto defaults = StrategyParameters{}.scanVariants;
+	auto wide = defaults;
+	for (auto& variant : wide)
+	{
+		variant.timeoutMs *= 2;
+	}
+	auto spinning = ScanVariants{{
+		ScanVariant{500, 0.0, 0.5},
+		ScanVariant{500, 0.5, 0.0},
+		ScanVariant{300, -0.3, 0.3},
+		ScanVariant{300, 0.3, -0.3},
+		ScanVariant{1000, 0.3, 0.3},
+		ScanVariant{1000, 0.4, 0.4},
+	}};
+
+	StrategySweep sweep;
+	sweep.scanVariantTables = {defaults, wide, spinning};
+	sweep.enemyDistanceLimitsCm = {30, 40, 50, 70, 100};
+	sweep.reversingTimesMs = {150, 300, 450};
+	sweep.turningTimesMs = {300, 600, 900, 1200};
+	auto candidates = expandSweep(sweep);
+
+	TournamentSetup setup;
+	setup.matchesPerOpponent = 100;
+	WorkStealingPool pool;
+	auto entries = runTournament(setup, candidates, pool);
+	writeTournamentReport(std::cout, setup, entries, 10);
+}
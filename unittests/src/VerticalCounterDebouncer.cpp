@@ -0,0 +1,252 @@
+#include <gmock/gmock.h>
+
+#include <VerticalCounterDebouncer.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+	constexpr uint8_t LongPressSamples = 20;
+	using Debouncer = VerticalCounterDebouncer<LongPressSamples>;
+
+	/**
+	 * feeds a pattern of one key ('1' pressed, '0' released, anything else is ignored) as bit 0
+	 * and returns the edges of every sample
+	 */
+	std::vector<KeyEdges> feed(Debouncer& debouncer, const std::string& pattern)
+	{
+		std::vector<KeyEdges> edges;
+		for (auto c : pattern)
+		{
+			if (c == '0' || c == '1')
+			{
+				edges.push_back(debouncer.sample(c == '1' ? 0x1 : 0x0));
+			}
+		}
+		return edges;
+	}
+
+	//! indices of the samples where the edge of key 0 was set
+	std::vector<size_t> samplesWith(const std::vector<KeyEdges>& edges, KeyEdge edge)
+	{
+		std::vector<size_t> samples;
+		for (auto i = size_t{0}; i < edges.size(); ++i)
+		{
+			if (edges[i].of(edge) & 0x1)
+			{
+				samples.push_back(i);
+			}
+		}
+		return samples;
+	}
+
+	/**
+	 * one key, debounced one sample at a time the obvious way
+	 */
+	class ScalarDebouncer
+	{
+	public:
+		KeyEdges sample(bool raw)
+		{
+			KeyEdges edges;
+			equalSamples = raw != state ? equalSamples + 1 : 0;
+			if (equalSamples == 4)
+			{
+				equalSamples = 0;
+				state = raw;
+				if (state)
+				{
+					edges.pressed = 1;
+					heldSamples = 0;
+				}
+				else
+				{
+					(isLong ? edges.releasedLong : edges.released) = 1;
+					isLong = false;
+				}
+			}
+			if (state && !isLong && ++heldSamples == LongPressSamples)
+			{
+				edges.longPressed = 1;
+				isLong = true;
+			}
+			edges.held = state ? 1 : 0;
+			return edges;
+		}
+
+	private:
+		bool state = false;
+		bool isLong = false;
+		size_t equalSamples = 0;
+		size_t heldSamples = 0;
+	};
+
+	enum class TestEvent : uint8_t
+	{
+		Startup,
+		Key1Pressed,
+		Key1LongPressed,
+		Key1Released,
+		Key1ReleasedLong,
+		Key2Pressed,
+		Key2LongPressed,
+		Key2Released,
+		Key2ReleasedLong,
+		Key1Key2Chord
+	};
+
+	constexpr auto testKeyEvents = makeKeyEventTable<TestEvent, TestEvent::Key1Pressed, 2>();
+	constexpr std::array<KeyEventMapping<TestEvent>, 1> testChords = {{
+		{KeyEdge::Chord, 0x3, TestEvent::Key1Key2Chord}
+	}};
+
+	std::vector<TestEvent> mapSamples(const std::vector<uint8_t>& samples)
+	{
+		Debouncer debouncer;
+		KeyEventMapper mapper;
+		std::vector<TestEvent> events;
+		for (auto raw : samples)
+		{
+			mapper.map(debouncer.sample(raw), testChords, testKeyEvents, [&](TestEvent event) { events.push_back(event); });
+		}
+		return events;
+	}
+
+	std::vector<uint8_t> repeat(uint8_t raw, size_t count)
+	{
+		return std::vector<uint8_t>(count, raw);
+	}
+
+	std::vector<uint8_t> operator+(std::vector<uint8_t> first, const std::vector<uint8_t>& second)
+	{
+		first.insert(first.end(), second.begin(), second.end());
+		return first;
+	}
+}
+
+TEST(VerticalCounterDebouncer, a_key_is_pressed_after_four_equal_samples)
+{
+	Debouncer debouncer;
+	auto edges = feed(debouncer, "000 1111 111");
+	ASSERT_THAT(samplesWith(edges, KeyEdge::Pressed), ElementsAre(6));
+	ASSERT_THAT(edges[5].held, Eq(0));
+	ASSERT_THAT(edges[6].held, Eq(1));
+	ASSERT_THAT(debouncer.held(), Eq(1));
+}
+
+TEST(VerticalCounterDebouncer, bounces_are_ignored_until_the_key_is_stable)
+{
+	Debouncer debouncer;
+	auto edges = feed(debouncer, "1010 1101 1110 1111 11 0100 1001 0000 00");
+	ASSERT_THAT(samplesWith(edges, KeyEdge::Pressed), ElementsAre(10));
+	ASSERT_THAT(samplesWith(edges, KeyEdge::Released), ElementsAre(29));
+	ASSERT_THAT(samplesWith(edges, KeyEdge::LongPressed), IsEmpty());
+	ASSERT_THAT(samplesWith(edges, KeyEdge::ReleasedLong), IsEmpty());
+}
+
+TEST(VerticalCounterDebouncer, short_glitches_do_not_change_the_state)
+{
+	Debouncer debouncer;
+	auto edges = feed(debouncer, "0000 1 0 11 0 111 0000");
+	ASSERT_THAT(samplesWith(edges, KeyEdge::Pressed), IsEmpty());
+	ASSERT_THAT(debouncer.held(), Eq(0));
+}
+
+TEST(VerticalCounterDebouncer, a_long_press_is_reported_while_held_and_on_release)
+{
+	Debouncer debouncer;
+	auto edges = feed(debouncer, "1111" + std::string(LongPressSamples + 2, '1') + "0000");
+	ASSERT_THAT(samplesWith(edges, KeyEdge::Pressed), ElementsAre(3));
+	ASSERT_THAT(samplesWith(edges, KeyEdge::LongPressed), ElementsAre(3 + LongPressSamples - 1));
+	ASSERT_THAT(samplesWith(edges, KeyEdge::Released), IsEmpty());
+	ASSERT_THAT(samplesWith(edges, KeyEdge::ReleasedLong), ElementsAre(4 + LongPressSamples + 2 + 3));
+}
+
+TEST(VerticalCounterDebouncer, the_hold_time_restarts_with_every_press)
+{
+	Debouncer debouncer;
+	auto edges = feed(debouncer, "1111 11111 0000 1111 11111 0000");
+	ASSERT_THAT(samplesWith(edges, KeyEdge::LongPressed), IsEmpty());
+	ASSERT_THAT(samplesWith(edges, KeyEdge::Released), ElementsAre(12, 25));
+}
+
+TEST(VerticalCounterDebouncer, all_keys_bounce_independently_like_a_scalar_debouncer)
+{
+	std::mt19937 random(42);
+	std::array<ScalarDebouncer, 8> scalarDebouncers;
+	std::array<bool, 8> levels{};
+	Debouncer debouncer;
+
+	for (auto sampleNo = 0; sampleNo < 20000; ++sampleNo)
+	{
+		//every key changes rarely, but bounces for a while when it does
+		uint8_t raw = 0;
+		for (auto key = size_t{0}; key < 8; ++key)
+		{
+			auto dice = random() % 100;
+			if (dice < 3 + key)
+			{
+				levels[key] = !levels[key];
+			}
+			raw |= levels[key] << key;
+		}
+
+		auto edges = debouncer.sample(raw);
+		for (auto key = size_t{0}; key < 8; ++key)
+		{
+			auto expected = scalarDebouncers[key].sample((raw >> key) & 0x1);
+			for (auto edge : {KeyEdge::Pressed, KeyEdge::LongPressed, KeyEdge::Released, KeyEdge::ReleasedLong})
+			{
+				ASSERT_THAT((edges.of(edge) >> key) & 0x1, Eq(expected.of(edge)))
+					<< "key " << key << " sample " << sampleNo << " edge " << static_cast<int>(edge);
+			}
+			ASSERT_THAT((edges.held >> key) & 0x1, Eq(expected.held));
+		}
+	}
+}
+
+TEST(VerticalCounterDebouncer, the_generated_table_has_four_events_per_key)
+{
+	ASSERT_THAT(testKeyEvents.size(), Eq(8));
+	ASSERT_THAT(testKeyEvents[0].edge, Eq(KeyEdge::Released));
+	ASSERT_THAT(testKeyEvents[0].keys, Eq(0x1));
+	ASSERT_THAT(testKeyEvents[0].event, Eq(TestEvent::Key1Pressed));
+	ASSERT_THAT(testKeyEvents[1].edge, Eq(KeyEdge::LongPressed));
+	ASSERT_THAT(testKeyEvents[1].event, Eq(TestEvent::Key1LongPressed));
+	ASSERT_THAT(testKeyEvents[3].edge, Eq(KeyEdge::ReleasedLong));
+	ASSERT_THAT(testKeyEvents[3].event, Eq(TestEvent::Key1ReleasedLong));
+	ASSERT_THAT(testKeyEvents[6].edge, Eq(KeyEdge::Released));
+	ASSERT_THAT(testKeyEvents[6].keys, Eq(0x2));
+	ASSERT_THAT(testKeyEvents[6].event, Eq(TestEvent::Key2Released));
+}
+
+TEST(KeyEventMapper, a_click_sets_pressed_and_released_on_release)
+{
+	auto events = mapSamples(repeat(0x2, 6) + repeat(0x0, 4));
+	ASSERT_THAT(events, ElementsAre(TestEvent::Key2Pressed, TestEvent::Key2Released));
+}
+
+TEST(KeyEventMapper, a_long_press_sets_long_pressed_and_released_long)
+{
+	auto events = mapSamples(repeat(0x1, 4 + LongPressSamples) + repeat(0x0, 4));
+	ASSERT_THAT(events, ElementsAre(TestEvent::Key1LongPressed, TestEvent::Key1ReleasedLong));
+}
+
+TEST(KeyEventMapper, a_chord_is_detected_and_is_not_a_click_of_its_keys)
+{
+	auto events = mapSamples(repeat(0x1, 5) + repeat(0x3, 6) + repeat(0x2, 4) + repeat(0x0, 4));
+	ASSERT_THAT(events, ElementsAre(TestEvent::Key1Key2Chord));
+
+	//the keys are clickable again afterwards
+	events = mapSamples(repeat(0x3, 6) + repeat(0x0, 4) + repeat(0x1, 4) + repeat(0x0, 4));
+	ASSERT_THAT(events, ElementsAre(TestEvent::Key1Key2Chord, TestEvent::Key1Pressed, TestEvent::Key1Released));
+}
+
+TEST(KeyEventMapper, keys_pressed_after_each_other_without_overlap_are_no_chord)
+{
+	auto events = mapSamples(repeat(0x1, 5) + repeat(0x0, 5) + repeat(0x2, 5) + repeat(0x0, 5));
+	ASSERT_THAT(events, ElementsAre(TestEvent::Key1Pressed, TestEvent::Key1Released, TestEvent::Key2Pressed, TestEvent::Key2Released));
+}